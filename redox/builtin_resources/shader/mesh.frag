@@ -22,7 +22,9 @@ float lambert(vec3 N, vec3 L) {
 
 void main() {
     vec3 baseColor = texture(albedoTexture, fragUV).rgb;
-    vec3 normalColor = texture(normalTexture, fragUV).rgb;
+    //normal maps are cooked to BC5, only x and y are stored
+    vec2 normalXY = texture(normalTexture, fragUV).rg * 2.0 - 1.0;
+    vec3 normalColor = vec3(normalXY, sqrt(max(1.0 - dot(normalXY, normalXY), 0.0)));
 
     vec3 normal = normalize(fragNormal);
 
@@ -30,12 +30,28 @@ redox::Application* redox::Application::instance = nullptr;
 
 redox::Application::Application(Path directory) :
 	_directory(std::move(directory)),
-	_config(_directory / "engine.ini") {
+	_config(_directory / "engine.ini"),
+	_settings(_config.get<EngineSettings>()) {
 
 	RDX_LOG("Initializing Redox...", ConsoleColor::GREEN);
 	_threadId = std::this_thread::get_id();
 
-	_resourceManager = make_unique<ResourceManager>("builtin_resources\\", _directory / "resources\\");
+	const bool hotReloading = _config.get("Resources", "HotReloading");
+	if (hotReloading) {
+		_config.watch();
+	}
+
+	_config.onChange += [this](const Configuration& config) {
+		//a half written edit must not take the running app down, keep what we had
+		try {
+			_settings = config.get<EngineSettings>();
+		}
+		catch (const Exception& e) {
+			RDX_LOG("failed to apply configuration: {0}", ConsoleColor::RED, e.what());
+		}
+	};
+
+	_resourceManager = make_unique<ResourceManager>("builtin_resources\\", _directory / "resources\\", hotReloading);
 	_init_window();
 	_graphics = make_unique<graphics::Graphics>(*_window);
 	_renderSystem = make_unique<graphics::RenderSystem>();
@@ -52,14 +68,14 @@ void redox::Application::run() {
 	_window->show();
 	_state = State::RUNNING;
 
-	const u32 max_fps = _config.get("Engine", "MaxFPS");
-	const auto timestep = 1000. / max_fps;
-
 	_timer.start();
 
 	while (_state != State::TERMINATED) {
 		auto dt_ms = _timer.elapsed();
+		auto timestep = 1000. / _settings.maxFps;
 
+		_config.poll();
+		_resourceManager->update();
 		_window->process_events();
 		_inputSystem->poll();
 
@@ -77,6 +93,7 @@ void redox::Application::run() {
 
 			if (!_window->is_closed()) {
 				_renderSystem->render();
+				_resourceManager->next_frame();
 				auto fps = 1000. / dt_ms;
 				_window->set_title(redox::format("redox engine | {0}fps", fps));
 			}
@@ -119,17 +136,19 @@ const redox::graphics::Graphics* redox::Application::graphics() const {
 
 void redox::Application::_init_window() {
 
+	auto surface = _config.get<SurfaceSettings>();
+
 	platform::WindowSettings wdSettings{};
-	wdSettings.iconPath = _config.get("Surface", "Icon").as<String>();
-	wdSettings.defaultCursor = _config.get("Surface", "DefaultCursor").as<String>();
-	wdSettings.width = _config.get("Surface", "ResolutionX");
-	wdSettings.height = _config.get("Surface", "ResolutionY");
-	wdSettings.stayOnTop = _config.get("Surface", "StayOnTop");
+	wdSettings.iconPath = std::move(surface.icon);
+	wdSettings.defaultCursor = std::move(surface.defaultCursor);
+	wdSettings.width = surface.resolutionX;
+	wdSettings.height = surface.resolutionY;
+	wdSettings.stayOnTop = surface.stayOnTop;
 
-	if (_config.get("Surface", "Fullscreen"))
+	if (surface.fullscreen)
 		wdSettings.flags |= platform::WindowFlags::FULLSCREEN;
 
-	if (_config.get("Surface", "Resizable"))
+	if (surface.resizable)
 		wdSettings.flags |= platform::WindowFlags::RESIZABLE;
 
 	_window = make_unique<platform::Window>(wdSettings);
@@ -139,7 +158,7 @@ void redox::Application::_init_window() {
 			stop();
 			break;
 		case platform::Window::Event::LOSTFOCUS:
-			if (_state != State::TERMINATED && !_config.get("Engine", "RunInBackground")) {
+			if (_state != State::TERMINATED && !_settings.runInBackground) {
 				_state = State::PAUSED;
 			}
 			break;
@@ -33,6 +33,30 @@ SOFTWARE.
 
 #include <thread> //std::thread::id
 
+namespace redox {
+	struct EngineSettings {
+		bool vsync;
+		u32 maxFps;
+		bool runInBackground;
+	};
+
+	struct SurfaceSettings {
+		bool fullscreen;
+		String icon;
+		bool resizable;
+		u32 resolutionX;
+		u32 resolutionY;
+		bool stayOnTop;
+		String defaultCursor;
+	};
+}
+
+RDX_CONFIG_SCHEMA(redox::EngineSettings, "Engine",
+	"VSync", "MaxFPS", "RunInBackground");
+
+RDX_CONFIG_SCHEMA(redox::SurfaceSettings, "Surface",
+	"Fullscreen", "Icon", "Resizable", "ResolutionX", "ResolutionY", "StayOnTop", "DefaultCursor");
+
 namespace redox {
 	class Application {
 	public:
@@ -65,6 +89,7 @@ namespace redox {
 		std::thread::id _threadId;
 		Path _directory;
 		Configuration _config;
+		EngineSettings _settings;
 		platform::Timer _timer;
 
 		UniquePtr<ResourceManager> _resourceManager;
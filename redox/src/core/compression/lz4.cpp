@@ -0,0 +1,172 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "lz4.h"
+
+#include <cstring> //std::memcpy
+#include <algorithm> //std::min
+
+namespace {
+	constexpr std::size_t MinMatch = 4;
+	constexpr std::size_t LastLiterals = 5;		//the block always ends with this many literals
+	constexpr std::size_t MatchFindLimit = 12;	//no match may start closer to the end
+	constexpr std::size_t MaxOffset = 65535;
+	constexpr redox::u32 HashBits = 12;
+
+	redox::u32 read32(const redox::byte* p) {
+		redox::u32 v;
+		std::memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	redox::u32 hash_sequence(redox::u32 sequence) {
+		return (sequence * 2654435761u) >> (32 - HashBits);
+	}
+
+	void write_length(redox::Buffer<redox::byte>& output, std::size_t length) {
+		for (; length >= 255; length -= 255)
+			output.push_back(255);
+		output.push_back(static_cast<redox::byte>(length));
+	}
+
+	void write_sequence(redox::Buffer<redox::byte>& output, const redox::byte* literals,
+		std::size_t literalCount, std::size_t offset, std::size_t matchLength) {
+
+		const auto matchExtra = matchLength >= MinMatch ? matchLength - MinMatch : 0;
+		const auto token = static_cast<redox::byte>(
+			(std::min<std::size_t>(literalCount, 15) << 4) | std::min<std::size_t>(matchExtra, 15));
+
+		output.push_back(token);
+		if (literalCount >= 15)
+			write_length(output, literalCount - 15);
+		output.insert(output.end(), literals, literals + literalCount);
+
+		if (matchLength == 0)
+			return;
+
+		output.push_back(static_cast<redox::byte>(offset & 0xff));
+		output.push_back(static_cast<redox::byte>(offset >> 8));
+		if (matchExtra >= 15)
+			write_length(output, matchExtra - 15);
+	}
+
+	bool read_length(const redox::byte*& ip, const redox::byte* end, std::size_t& length) {
+		redox::byte b;
+		do {
+			if (ip >= end)
+				return false;
+			b = *ip++;
+			length += b;
+		} while (b == 255);
+		return true;
+	}
+}
+
+std::size_t redox::compression::lz4::compress_bound(std::size_t size) {
+	return size + size / 255 + 16;
+}
+
+void redox::compression::lz4::compress(Span<const byte> input, Buffer<byte>& output) {
+	output.reserve(output.size() + compress_bound(input.size()));
+
+	const auto base = input.data();
+	const auto end = base + input.size();
+	auto anchor = base;
+
+	if (input.size() > MatchFindLimit) {
+		Array<u32, 1u << HashBits> table{};
+		const auto matchLimit = end - MatchFindLimit;
+		const auto extendLimit = end - LastLiterals;
+
+		for (auto ip = base; ip < matchLimit;) {
+			const auto sequence = read32(ip);
+			auto& slot = table[hash_sequence(sequence)];
+			const auto ref = base + slot;
+			slot = static_cast<u32>(ip - base);
+
+			if (ref >= ip || static_cast<std::size_t>(ip - ref) > MaxOffset || read32(ref) != sequence) {
+				++ip;
+				continue;
+			}
+
+			auto length = MinMatch;
+			while (ip + length < extendLimit && ip[length] == ref[length])
+				++length;
+
+			write_sequence(output, anchor, ip - anchor, ip - ref, length);
+			ip += length;
+			anchor = ip;
+		}
+	}
+
+	write_sequence(output, anchor, end - anchor, 0, 0);
+}
+
+bool redox::compression::lz4::decompress(Span<const byte> input, Span<byte> output) {
+	auto ip = input.data();
+	const auto inEnd = ip + input.size();
+	auto op = output.data();
+	const auto outEnd = op + output.size();
+
+	while (ip < inEnd) {
+		const auto token = *ip++;
+
+		std::size_t literals = token >> 4;
+		if (literals == 15 && !read_length(ip, inEnd, literals))
+			return false;
+		if (literals > static_cast<std::size_t>(inEnd - ip) || literals > static_cast<std::size_t>(outEnd - op))
+			return false;
+
+		std::memcpy(op, ip, literals);
+		ip += literals;
+		op += literals;
+
+		//the last sequence carries literals only
+		if (ip == inEnd)
+			break;
+
+		if (inEnd - ip < 2)
+			return false;
+		const std::size_t offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > static_cast<std::size_t>(op - output.data()))
+			return false;
+
+		std::size_t length = token & 0xf;
+		if (length == 15 && !read_length(ip, inEnd, length))
+			return false;
+		length += MinMatch;
+		if (length > static_cast<std::size_t>(outEnd - op))
+			return false;
+
+		//matches may overlap their own output
+		const auto match = op - offset;
+		for (std::size_t i = 0; i < length; ++i)
+			op[i] = match[i];
+		op += length;
+	}
+
+	return op == outEnd;
+}
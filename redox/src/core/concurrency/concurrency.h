@@ -0,0 +1,80 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include "core/core.h"
+
+#include <atomic> //std::atomic
+#include <new> //std::launder
+#include <type_traits> //std::aligned_storage_t
+#include <thread> //std::this_thread::yield
+
+#ifdef RDX_ARCH_X64
+#ifdef RDX_COMPILER_MSVC
+#include <intrin.h> //_mm_pause
+#else
+#include <immintrin.h> //_mm_pause
+#endif
+#endif
+
+namespace redox::concurrency {
+	//fixed instead of std::hardware_destructive_interference_size,
+	//which is not stable across compilers
+	constexpr std::size_t CacheLineSize = 64;
+
+	constexpr std::size_t next_pow2(std::size_t value) {
+		std::size_t result = 1;
+		while (result < value)
+			result <<= 1;
+		return result;
+	}
+
+	RDX_INLINE void cpu_relax() {
+#ifdef RDX_ARCH_X64
+		_mm_pause();
+#else
+		std::this_thread::yield();
+#endif
+	}
+
+	//uninitialized storage for one T, constructed and destroyed by the owning queue
+	template<class T>
+	struct Storage {
+		template<class...Args>
+		RDX_INLINE void construct(Args&&...args) {
+			new (&data) T(std::forward<Args>(args)...);
+		}
+
+		RDX_INLINE T& get() {
+			return *std::launder(reinterpret_cast<T*>(&data));
+		}
+
+		RDX_INLINE void destroy() {
+			get().~T();
+		}
+
+		std::aligned_storage_t<sizeof(T), alignof(T)> data;
+	};
+}
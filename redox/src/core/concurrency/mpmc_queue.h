@@ -0,0 +1,130 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include "concurrency.h"
+#include "core/non_copyable.h"
+
+namespace redox::concurrency {
+	//bounded multi-producer/multi-consumer ring (D. Vyukov).
+	//every cell carries a sequence number telling producers and consumers
+	//whose turn it is, so a successful CAS on the index owns the cell.
+	template<class T>
+	class MpmcQueue : public NonCopyable {
+	public:
+		explicit MpmcQueue(std::size_t capacity) :
+			_capacity(next_pow2(capacity)),
+			_mask(_capacity - 1),
+			_cells(make_unique<Cell[]>(_capacity)) {
+			for (std::size_t i = 0; i < _capacity; ++i)
+				_cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+
+		~MpmcQueue() {
+			const auto tail = _tail.load();
+			for (auto i = _head.load(); i != tail; ++i)
+				_cells[i & _mask].storage.destroy();
+		}
+
+		template<class...Args>
+		bool try_emplace(Args&&...args) {
+			auto pos = _tail.load(std::memory_order_relaxed);
+			for (;;) {
+				auto& cell = _cells[pos & _mask];
+				const auto seq = cell.sequence.load(std::memory_order_acquire);
+				const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+
+				if (diff == 0) {
+					if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+						cell.storage.construct(std::forward<Args>(args)...);
+						cell.sequence.store(pos + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (diff < 0) {
+					return false;
+				}
+				else {
+					pos = _tail.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		bool try_push(const T& value) {
+			return try_emplace(value);
+		}
+
+		bool try_push(T&& value) {
+			return try_emplace(std::move(value));
+		}
+
+		bool try_pop(T& out) {
+			auto pos = _head.load(std::memory_order_relaxed);
+			for (;;) {
+				auto& cell = _cells[pos & _mask];
+				const auto seq = cell.sequence.load(std::memory_order_acquire);
+				const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+
+				if (diff == 0) {
+					if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+						out = std::move(cell.storage.get());
+						cell.storage.destroy();
+						cell.sequence.store(pos + _capacity, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (diff < 0) {
+					return false;
+				}
+				else {
+					pos = _head.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		std::size_t size_approx() const {
+			const auto tail = _tail.load(std::memory_order_relaxed);
+			const auto head = _head.load(std::memory_order_relaxed);
+			return tail > head ? tail - head : 0;
+		}
+
+		std::size_t capacity() const {
+			return _capacity;
+		}
+
+	private:
+		struct Cell {
+			std::atomic<std::size_t> sequence;
+			Storage<T> storage;
+		};
+
+		const std::size_t _capacity;
+		const std::size_t _mask;
+		UniquePtr<Cell[]> _cells;
+
+		alignas(CacheLineSize) std::atomic<std::size_t> _tail{ 0 };
+		alignas(CacheLineSize) std::atomic<std::size_t> _head{ 0 };
+	};
+}
@@ -0,0 +1,100 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include "concurrency.h"
+#include "core\non_copyable.h"
+
+namespace redox::concurrency {
+	struct MpscNode {
+		std::atomic<MpscNode*> next{ nullptr };
+	};
+
+	//unbounded intrusive multi-producer/single-consumer queue (D. Vyukov).
+	//push is a single exchange and never fails; the queue does not own
+	//its nodes, T has to derive from MpscNode and outlive its stay in the queue.
+	//pop may transiently return nullptr while a producer is mid-push.
+	template<class T>
+	class MpscQueue : public NonCopyable {
+		static_assert(std::is_base_of_v<MpscNode, T>, "T must derive from MpscNode");
+
+	public:
+		MpscQueue() : _head(&_stub), _tail(&_stub) {
+		}
+
+		void push(T* node) {
+			push_node(node);
+		}
+
+		T* pop() {
+			auto* tail = _tail;
+			auto* next = tail->next.load(std::memory_order_acquire);
+
+			if (tail == &_stub) {
+				if (next == nullptr)
+					return nullptr;
+				_tail = next;
+				tail = next;
+				next = next->next.load(std::memory_order_acquire);
+			}
+
+			if (next != nullptr) {
+				_tail = next;
+				return static_cast<T*>(tail);
+			}
+
+			//producer swapped the head but has not linked it yet
+			if (tail != _head.load(std::memory_order_acquire))
+				return nullptr;
+
+			push_node(&_stub);
+			next = tail->next.load(std::memory_order_acquire);
+			if (next != nullptr) {
+				_tail = next;
+				return static_cast<T*>(tail);
+			}
+			return nullptr;
+		}
+
+		//consumer side only, ignores pushes still in flight
+		bool empty() const {
+			return _tail == &_stub && _stub.next.load(std::memory_order_acquire) == nullptr;
+		}
+
+	private:
+		RDX_INLINE void push_node(MpscNode* node) {
+			node->next.store(nullptr, std::memory_order_relaxed);
+			auto* prev = _head.exchange(node, std::memory_order_acq_rel);
+			prev->next.store(node, std::memory_order_release);
+		}
+
+		//producers
+		alignas(CacheLineSize) std::atomic<MpscNode*> _head;
+
+		//consumer
+		alignas(CacheLineSize) MpscNode* _tail;
+		MpscNode _stub;
+	};
+}
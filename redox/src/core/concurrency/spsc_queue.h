@@ -0,0 +1,106 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include "concurrency.h"
+#include "core\non_copyable.h"
+
+namespace redox::concurrency {
+	//bounded single-producer/single-consumer ring.
+	//each side keeps a private copy of the other side's index and only
+	//touches the shared one when that copy says the ring looks full/empty.
+	template<class T>
+	class SpscQueue : public NonCopyable {
+	public:
+		explicit SpscQueue(std::size_t capacity) :
+			_capacity(next_pow2(capacity)),
+			_mask(_capacity - 1),
+			_slots(make_unique<Storage<T>[]>(_capacity)) {
+		}
+
+		~SpscQueue() {
+			for (auto i = _head.load(); i != _tail.load(); ++i)
+				_slots[i & _mask].destroy();
+		}
+
+		template<class...Args>
+		bool try_emplace(Args&&...args) {
+			const auto tail = _tail.load(std::memory_order_relaxed);
+			if (tail - _cachedHead == _capacity) {
+				_cachedHead = _head.load(std::memory_order_acquire);
+				if (tail - _cachedHead == _capacity)
+					return false;
+			}
+
+			_slots[tail & _mask].construct(std::forward<Args>(args)...);
+			_tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool try_push(const T& value) {
+			return try_emplace(value);
+		}
+
+		bool try_push(T&& value) {
+			return try_emplace(std::move(value));
+		}
+
+		bool try_pop(T& out) {
+			const auto head = _head.load(std::memory_order_relaxed);
+			if (head == _cachedTail) {
+				_cachedTail = _tail.load(std::memory_order_acquire);
+				if (head == _cachedTail)
+					return false;
+			}
+
+			auto& slot = _slots[head & _mask];
+			out = std::move(slot.get());
+			slot.destroy();
+			_head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		std::size_t size_approx() const {
+			return _tail.load(std::memory_order_relaxed) - _head.load(std::memory_order_relaxed);
+		}
+
+		std::size_t capacity() const {
+			return _capacity;
+		}
+
+	private:
+		const std::size_t _capacity;
+		const std::size_t _mask;
+		UniquePtr<Storage<T>[]> _slots;
+
+		//consumer
+		alignas(CacheLineSize) std::atomic<std::size_t> _head{ 0 };
+		std::size_t _cachedTail{ 0 };
+
+		//producer
+		alignas(CacheLineSize) std::atomic<std::size_t> _tail{ 0 };
+		std::size_t _cachedHead{ 0 };
+	};
+}
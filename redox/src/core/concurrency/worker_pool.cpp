@@ -0,0 +1,166 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "worker_pool.h"
+
+#include <algorithm> //std::min
+#include <exception> //std::exception_ptr
+#include <memory> //std::make_shared
+
+namespace {
+	//pool the current thread works for, its submits must not wait on its own queue
+	thread_local const redox::concurrency::WorkerPool* tls_worker_of = nullptr;
+}
+
+redox::concurrency::WorkerPool::WorkerPool(u32 threads, std::size_t capacity) {
+	for (auto& queue : _queues)
+		queue = make_unique<MpmcQueue<Task>>(capacity);
+
+	_threads.reserve(threads);
+	for (u32 i = 0; i < threads; ++i)
+		_threads.emplace_back(&WorkerPool::_run, this);
+}
+
+redox::concurrency::WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard guard(_sleepMutex);
+		_stop = true;
+	}
+	_wakeup.notify_all();
+
+	for (auto& thread : _threads)
+		thread.join();
+}
+
+void redox::concurrency::WorkerPool::submit(Task task, Priority priority) {
+	//counted before the push so a worker never sees a task it cannot account for
+	_pending.fetch_add(1, std::memory_order_relaxed);
+
+	auto& queue = *_queues[static_cast<std::size_t>(priority)];
+	while (!queue.try_push(std::move(task))) {
+		//every worker could be spinning here with nobody left to drain the queue
+		if (tls_worker_of == this) {
+			_pending.fetch_sub(1, std::memory_order_relaxed);
+			task();
+			return;
+		}
+		std::this_thread::yield();
+	}
+
+	{
+		//pairs with the predicate check in _run, otherwise the wakeup can be lost
+		std::lock_guard guard(_sleepMutex);
+	}
+	_wakeup.notify_one();
+}
+
+redox::u32 redox::concurrency::WorkerPool::size() const {
+	return static_cast<u32>(_threads.size());
+}
+
+void redox::concurrency::WorkerPool::parallel_for(std::size_t count,
+	const Function<void(std::size_t)>& body, Priority priority) {
+
+	//shared with the helpers, a helper that starts after the caller returned
+	//finds no index left and never touches body
+	struct shared_state {
+		std::size_t count;
+		const Function<void(std::size_t)>* body;
+		std::atomic<std::size_t> next{ 0 };
+		std::atomic<u32> active{ 0 };
+
+		std::mutex mutex;
+		std::condition_variable idle;
+		std::exception_ptr error;
+
+		void drain() {
+			for (auto i = next++; i < count; i = next++) {
+				try {
+					(*body)(i);
+				}
+				catch (...) {
+					std::lock_guard guard(mutex);
+					if (!error)
+						error = std::current_exception();
+					next = count;
+				}
+			}
+		}
+	};
+
+	auto state = std::make_shared<shared_state>();
+	state->count = count;
+	state->body = &body;
+
+	const auto helpers = std::min<std::size_t>(size(), count > 0 ? count - 1 : 0);
+	for (std::size_t i = 0; i < helpers; ++i) {
+		submit([state]() {
+			++state->active;
+			state->drain();
+			if (--state->active == 0) {
+				std::lock_guard guard(state->mutex);
+				state->idle.notify_all();
+			}
+		}, priority);
+	}
+
+	state->drain();
+
+	std::unique_lock lock(state->mutex);
+	state->idle.wait(lock, [&state]() { return state->active == 0; });
+	if (state->error)
+		std::rethrow_exception(state->error);
+}
+
+bool redox::concurrency::WorkerPool::_try_pop(Task& task) {
+	for (auto& queue : _queues) {
+		if (queue->try_pop(task)) {
+			_pending.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	return false;
+}
+
+void redox::concurrency::WorkerPool::_run() {
+	tls_worker_of = this;
+
+	Task task;
+	for (;;) {
+		if (_try_pop(task)) {
+			task();
+			task = nullptr;
+			continue;
+		}
+
+		if (_stop)
+			break;
+
+		std::unique_lock lock(_sleepMutex);
+		_wakeup.wait(lock, [this]() {
+			return _stop || _pending.load(std::memory_order_relaxed) > 0;
+		});
+	}
+}
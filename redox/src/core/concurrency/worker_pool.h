@@ -0,0 +1,75 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include "core/core.h"
+#include "core/non_copyable.h"
+#include "mpmc_queue.h"
+
+#include <thread> //std::thread
+#include <mutex> //std::mutex
+#include <condition_variable> //std::condition_variable
+
+namespace redox::concurrency {
+	//fixed set of worker threads draining one bounded queue per priority class.
+	//workers always take from the highest non-empty class and finish every
+	//queued task before the pool is joined.
+	class WorkerPool : public NonCopyable {
+	public:
+		enum class Priority {
+			HIGH, NORMAL, LOW
+		};
+
+		using Task = Function<void()>;
+
+		explicit WorkerPool(u32 threads, std::size_t capacity = 1024);
+		~WorkerPool();
+
+		//blocks while the queue of the given class is full, called from one of
+		//the workers the task runs inline instead
+		void submit(Task task, Priority priority = Priority::NORMAL);
+		u32 size() const;
+
+		//runs body(0..count-1) on the workers and the calling thread, returns once every
+		//index is done and rethrows the first exception. the caller only waits for helpers
+		//that picked up work, so it is safe to call from a task of this pool.
+		void parallel_for(std::size_t count, const Function<void(std::size_t)>& body,
+			Priority priority = Priority::NORMAL);
+
+	private:
+		static constexpr std::size_t PriorityCount = 3;
+
+		void _run();
+		bool _try_pop(Task& task);
+
+		Array<UniquePtr<MpmcQueue<Task>>, PriorityCount> _queues;
+		std::atomic<u64> _pending{ 0 };
+		std::atomic_bool _stop{ false };
+
+		std::mutex _sleepMutex;
+		std::condition_variable _wakeup;
+		Buffer<std::thread> _threads;
+	};
+}
@@ -24,18 +24,87 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #include "config.h"
+#include "core\logging\log.h"
 
-redox::Configuration::Configuration(const Path& file) {
-	auto fileStr = file.string();
-	_config = ini_load(fileStr.c_str());
-	if (_config == nullptr)
+#include <thirdparty/ini/ini.h>
+
+redox::Configuration::Configuration(const Path& file) :
+	_file(file) {
+
+	if (!_parse())
 		throw Exception("failed to load ini config");
 }
 
 redox::Configuration::~Configuration() {
-	ini_free(_config);
+	if (_monitor)
+		_monitor->stop();
+}
+
+redox::detail::value_proxy redox::Configuration::get(key_type key) const {
+	auto it = _values.find(key);
+	if (it == _values.end())
+		throw Exception("failed to load ini key");
+
+	return it->second;
 }
 
 redox::detail::value_proxy redox::Configuration::get(StringView group, StringView value) const {
-	return { _config, group, value };
+	return get(make_key(group, value));
+}
+
+void redox::Configuration::watch() {
+	if (_monitor)
+		return;
+
+	_monitor.emplace();
+	_monitor->subscribe([this](const Path& file, io::ChangeEvents) {
+		if (file == _file.filename()) {
+			_modified = true;
+		}
+	});
+	_monitor->start(_file.parent_path(), io::ChangeEvents::FILE_MODIFIED);
+}
+
+void redox::Configuration::poll() {
+	if (!_modified.exchange(false))
+		return;
+
+	RDX_LOG("Configuration {0} modified. Reloading...", _file.filename());
+	if (_parse()) {
+		onChange(*this);
+	}
+}
+
+bool redox::Configuration::_parse() {
+	auto fileStr = _file.string();
+	ini_t* config = ini_load(fileStr.c_str());
+	if (config == nullptr)
+		return false;
+
+	RDX_SCOPE_GUARD([config]() {
+		ini_free(config);
+	});
+
+	Hashmap<key_type, detail::config_value> values;
+	ini_foreach(config, [](const char* section, const char* key, const char* value, void* udata) {
+		auto& values = *static_cast<Hashmap<key_type, detail::config_value>*>(udata);
+		StringView str(value);
+		std::optional<bool> boolean;
+		try {
+			boolean = redox::parse<bool>(str);
+		}
+		catch (const Exception&) {
+			//only reported once the key is read as a bool
+		}
+
+		values[make_key(section, key)] = {
+			String(str),
+			redox::parse<i64>(str),
+			redox::parse<f64>(str),
+			boolean
+		};
+	}, &values);
+
+	_values = std::move(values);
+	return true;
 }
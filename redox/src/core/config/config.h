@@ -25,22 +25,52 @@ SOFTWARE.
 */
 #pragma once
 #include "core\string_format.h"
+#include "core\hash.h"
+#include "core\event.h"
+#include "core\meta\reflection.h"
+#include "platform\filesystem.h"
 
-#include <thirdparty/ini/ini.h>
+#include <atomic> //std::atomic_bool
+#include <optional> //std::optional
+
+#define RDX_CONFIG_SCHEMA(Type, Group, ...)							\
+template<>															\
+struct redox::ConfigSchema<Type> {									\
+	static constexpr redox::StringView group = Group;				\
+	static constexpr redox::StringView keys[] = { __VA_ARGS__ };	\
+};																	\
 
 namespace redox {
+	//Maps the fields of a settings struct (in declaration order)
+	//to the keys of an ini group, see RDX_CONFIG_SCHEMA
+	template<class T>
+	struct ConfigSchema;
+
 	namespace detail {
+		struct config_value {
+			String string;
+			i64 integer;
+			f64 real;
+			std::optional<bool> boolean;	//empty when the value is neither 0/1 nor true/false
+		};
+
 		class value_proxy {
 		public:
-			value_proxy(ini_t* conf, StringView group, StringView value) {
-				_ini_val = ini_get(conf, group.data(), value.data());
-				if (_ini_val == nullptr)
-					throw Exception("failed to load ini key");
-			}
+			value_proxy(const config_value& value) : _value(&value) {}
 
 			template<class T>
-			auto as() const {
-				return redox::parse<T>(_ini_val);
+			T as() const {
+				if constexpr (std::is_same_v<T, bool>) {
+					if (!_value->boolean)
+						throw Exception(redox::format("invalid boolean value {0}", _value->string));
+					return *_value->boolean;
+				}
+				else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>)
+					return static_cast<T>(_value->integer);
+				else if constexpr (std::is_floating_point_v<T>)
+					return static_cast<T>(_value->real);
+				else
+					return T(_value->string);
 			}
 
 			template<class T>
@@ -49,18 +79,60 @@ namespace redox {
 			}
 
 		private:
-			const char* _ini_val;
+			const config_value* _value;
 		};
 	}
 
-	class Configuration {
+	class Configuration : public NonCopyable {
 	public:
+		using key_type = hash::hash_type;
+
 		Configuration(const Path& file);
 		~Configuration();
 
+		//ini groups and keys are case insensitive
+		static constexpr key_type make_key(StringView group, StringView value) noexcept {
+			key_type hash = hash::fnv1a_offset;
+			for (auto c : group) {
+				hash = (hash ^ static_cast<u8>(c >= 'A' && c <= 'Z' ? c + 32 : c)) * hash::fnv1a_prime;
+			}
+			hash = (hash ^ static_cast<u8>('.')) * hash::fnv1a_prime;
+			for (auto c : value) {
+				hash = (hash ^ static_cast<u8>(c >= 'A' && c <= 'Z' ? c + 32 : c)) * hash::fnv1a_prime;
+			}
+			return hash;
+		}
+
+		detail::value_proxy get(key_type key) const;
 		detail::value_proxy get(StringView group, StringView value) const;
 
+		template<class T>
+		T get() const {
+			return _make<T>(std::make_index_sequence<reflection::Reflect<T>{}.field_count()>{});
+		}
+
+		//Starts monitoring the ini file, changes are applied by poll()
+		void watch();
+		void poll();
+
+		Event<const Configuration&> onChange;
+
 	private:
-		ini_t* _config;
+		template<class T, std::size_t...I>
+		T _make(std::index_sequence<I...>) const {
+			using schema = ConfigSchema<T>;
+			static_assert(std::size(schema::keys) == sizeof...(I),
+				"schema does not match the number of fields");
+
+			return T{ get(schema::group, schema::keys[I])
+				.template as<reflection::field_type_t<T, I>>()... };
+		}
+
+		bool _parse();
+
+		Path _file;
+		Hashmap<key_type, detail::config_value> _values;
+		std::atomic_bool _modified{ false };
+		std::optional<io::DirectoryWatcher> _monitor;
 	};
 }
\ No newline at end of file
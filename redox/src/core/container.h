@@ -32,6 +32,8 @@ SOFTWARE.
 #include <functional>
 #include <array>
 #include <filesystem>
+#include <iterator> //std::data, std::size
+#include <type_traits> //std::enable_if_t
 
 #include <thirdparty/function_ref/function_ref.hpp>
 
@@ -70,8 +72,44 @@ namespace redox
 	using Array = std::array<T, N>;
 
 	using Path = std::filesystem::path;
+
+	//non-owning view over contiguous memory (stand-in for C++20 std::span)
+	template<class T>
+	class Span {
+	public:
+		using element_type = T;
+		using value_type = std::remove_cv_t<T>;
+		using iterator = T*;
+
+		constexpr Span() = default;
+		constexpr Span(T* data, std::size_t size) : _data(data), _size(size) {}
+
+		template<class Container, class = std::enable_if_t<
+			std::is_convertible_v<decltype(std::data(std::declval<Container&>())), T*>>>
+		constexpr Span(Container& container) :
+			_data(std::data(container)), _size(std::size(container)) {}
+
+		constexpr T* data() const { return _data; }
+		constexpr std::size_t size() const { return _size; }
+		constexpr std::size_t size_bytes() const { return _size * sizeof(T); }
+		constexpr bool empty() const { return _size == 0; }
+
+		constexpr T& operator[](std::size_t index) const { return _data[index]; }
+		constexpr iterator begin() const { return _data; }
+		constexpr iterator end() const { return _data + _size; }
+
+		constexpr Span subspan(std::size_t offset, std::size_t count = std::size_t(-1)) const {
+			return { _data + offset, count == std::size_t(-1) ? _size - offset : count };
+		}
+
+	private:
+		T* _data = nullptr;
+		std::size_t _size = 0;
+	};
 }
 
+//libstdc++ 12 ships its own specialization
+#if !defined _GLIBCXX_RELEASE || _GLIBCXX_RELEASE < 12
 namespace std {
 	template<>
 	struct hash<std::filesystem::path> {
@@ -79,4 +117,5 @@ namespace std {
 			return std::filesystem::hash_value(path);
 		}
 	};
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
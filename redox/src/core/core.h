@@ -46,11 +46,18 @@ namespace redox {
 
 #ifdef RDX_PLATFORM_WINDOWS
 #define RDX_DLL __declspec(dllexport)
-#define RDX_INLINE __forceinline
+#endif
+
 #ifdef RDX_COMPILER_MSVC
+#define RDX_INLINE __forceinline
 #define RDX_DEBUG_BREAK __debugbreak
 #if _DEBUG
 #define RDX_DEBUG 
 #endif
+#else
+#define RDX_INLINE inline __attribute__((always_inline))
+#define RDX_DEBUG_BREAK __builtin_trap
+#ifndef NDEBUG
+#define RDX_DEBUG
 #endif
 #endif
\ No newline at end of file
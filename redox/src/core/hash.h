@@ -0,0 +1,129 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include "core.h"
+
+#include <cstring> //std::memcpy
+
+namespace redox::hash {
+	using hash_type = u64;
+
+	constexpr hash_type fnv1a_offset = 0xcbf29ce484222325ull;
+	constexpr hash_type fnv1a_prime = 0x100000001b3ull;
+
+	constexpr hash_type fnv1a(StringView str, hash_type seed = fnv1a_offset) noexcept {
+		auto hash = seed;
+		for (auto c : str) {
+			hash ^= static_cast<hash_type>(static_cast<u8>(c));
+			hash *= fnv1a_prime;
+		}
+		return hash;
+	}
+
+	constexpr hash_type combine(hash_type seed, hash_type value) noexcept {
+		return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+	}
+
+	namespace detail {
+		constexpr u64 xxh_prime1 = 0x9e3779b185ebca87ull;
+		constexpr u64 xxh_prime2 = 0xc2b2ae3d27d4eb4full;
+		constexpr u64 xxh_prime3 = 0x165667b19e3779f9ull;
+		constexpr u64 xxh_prime4 = 0x85ebca77c2b2ae63ull;
+		constexpr u64 xxh_prime5 = 0x27d4eb2f165667c5ull;
+
+		inline u64 rotl(u64 v, u32 r) {
+			return (v << r) | (v >> (64 - r));
+		}
+
+		template<class T>
+		inline T read(const byte* p) {
+			T v;
+			std::memcpy(&v, p, sizeof(T));
+			return v;
+		}
+
+		inline u64 xxh_round(u64 acc, u64 input) {
+			acc += input * xxh_prime2;
+			return rotl(acc, 31) * xxh_prime1;
+		}
+
+		inline u64 xxh_merge(u64 acc, u64 v) {
+			acc ^= xxh_round(0, v);
+			return acc * xxh_prime1 + xxh_prime4;
+		}
+	}
+
+	//XXH64 over a byte range, for content hashes of large blobs (little endian hosts)
+	inline hash_type xxh64(const void* data, std::size_t size, u64 seed = 0) noexcept {
+		using namespace detail;
+		auto p = static_cast<const byte*>(data);
+		const auto end = p + size;
+		u64 h;
+
+		if (size >= 32) {
+			u64 v1 = seed + xxh_prime1 + xxh_prime2;
+			u64 v2 = seed + xxh_prime2;
+			u64 v3 = seed;
+			u64 v4 = seed - xxh_prime1;
+			for (; p + 32 <= end; p += 32) {
+				v1 = xxh_round(v1, read<u64>(p));
+				v2 = xxh_round(v2, read<u64>(p + 8));
+				v3 = xxh_round(v3, read<u64>(p + 16));
+				v4 = xxh_round(v4, read<u64>(p + 24));
+			}
+			h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+			h = xxh_merge(h, v1);
+			h = xxh_merge(h, v2);
+			h = xxh_merge(h, v3);
+			h = xxh_merge(h, v4);
+		}
+		else {
+			h = seed + xxh_prime5;
+		}
+
+		h += static_cast<u64>(size);
+		for (; p + 8 <= end; p += 8) {
+			h ^= xxh_round(0, read<u64>(p));
+			h = rotl(h, 27) * xxh_prime1 + xxh_prime4;
+		}
+		if (p + 4 <= end) {
+			h ^= static_cast<u64>(read<u32>(p)) * xxh_prime1;
+			h = rotl(h, 23) * xxh_prime2 + xxh_prime3;
+			p += 4;
+		}
+		for (; p < end; ++p) {
+			h ^= *p * xxh_prime5;
+			h = rotl(h, 11) * xxh_prime1;
+		}
+
+		h ^= h >> 33;
+		h *= xxh_prime2;
+		h ^= h >> 29;
+		h *= xxh_prime3;
+		h ^= h >> 32;
+		return h;
+	}
+}
@@ -24,13 +24,13 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #pragma once
-#include <core\core.h>
-#include <core\string_format.h>
+#include <core/core.h>
+#include <core/string_format.h>
 
-#define RDX_LOG(fmt, ...) redox::detail::log(fmt,  __VA_ARGS__)
+#define RDX_LOG(fmt, ...) redox::detail::log(fmt, ##__VA_ARGS__)
 
 #ifdef RDX_DEBUG
-#define RDX_DEBUG_LOG(fmt, ...) redox::detail::debug_log(##fmt##"\n",  __VA_ARGS__)
+#define RDX_DEBUG_LOG(fmt, ...) redox::detail::debug_log(fmt "\n", ##__VA_ARGS__)
 #else
 #define RDX_DEBUG_LOG(...)
 #endif
@@ -0,0 +1,57 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "core/core.h"
+
+#ifdef RDX_PLATFORM_LINUX
+#include "log.h"
+
+#include <cstdio> //std::fputs
+
+namespace redox::detail {
+	static const Hashmap<ConsoleColor, const char*> color_mappings = {
+		{ConsoleColor::RED, "\033[31m"},
+		{ConsoleColor::GREEN, "\033[96m"},
+		{ConsoleColor::BLUE, "\033[94m"},
+		{ConsoleColor::WHITE, "\033[97m"},
+		{ConsoleColor::GRAY, "\033[90m"},
+	};
+
+	void impl_set_console_color(redox::ConsoleColor color) {
+		auto it = color_mappings.find(color);
+		if (it != color_mappings.end()) {
+			std::fputs(it->second, stdout);
+		}
+	}
+
+	void impl_restore_console_color() {
+		std::fputs("\033[0m", stdout);
+	}
+
+	void impl_debug_log(const redox::String& str) {
+		std::fputs(str.c_str(), stderr);
+	}
+}
+#endif
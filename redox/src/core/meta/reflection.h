@@ -26,65 +26,127 @@ SOFTWARE.
 #pragma once
 #include "type_hash.h"
 
-#include <type_traits> //std::decay
-#include <utility> //std::index_sequence
+#include <type_traits> //std::remove_reference_t
+#include <utility> //std::index_sequence, std::declval
+#include <tuple> //std::tie, std::tuple_element_t
 
 namespace redox::reflection {
 	namespace detail {
+		constexpr size_t max_fields = 20;
+
+		//Only used in unevaluated contexts, T does not need to be a literal type
 		template<size_t I>
 		struct ubiq {
 			template<typename T>
-			constexpr operator T() const noexcept {
-				return T{};
-			}
+			constexpr operator T() const noexcept;
 		};
 
-		template<size_t I>
-		struct ubiq_val {
-			size_t& _hash;
-
-			template<typename T>
-			constexpr operator T() const noexcept {
-				_hash = type_to_hash<std::decay_t<T>>::hash;
-				return T{};
-			}
-		};
-
-		template<typename T, size_t I0, size_t...I>
-		constexpr auto count_fields_impl(size_t& out, std::index_sequence<I0, I...>) noexcept
-			-> decltype(T{ ubiq<I0>{}, ubiq<I>{}... }) {
-			out = sizeof...(I) + 1;
-			return {};
+		template<typename T, size_t...I>
+		constexpr auto count_fields_impl(std::index_sequence<I...>, int) noexcept
+			-> decltype(void(T{ ubiq<I>{}... }), size_t{}) {
+			return sizeof...(I);
 		}
 
 		template<typename T, size_t...I>
-		constexpr void count_fields_impl(size_t& out, std::index_sequence<I...>) noexcept {
-			count_fields_impl<T>(out, std::make_index_sequence<sizeof...(I) - 1>{});
+		constexpr size_t count_fields_impl(std::index_sequence<I...>, long) noexcept {
+			return count_fields_impl<T>(std::make_index_sequence<sizeof...(I) - 1>{}, 0);
 		}
 
 		template<typename T>
 		constexpr size_t count_fields() noexcept {
-			size_t out = 0;
-			count_fields_impl<T>(out, std::make_index_sequence<20>());
-			return out;
+			return count_fields_impl<T>(std::make_index_sequence<max_fields>{}, 0);
 		}
 
-		template<typename T, size_t...N, size_t N0>
-		constexpr void get_field_hash_impl(size_t& out, std::index_sequence<N0, N...>) noexcept {
-			T temp{ ubiq<N>{}..., ubiq_val<N0>{out} };
-		}
-
-		template<typename T, size_t Index>
-		constexpr size_t get_field_hash() noexcept {
-			size_t out = 0;
-			get_field_hash_impl<T>(out, std::make_index_sequence<Index + 1>{});
-			return out;
+		//Never evaluated, only the deduced return type (a tuple of references) is used
+		template<typename T, size_t Count = count_fields<T>()>
+		constexpr auto field_refs(T& object) noexcept {
+			static_assert(Count > 0 && Count <= max_fields, "unsupported field count");
+			if constexpr (Count == 1) {
+				auto& [f0] = object;
+				return std::tie(f0);
+			}
+			else if constexpr (Count == 2) {
+				auto& [f0, f1] = object;
+				return std::tie(f0, f1);
+			}
+			else if constexpr (Count == 3) {
+				auto& [f0, f1, f2] = object;
+				return std::tie(f0, f1, f2);
+			}
+			else if constexpr (Count == 4) {
+				auto& [f0, f1, f2, f3] = object;
+				return std::tie(f0, f1, f2, f3);
+			}
+			else if constexpr (Count == 5) {
+				auto& [f0, f1, f2, f3, f4] = object;
+				return std::tie(f0, f1, f2, f3, f4);
+			}
+			else if constexpr (Count == 6) {
+				auto& [f0, f1, f2, f3, f4, f5] = object;
+				return std::tie(f0, f1, f2, f3, f4, f5);
+			}
+			else if constexpr (Count == 7) {
+				auto& [f0, f1, f2, f3, f4, f5, f6] = object;
+				return std::tie(f0, f1, f2, f3, f4, f5, f6);
+			}
+			else if constexpr (Count == 8) {
+				auto& [f0, f1, f2, f3, f4, f5, f6, f7] = object;
+				return std::tie(f0, f1, f2, f3, f4, f5, f6, f7);
+			}
+			else if constexpr (Count == 9) {
+				auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8] = object;
+				return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8);
+			}
+			else if constexpr (Count == 10) {
+				auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9] = object;
+				return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9);
+			}
+			else if constexpr (Count == 11) {
+				auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10] = object;
+				return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10);
+			}
+			else if constexpr (Count == 12) {
+				auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11] = object;
+				return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11);
+			}
+			else if constexpr (Count == 13) {
+				auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12] = object;
+				return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12);
+			}
+			else if constexpr (Count == 14) {
+				auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13] = object;
+				return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13);
+			}
+			else if constexpr (Count == 15) {
+				auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14] = object;
+				return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14);
+			}
+			else if constexpr (Count == 16) {
+				auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15] = object;
+				return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15);
+			}
+			else if constexpr (Count == 17) {
+				auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16] = object;
+				return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16);
+			}
+			else if constexpr (Count == 18) {
+				auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17] = object;
+				return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17);
+			}
+			else if constexpr (Count == 19) {
+				auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18] = object;
+				return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18);
+			}
+			else if constexpr (Count == 20) {
+				auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19] = object;
+				return std::tie(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19);
+			}
 		}
 
 		template<typename T, size_t Index>
 		struct field_type {
-			using type = typename 
-				hash_to_type<get_field_hash<T, Index>()>::type;
+			using type = std::remove_reference_t<std::tuple_element_t<Index,
+				decltype(field_refs(std::declval<T&>()))>>;
 		};
 
 		template<class T, class Fn, size_t...N>
@@ -97,16 +159,51 @@ namespace redox::reflection {
 			visit_impl<T>(std::forward<Fn>(fn),
 				std::make_index_sequence<detail::count_fields<T>()>{});
 		}
+
+		template<typename T>
+		constexpr hash_type layout_hash() noexcept;
+
+		template<typename T, size_t...N>
+		constexpr hash_type layout_hash_impl(std::index_sequence<N...>) noexcept {
+			hash_type out = type_to_hash<T>::hash;
+			((out = hash::combine(out, layout_hash<typename field_type<T, N>::type>())), ...);
+			return out;
+		}
+
+		template<typename T>
+		constexpr hash_type layout_hash() noexcept {
+			if constexpr (std::is_aggregate_v<T> && !std::is_array_v<T>) {
+				return layout_hash_impl<T>(std::make_index_sequence<count_fields<T>()>{});
+			}
+			else return type_to_hash<T>::hash;
+		}
 	}
 
+	template<typename T, size_t Index>
+	using field_type_t = typename detail::field_type<T, Index>::type;
+
 	template<typename T>
 	struct Reflect {
-		//T needs to be "constexpr aggregate initializable"
+		//T needs to be an aggregate (fields may be enums, math types or nested aggregates)
 
 		constexpr auto field_count() const noexcept {
 			return detail::count_fields<T>();
 		}
 
+		constexpr StringView name() const noexcept {
+			return type_name<T>();
+		}
+
+		constexpr hash_type hash() const noexcept {
+			return type_to_hash<T>::hash;
+		}
+
+		//Combines the hashes of all (nested) field types,
+		//changes whenever the memory layout of T changes
+		constexpr hash_type layout_hash() const noexcept {
+			return detail::layout_hash<T>();
+		}
+
 		template<class Fn>
 		constexpr void visit(Fn&& fn) const noexcept {
 			detail::visit<T>(std::forward<Fn>(fn));
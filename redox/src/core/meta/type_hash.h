@@ -24,35 +24,72 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #pragma once
+#include "core\core.h"
+#include "core\hash.h"
 
 #define RDX_TYPE_HASH(Type)									\
 template<>													\
-struct redox::reflection::type_to_hash<Type> {				\
-	static constexpr hash_type hash = __COUNTER__;			\
-};															\
-template<>													\
 struct redox::reflection::hash_to_type<						\
 	redox::reflection::type_to_hash<Type>::hash> {			\
 	using type = Type;										\
 };															\
 
 namespace redox::reflection {
-	using hash_type = std::size_t;
+	using hash_type = hash::hash_type;
+
+	namespace detail {
+		constexpr StringView trim_type_name(StringView signature) noexcept {
+#if defined __clang__
+			//"... type_name() [T = Type]"
+			auto first = signature.find("T = ") + 4;
+			auto last = signature.rfind(']');
+#elif defined __GNUC__
+			//"... type_name() [with T = Type; redox::StringView = ...]"
+			auto first = signature.find("T = ") + 4;
+			auto last = signature.find(';', first);
+#elif defined _MSC_VER
+			//"... __cdecl redox::reflection::type_name<Type>(void) noexcept"
+			auto first = signature.find("type_name<") + 10;
+			auto last = signature.rfind(">(void)");
+#endif
+			return signature.substr(first, last - first);
+		}
+	}
 
 	template<typename T>
-	struct type_to_hash;
+	constexpr StringView type_name() noexcept {
+#if defined __clang__ || defined __GNUC__
+		return detail::trim_type_name(__PRETTY_FUNCTION__);
+#elif defined _MSC_VER
+		return detail::trim_type_name(__FUNCSIG__);
+#endif
+	}
 
-	template<size_t H>
+	//Derived from the compiler generated type name, so the hash
+	//is identical across translation units and builds (per toolchain)
+	template<typename T>
+	struct type_to_hash {
+		static constexpr hash_type hash = hash::fnv1a(type_name<T>());
+	};
+
+	template<hash_type H>
 	struct hash_to_type;
+
+	template<typename T>
+	constexpr hash_type type_hash_v = type_to_hash<T>::hash;
 }
 
+RDX_TYPE_HASH(bool);
 RDX_TYPE_HASH(char);
+RDX_TYPE_HASH(signed char);
 RDX_TYPE_HASH(unsigned char);
 RDX_TYPE_HASH(short);
 RDX_TYPE_HASH(unsigned short);
 RDX_TYPE_HASH(int);
 RDX_TYPE_HASH(unsigned int);
+RDX_TYPE_HASH(long);
+RDX_TYPE_HASH(unsigned long);
 RDX_TYPE_HASH(long long);
 RDX_TYPE_HASH(unsigned long long);
 RDX_TYPE_HASH(float);
-RDX_TYPE_HASH(double);
\ No newline at end of file
+RDX_TYPE_HASH(double);
@@ -27,18 +27,23 @@ SOFTWARE.
 
 #if defined _WIN32 || defined _WIN64
 #define RDX_PLATFORM_WINDOWS
-#elif defined __unix__ || defined unix
-#define RDX_PLATFORM_UNIX
 #elif defined __linux__
 #define RDX_PLATFORM_LINUX
+#define RDX_PLATFORM_UNIX
 #elif defined __APPLE__ || defined __MACH__
 #define RDX_PLATFORM_OSX
+#elif defined __unix__ || defined unix
+#define RDX_PLATFORM_UNIX
 #endif
 
 #if defined _MSC_VER
 #define RDX_COMPILER_MSVC
-#elif defined __GNUC__ || defined __GNUG__
-#define RDX_COMPILER_GCC
 #elif defined __clang__
 #define RDX_COMPILER_CLANG
+#elif defined __GNUC__ || defined __GNUG__
+#define RDX_COMPILER_GCC
+#endif
+
+#if defined _M_X64 || defined __x86_64__
+#define RDX_ARCH_X64
 #endif
\ No newline at end of file
@@ -0,0 +1,139 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include <core/core.h>
+#include <platform/timer.h>
+
+#include <algorithm> //std::min, std::max
+#include <limits> //std::numeric_limits
+
+#ifdef RDX_COMPILER_MSVC
+#include <intrin.h> //_BitScanReverse64
+#endif
+
+namespace redox {
+	//log-linear histogram of nanosecond samples: every power of two is split into
+	//SubBuckets linear buckets, so percentiles are exact to 1/SubBuckets.
+	//not thread-safe, keep one per thread and merge.
+	class Histogram {
+	public:
+		static constexpr u32 SubBucketBits = 2;
+		static constexpr u32 SubBuckets = 1u << SubBucketBits;
+		static constexpr u32 BucketCount = (64 - SubBucketBits + 1) * SubBuckets;
+
+		RDX_INLINE void record(u64 ns) {
+			++_buckets[index_of(ns)];
+			++_count;
+			_sum += ns;
+			_min = std::min(_min, ns);
+			_max = std::max(_max, ns);
+		}
+
+		void merge(const Histogram& other) {
+			for (u32 i = 0; i < BucketCount; ++i)
+				_buckets[i] += other._buckets[i];
+			_count += other._count;
+			_sum += other._sum;
+			_min = std::min(_min, other._min);
+			_max = std::max(_max, other._max);
+		}
+
+		void reset() {
+			*this = Histogram{};
+		}
+
+		//upper bound of the bucket holding the p-th percentile (p in [0, 1])
+		u64 percentile(f64 p) const {
+			if (_count == 0)
+				return 0;
+
+			const auto rank = static_cast<u64>(p * static_cast<f64>(_count - 1)) + 1;
+			u64 seen = 0;
+			for (u32 i = 0; i < BucketCount; ++i) {
+				seen += _buckets[i];
+				if (seen >= rank)
+					return std::min(lower_bound(i + 1) - 1, _max);
+			}
+			return _max;
+		}
+
+		u64 count() const { return _count; }
+		u64 min() const { return _count ? _min : 0; }
+		u64 max() const { return _max; }
+		f64 mean() const { return _count ? static_cast<f64>(_sum) / _count : 0.0; }
+
+		static RDX_INLINE u32 index_of(u64 value) {
+			if (value < SubBuckets)
+				return static_cast<u32>(value);
+
+			const u32 msb = msb_of(value);
+			const u32 sub = static_cast<u32>(value >> (msb - SubBucketBits)) & (SubBuckets - 1);
+			return (msb - SubBucketBits + 1) * SubBuckets + sub;
+		}
+
+		static constexpr u64 lower_bound(u32 index) {
+			if (index < SubBuckets)
+				return index;
+			if (index >= BucketCount)
+				return std::numeric_limits<u64>::max();
+
+			const u32 msb = index / SubBuckets - 1 + SubBucketBits;
+			return static_cast<u64>(SubBuckets + index % SubBuckets) << (msb - SubBucketBits);
+		}
+
+	private:
+		static RDX_INLINE u32 msb_of(u64 value) {
+#ifdef RDX_COMPILER_MSVC
+			unsigned long msb;
+			_BitScanReverse64(&msb, value);
+			return static_cast<u32>(msb);
+#else
+			return 63 - static_cast<u32>(__builtin_clzll(value));
+#endif
+		}
+
+		Array<u64, BucketCount> _buckets{};
+		u64 _count{ 0 };
+		u64 _sum{ 0 };
+		u64 _min{ std::numeric_limits<u64>::max() };
+		u64 _max{ 0 };
+	};
+
+	//records the lifetime of the scope into a histogram
+	class ScopedTimer {
+	public:
+		RDX_INLINE explicit ScopedTimer(Histogram& histogram) :
+			_histogram(histogram) {}
+
+		RDX_INLINE ~ScopedTimer() {
+			_histogram.record(_timer.elapsed_ns());
+		}
+
+	private:
+		Histogram& _histogram;
+		platform::Timer _timer;
+	};
+}
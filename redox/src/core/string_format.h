@@ -24,7 +24,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #pragma once
-#include "core\core.h"
+#include "core/core.h"
 
 #include <stdlib.h> //std::strtof, std::strtoll
 #include <chrono> //std::chrono::time_point
@@ -47,6 +47,11 @@ namespace redox {
 		return std::strtof(expr.data(), NULL);
 	}
 
+	template<>
+	RDX_INLINE f64 parse(StringView expr) {
+		return std::strtod(expr.data(), NULL);
+	}
+
 	template<>
 	RDX_INLINE i64 parse(StringView expr) {
 		return std::strtoll(expr.data(), NULL, 10);
@@ -67,6 +72,11 @@ namespace redox {
 		return std::strtoull(expr.data(), NULL, 10);
 	}
 
+	template<>
+	RDX_INLINE unsigned long parse(StringView expr) {
+		return std::strtoul(expr.data(), NULL, 10);
+	}
+
 	template<>
 	RDX_INLINE u32 parse(StringView expr) {
 		return std::strtoul(expr.data(), NULL, 10);
@@ -121,6 +131,14 @@ namespace redox {
 		return std::to_string(expr);
 	}
 
+	RDX_INLINE redox::String lexical_cast(const long& expr) {
+		return std::to_string(expr);
+	}
+
+	RDX_INLINE redox::String lexical_cast(const unsigned long& expr) {
+		return std::to_string(expr);
+	}
+
 	RDX_INLINE redox::String lexical_cast(const u32& expr) {
 		return std::to_string(expr);
 	}
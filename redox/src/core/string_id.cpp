@@ -0,0 +1,91 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "string_id.h"
+#include "error.h"
+
+#include <atomic> //std::atomic
+
+namespace {
+	using hash_type = redox::StringId::hash_type;
+
+	//Entries are immutable once published and live as long as the process,
+	//so readers only need an acquire load per bucket
+	struct entry {
+		hash_type hash;
+		redox::String str;
+		entry* next;
+	};
+
+	constexpr std::size_t bucket_count = 4096;
+	std::atomic<entry*> buckets[bucket_count];
+
+	const entry* find(const entry* head, hash_type hash) {
+		for (; head != nullptr; head = head->next) {
+			if (head->hash == hash)
+				return head;
+		}
+		return nullptr;
+	}
+
+	void check_collision(const entry* e, redox::StringView str) {
+		if (e->str != str)
+			throw redox::Exception("string id collision");
+	}
+
+	void intern(hash_type hash, redox::StringView str) {
+		auto& bucket = buckets[hash % bucket_count];
+		auto head = bucket.load(std::memory_order_acquire);
+
+		if (auto e = find(head, hash)) {
+			check_collision(e, str);
+			return;
+		}
+
+		auto node = new entry{ hash, redox::String(str), head };
+		while (!bucket.compare_exchange_weak(node->next, node,
+			std::memory_order_release, std::memory_order_acquire)) {
+
+			//Another thread published entries in the meantime
+			if (auto e = find(node->next, hash)) {
+				delete node;
+				check_collision(e, str);
+				return;
+			}
+		}
+	}
+}
+
+redox::StringId::StringId(StringView str) :
+	_hash(hash::fnv1a(str)) {
+	intern(_hash, str);
+}
+
+redox::StringView redox::StringId::str() const {
+	auto head = buckets[_hash % bucket_count].load(std::memory_order_acquire);
+	if (auto e = find(head, _hash))
+		return e->str;
+	return {};
+}
@@ -0,0 +1,74 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include "core.h"
+#include "hash.h"
+
+namespace redox {
+	//Interned string, compares and hashes as a single integer.
+	//The string itself can be looked up without locking via str()
+	class StringId {
+	public:
+		using hash_type = hash::hash_type;
+
+		constexpr StringId() noexcept = default;
+		explicit StringId(StringView str);
+
+		StringView str() const;
+
+		constexpr hash_type hash() const noexcept {
+			return _hash;
+		}
+
+		constexpr bool valid() const noexcept {
+			return _hash != 0;
+		}
+
+		constexpr bool operator==(const StringId& other) const noexcept {
+			return _hash == other._hash;
+		}
+
+		constexpr bool operator!=(const StringId& other) const noexcept {
+			return _hash != other._hash;
+		}
+
+		constexpr bool operator<(const StringId& other) const noexcept {
+			return _hash < other._hash;
+		}
+
+	private:
+		hash_type _hash{ 0 };
+	};
+}
+
+namespace std {
+	template<>
+	struct hash<redox::StringId> {
+		std::size_t operator()(const redox::StringId& id) const noexcept {
+			return static_cast<std::size_t>(id.hash());
+		}
+	};
+}
\ No newline at end of file
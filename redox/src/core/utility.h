@@ -24,7 +24,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #pragma once
-#include "core\core.h"
+#include "core/core.h"
 #include <type_traits>
 
 #define RDX_HELPER_CONCAT_IMPL(x,y) x##y
@@ -38,7 +38,7 @@ SOFTWARE.
 
 #define RDX_ENABLE_ENUM_FLAGS(en) 								\
 	template<>													\
-	struct ::redox::enable_bit_flags<en> : std::true_type {};	\
+	struct redox::enable_bit_flags<en> : std::true_type {};	\
 
 namespace redox {
 	template<class Enum>
@@ -100,9 +100,13 @@ void redox::graphics::Buffer::copy_to(const Texture& texture) {
 	region.imageSubresource.layerCount = 1;
 	region.imageExtent = { ts.width, ts.height, 1 };
 
-	AuxCommandPool::instance().submit([this, &texture, &region](CommandBufferView cbo) {
+	copy_to(texture, { &region, 1 });
+}
+
+void redox::graphics::Buffer::copy_to(const Texture& texture, Span<const VkBufferImageCopy> regions) {
+	AuxCommandPool::instance().submit([this, &texture, regions](CommandBufferView cbo) {
 		vkCmdCopyBufferToImage(cbo.handle(), _handle, texture.handle(),
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
 	});
 }
 
@@ -119,3 +123,7 @@ void redox::graphics::StagedBuffer::upload() {
 VkBuffer redox::graphics::StagedBuffer::handle() const {
 	return _buffer.handle();
 }
+
+VkDeviceSize redox::graphics::StagedBuffer::size() const {
+	return _buffer.size();
+}
@@ -52,6 +52,8 @@ namespace redox::graphics {
 		void map(FunctionRef<void(void*)> fn);
 		void copy_to(const Buffer& other);
 		void copy_to(const Texture& texture);
+		//one region per mip level, recorded into a single copy
+		void copy_to(const Texture& texture, Span<const VkBufferImageCopy> regions);
 
 	protected:
 		VkBuffer _handle;
@@ -75,6 +77,7 @@ namespace redox::graphics {
 
 		void upload();
 		VkBuffer handle() const;
+		VkDeviceSize size() const;
 
 	private:
 		Buffer _buffer;
@@ -94,8 +97,16 @@ namespace redox::graphics {
 	};
 
 	struct IndexBuffer : public StagedBuffer {
-		IndexBuffer(VkDeviceSize size) :
-			StagedBuffer(size, VK_BUFFER_USAGE_INDEX_BUFFER_BIT) {
+		IndexBuffer(VkDeviceSize size, VkIndexType indexType) :
+			StagedBuffer(size, VK_BUFFER_USAGE_INDEX_BUFFER_BIT),
+			_indexType(indexType) {
+		}
+
+		VkIndexType index_type() const {
+			return _indexType;
 		}
+
+	private:
+		VkIndexType _indexType;
 	};
 }
\ No newline at end of file
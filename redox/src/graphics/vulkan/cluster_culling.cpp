@@ -0,0 +1,81 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "cluster_culling.h"
+
+namespace {
+	redox::f32 plane_distance(const redox::math::Vec4f& plane, const redox::math::Vec3f& p) {
+		return plane.x * p.x + plane.y * p.y + plane.z * p.z + plane.w;
+	}
+}
+
+redox::graphics::CullView redox::graphics::CullView::from(const math::Mat44f& objectToClip, const math::Vec3f& eye) {
+	const math::Vec4f r0 = objectToClip[0];
+	const math::Vec4f r1 = objectToClip[1];
+	const math::Vec4f r2 = objectToClip[2];
+	const math::Vec4f r3 = objectToClip[3];
+
+	//-w <= x,y,z <= w like Mat44::perspective, which also covers the narrower 0 <= z of vulkan
+	CullView view;
+	view.planes = { r3 + r0, r3 - r0, r3 + r1, r3 - r1, r3 + r2, r3 - r2 };
+	for (auto& plane : view.planes) {
+		const auto length = plane.length();
+		if (length > 0.0f)
+			plane = plane / length;
+	}
+	view.eye = eye;
+	return view;
+}
+
+bool redox::graphics::ClusterCuller::visible(const Meshlet& meshlet, const CullView& view) {
+	for (const auto& plane : view.planes) {
+		if (plane_distance(plane, meshlet.center) < -meshlet.radius)
+			return false;
+	}
+
+	if (meshlet.coneCutoff > 1.0f)
+		return true;
+
+	const auto direction = meshlet.coneApex - view.eye;
+	const auto length = direction.length();
+	return length == 0.0f || direction.dot(meshlet.coneAxis) < meshlet.coneCutoff * length;
+}
+
+redox::u32 redox::graphics::ClusterCuller::cull(Span<const Meshlet> meshlets,
+	const CullView& view, redox::Buffer<IndexRange>& ranges) {
+
+	u32 triangles = 0;
+	for (const auto& meshlet : meshlets) {
+		if (!visible(meshlet, view))
+			continue;
+
+		triangles += meshlet.indexCount / 3;
+		if (!ranges.empty() && ranges.back().start + ranges.back().count == meshlet.indexOffset)
+			ranges.back().count += meshlet.indexCount;
+		else
+			ranges.push_back({ meshlet.indexOffset, meshlet.indexCount });
+	}
+	return triangles;
+}
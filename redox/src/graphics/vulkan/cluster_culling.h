@@ -0,0 +1,52 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include "core\core.h"
+#include "math\math.h"
+#include "resources\mesh.h"
+#include "commands.h"
+
+namespace redox::graphics {
+
+	//culling inputs in the object space of the mesh
+	struct CullView {
+		//left, right, bottom, top, near, far; inside when dot(xyz, p) + w >= 0
+		Array<math::Vec4f, 6> planes;
+		math::Vec3f eye;
+
+		//objectToClip is projection * view * model
+		static CullView from(const math::Mat44f& objectToClip, const math::Vec3f& eye);
+	};
+
+	class ClusterCuller {
+	public:
+		//appends the visible meshlets as index ranges, merging neighbouring ones.
+		//returns the number of visible triangles.
+		static u32 cull(Span<const Meshlet> meshlets, const CullView& view, redox::Buffer<IndexRange>& ranges);
+
+		static bool visible(const Meshlet& meshlet, const CullView& view);
+	};
+}
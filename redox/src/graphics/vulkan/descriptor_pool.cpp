@@ -42,6 +42,8 @@ redox::graphics::DescriptorPool::DescriptorPool(uint32_t maxSets, uint32_t maxIm
 	poolInfo.poolSizeCount = util::array_size<uint32_t>(poolSizes);
 	poolInfo.pPoolSizes = poolSizes;
 	poolInfo.maxSets = maxSets;
+	//sets of released materials go back to the pool
+	poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
 
 	if (vkCreateDescriptorPool(Graphics::instance().device(), &poolInfo, nullptr, &_handle) != VK_SUCCESS)
 		throw Exception("failed to create descriptor pool");
@@ -65,6 +67,11 @@ redox::graphics::DescriptorSetView redox::graphics::DescriptorPool::allocate(VkD
 	return set;
 }
 
+void redox::graphics::DescriptorPool::free(DescriptorSetView set) const {
+	auto handle = set.handle();
+	vkFreeDescriptorSets(Graphics::instance().device(), _handle, 1, &handle);
+}
+
 redox::graphics::DescriptorSetView::DescriptorSetView(VkDescriptorSet handle) : _handle(handle) {
 }
 
@@ -110,3 +117,7 @@ void redox::graphics::DescriptorSetView::bind_resource(const UniformBuffer& ubo,
 
 	vkUpdateDescriptorSets(Graphics::instance().device(), 1, &writeSet, 0, nullptr);
 }
+
+VkDescriptorSet redox::graphics::DescriptorSetView::handle() const {
+	return _handle;
+}
\ No newline at end of file
@@ -42,6 +42,8 @@ namespace redox::graphics {
 		void bind_resource(const Texture& texture, uint32_t bindingPoint);
 		void bind_resource(const UniformBuffer& ubo, uint32_t bindingPoint);
 
+		VkDescriptorSet handle() const;
+
 	private:
 		VkDescriptorSet _handle;
 	};
@@ -52,6 +54,8 @@ namespace redox::graphics {
 		~DescriptorPool();
 
 		DescriptorSetView allocate(VkDescriptorSetLayout layout) const;
+		//the set must no longer be used by pending command buffers
+		void free(DescriptorSetView set) const;
 
 	private:
 		VkDescriptorPool _handle;
@@ -26,75 +26,195 @@ SOFTWARE.
 #include "model_factory.h"
 
 #include "resources/importer/gltf_importer.h"
+#include "resources/importer/mesh_cooker.h"
 #include "graphics/vulkan/graphics.h"
 #include "core/application.h"
 
-redox::graphics::ModelFactory::ModelFactory(const DescriptorPool* dp, PipelineCache* pc) 
-: _descriptorPool(dp), _pipelineCache(pc) {
+#include <algorithm> //std::all_of
+
+redox::graphics::ModelFactory::ModelFactory(const DescriptorPool* dp, PipelineCache* pc, TextureFactory* tf) 
+: _descriptorPool(dp), _pipelineCache(pc), _textureFactory(tf) {
+}
+
+namespace {
+	//every path ends in a cooked blob: mapped from disk, copied out of an archive or cooked on the fly
+	struct model_payload : redox::IResourcePayload {
+		redox::UniquePtr<redox::io::MappedFile> file;
+		redox::Buffer<redox::byte> blob;
+		redox::Buffer<redox::ResourceFuture<redox::graphics::SampleTexture>> textures;
+
+		redox::Span<const redox::byte> data() const {
+			return file ? file->data() : redox::Span<const redox::byte>(blob);
+		}
+
+		bool ready() const override {
+			return std::all_of(textures.begin(), textures.end(), [](const auto& texture) { return texture.ready(); });
+		}
+	};
+
+	redox::StringId texture_id(redox::StringView path) {
+		return redox::ResourceManager::make_id("textures" / redox::Path(path).filename());
+	}
+
+	//the textures decode alongside the model instead of one after another in finalize,
+	//normal maps are flagged before their decode picks the format
+	void load_textures(model_payload& model, redox::graphics::TextureFactory* textureFactory) {
+		using namespace redox;
+		auto resources = ResourceManager::instance();
+		CookedMesh cooked(model.data());
+		for (const auto& material : cooked.materials()) {
+			auto albedo = cooked.string(material.albedoMap);
+			auto normal = cooked.string(material.normalMap);
+			textureFactory->set_usage(Path(normal), graphics::TextureUsage::NORMAL);
+
+			model.textures.push_back(resources->load_async<graphics::SampleTexture>(texture_id(albedo)));
+			model.textures.push_back(resources->load_async<graphics::SampleTexture>(texture_id(normal)));
+		}
+	}
+
+	redox::graphics::MeshBounds to_bounds(const redox::CookedMesh::Bounds& bounds) {
+		return {
+			{ bounds.min[0], bounds.min[1], bounds.min[2] },
+			{ bounds.max[0], bounds.max[1], bounds.max[2] }
+		};
+	}
+
+	//decode already runs on a resource worker, parallel_for lets it use the others too
+	redox::MeshCooker::Settings cook_settings() {
+		redox::MeshCooker::Settings settings;
+		settings.workers = &redox::ResourceManager::instance()->workers();
+		settings.optimizer.workers = settings.workers;
+		return settings;
+	}
+
+	redox::String cook_tool() {
+		return "MeshCooker/" + std::to_string(redox::CookedMesh::Version);
+	}
+
+	//every setting that changes the cooked blob, worker pools only change how fast it is made
+	redox::String cook_options(const redox::MeshCooker::Settings& settings) {
+		return std::to_string(settings.optimize) + " " +
+			std::to_string(settings.optimizer.cacheSize) + " " + std::to_string(settings.optimizer.overdrawThreshold) + " " +
+			std::to_string(settings.lodCount) + " " + std::to_string(settings.lodReduction) + " " + std::to_string(settings.lodError) + " " +
+			std::to_string(settings.meshlets) + " " + std::to_string(settings.meshletVertices) + " " + std::to_string(settings.meshletTriangles);
+	}
+
+	redox::graphics::Meshlet to_meshlet(const redox::CookedMesh::MeshletRecord& m) {
+		return {
+			m.indexOffset, m.indexCount,
+			{ m.center[0], m.center[1], m.center[2] }, m.radius,
+			{ m.coneApex[0], m.coneApex[1], m.coneApex[2] },
+			{ m.coneAxis[0], m.coneAxis[1], m.coneAxis[2] }, m.coneCutoff
+		};
+	}
 }
 
 redox::ResourceHandle<redox::IResource> redox::graphics::ModelFactory::load(const Path& path) {
-	GLTFImporter importer(path);
+	return finalize(path, decode(path));
+}
 
-	//import meshes
-	redox::Buffer<ResourceHandle<Mesh>> meshes;
-	meshes.reserve(importer.mesh_count());
+redox::UniquePtr<redox::IResourcePayload> redox::graphics::ModelFactory::decode(const Path& path) {
+	auto model = make_unique<model_payload>();
+	if (path.extension() == ".rmesh") {
+		model->file = make_unique<io::MappedFile>(path, io::MappedFile::Advice::SEQUENTIAL);
+	}
+	else {
+		GLTFImporter importer(path);
+		auto settings = cook_settings();
+
+		//external buffers are inputs of the cook as much as the document itself
+		auto& cache = ResourceManager::instance()->derived_data();
+		auto key = DerivedDataCache::make_key(path, cook_tool(), cook_options(settings));
+		for (const auto& uri : importer.buffer_uris())
+			key = DerivedDataCache::combine(key, path.parent_path() / uri);
+
+		model->file = cache.map(key, io::MappedFile::Advice::SEQUENTIAL);
+		if (!model->file) {
+			model->blob = MeshCooker::cook(importer, settings);
+			//the blob is used either way, a failed store only costs the next load a cook
+			try {
+				cache.store(key, model->blob);
+			}
+			catch (const Exception& e) {
+				RDX_LOG("failed to cache cooked mesh: {0}", ConsoleColor::RED, e.what());
+			}
+		}
+	}
 
-	for (std::size_t i = 0; i < importer.mesh_count(); i++) {
-		auto mesh = importer.import_mesh(i);
+	load_textures(*model, _textureFactory);
+	return model;
+}
 
-		redox::Buffer<MeshVertex> vertices;
-		vertices.reserve(mesh.vertexCount);
+redox::UniquePtr<redox::IResourcePayload> redox::graphics::ModelFactory::decode(const Path& path, Span<const byte> data) {
+	auto model = make_unique<model_payload>();
+	if (CookedMesh::is_cooked(data)) {
+		model->blob.assign(data.begin(), data.end());
+		load_textures(*model, _textureFactory);
+		return model;
+	}
 
-		for (std::size_t i = 0; i < vertices.capacity(); ++i) {
-			vertices.push_back({
-				{ mesh.positions[i * 3 + 0], mesh.positions[i * 3 + 1], mesh.positions[i * 3 + 2] },
-				( mesh.normals.empty() ? math::Vec3f{} : math::Vec3f{ mesh.normals[i * 3 + 0], mesh.normals[i * 3 + 1], mesh.normals[i * 3 + 2] }),
-				( mesh.texcoords.empty() ? math::Vec2f{} : math::Vec2f{ mesh.texcoords[i * 2 + 0], mesh.texcoords[i * 2 + 1] })
-			});
+	//buffers are packed next to the document
+	auto resources = ResourceManager::instance();
+	GLTFImporter importer(data, [resources, dir = path.parent_path()](const String& uri) {
+		auto packed = resources->read_packed(ResourceManager::make_id(dir / uri));
+		if (!packed) {
+			throw Exception(redox::format("gltf buffer {0} is not packed", uri));
 		}
+		return std::move(*packed);
+	});
+	model->blob = MeshCooker::cook(importer, cook_settings());
+	load_textures(*model, _textureFactory);
+	return model;
+}
 
-		redox::Buffer<SubMesh> submeshes;
-		submeshes.reserve(mesh.submeshes.size());
+redox::ResourceHandle<redox::IResource> redox::graphics::ModelFactory::finalize(
+	const Path& path, UniquePtr<IResourcePayload> payload) {
 
-		for (auto& sm : mesh.submeshes) {
-			SubMesh submesh{};
-			submesh.materialIndex = static_cast<uint32_t>(sm.materialIndex);
-			submesh.indexCount = static_cast<uint32_t>(sm.indexCount);
-			submesh.indexOffset = static_cast<uint32_t>(sm.indexOffset);
+	auto model = static_cast<model_payload*>(payload.get());
+	CookedMesh cooked(model->data());
 
-			submeshes.push_back(submesh);
+	redox::Buffer<ResourceHandle<Mesh>> meshes;
+	meshes.reserve(cooked.meshes().size());
+
+	for (const auto& record : cooked.meshes()) {
+		redox::Buffer<SubMesh> submeshes;
+		submeshes.reserve(record.submeshCount);
+		for (const auto& sm : cooked.submeshes(record)) {
+			auto& submesh = submeshes.emplace_back(SubMesh{ sm.indexOffset, sm.indexCount, sm.materialIndex });
+			submesh.firstMeshlet = sm.firstMeshlet;
+			submesh.meshletCount = sm.meshletCount;
+			submesh.lodCount = sm.lodCount;
+			for (u32 level = 0; level < sm.lodCount; level++)
+				submesh.lods[level] = { sm.lods[level].indexOffset, sm.lods[level].indexCount, sm.lods[level].error };
 		}
 
-		meshes.push_back(std::make_shared<Mesh>(
-			std::move(vertices), std::move(mesh.indices), std::move(submeshes)));
+		redox::Buffer<Meshlet> meshlets;
+		meshlets.reserve(record.meshletCount);
+		for (const auto& meshlet : cooked.meshlets(record))
+			meshlets.push_back(to_meshlet(meshlet));
+
+		meshes.push_back(std::make_shared<Mesh>(cooked.vertices(record), cooked.index_data(record),
+			record.indexType, std::move(submeshes), to_bounds(record.bounds), std::move(meshlets)));
 	}
 
-	//import materials
 	redox::Buffer<ResourceHandle<Material>> materials;
-	materials.reserve(importer.material_count());
+	materials.reserve(cooked.materials().size());
 
 	auto resources = ResourceManager::instance();
+	static const StringId fallbackTexture("builtin:textures/uvcheck.png");
 
-	for (std::size_t i = 0; i < importer.material_count(); i++) {
-		auto impMat = importer.import_material(i);
+	//decode started the texture loads, they are cached by now and loading them again
+	//records the model as their dependent. missing ones fall back to a builtin texture.
+	for (const auto& cookedMat : cooked.materials()) {
 		auto pipeline = _pipelineCache->load(PipelineType::DEFAULT_MESH_PIPELINE);
 		auto dset = _descriptorPool->allocate(pipeline->descriptorLayout());
 
-		auto& material = materials.emplace_back(std::make_shared<Material>(pipeline, dset));
+		auto& material = materials.emplace_back(std::make_shared<Material>(pipeline, _descriptorPool, dset));
 
-		Path albedoPath(impMat.albedoMap);
-		auto albedo = resources->load<SampleTexture>(
-			"textures" / albedoPath.filename(),
-			"builtin:textures/uvcheck.png"
-		);
+		auto albedo = resources->load<SampleTexture>(texture_id(cooked.string(cookedMat.albedoMap)), fallbackTexture);
 		material->set_texture(TextureKeys::ALBEDO, std::move(albedo));
 
-		Path normalPath(impMat.normalMap);
-		auto normal = resources->load<SampleTexture>(
-			"textures" / normalPath.filename(),
-			"builtin:textures/uvcheck.png"
-		);
+		auto normal = resources->load<SampleTexture>(texture_id(cooked.string(cookedMat.normalMap)), fallbackTexture);
 		material->set_texture(TextureKeys::NORMAL, std::move(normal));
 	}
 
@@ -102,6 +222,6 @@ redox::ResourceHandle<redox::IResource> redox::graphics::ModelFactory::load(cons
 }
 
 bool redox::graphics::ModelFactory::supports_ext(const Path& ext) {
-	return (ext == ".gltf");
+	return (ext == ".gltf" || ext == ".glb" || ext == ".rmesh");
 }
 
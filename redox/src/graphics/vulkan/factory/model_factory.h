@@ -30,17 +30,24 @@ SOFTWARE.
 namespace redox::graphics {
 	class DescriptorPool;
 	class PipelineCache;
+	class TextureFactory;
 
 	class ModelFactory : public IResourceFactory {
 	public:
-		ModelFactory(const DescriptorPool* dp, PipelineCache* pc);
+		//textures are loaded through the resource manager, tf only receives their usage
+		ModelFactory(const DescriptorPool* dp, PipelineCache* pc, TextureFactory* tf);
 		~ModelFactory() = default;
 
 		ResourceHandle<IResource> load(const Path& path) override;
 		bool supports_ext(const Path& ext) override;
 
+		UniquePtr<IResourcePayload> decode(const Path& path) override;
+		UniquePtr<IResourcePayload> decode(const Path& path, Span<const byte> data) override;
+		ResourceHandle<IResource> finalize(const Path& path, UniquePtr<IResourcePayload> payload) override;
+
 	private:
 		const DescriptorPool* _descriptorPool;
 		PipelineCache* _pipelineCache;
+		TextureFactory* _textureFactory;
 	};
 }
\ No newline at end of file
@@ -27,19 +27,68 @@ SOFTWARE.
 #include <resources/resource_manager.h>
 
 #include <algorithm> //std::find
+#include <cstring> //std::memcpy
+
+namespace {
+	struct spirv_payload : redox::IResourcePayload {
+		redox::UniquePtr<redox::io::MappedFile> file;
+		redox::Buffer<redox::byte> packed;
+		redox::Buffer<redox::Path> includes;
+
+		redox::Span<const redox::byte> code() const {
+			return file ? file->data() : redox::Span<const redox::byte>(packed);
+		}
+	};
+
+	constexpr redox::u32 SpirvMagic = 0x07230203;
+}
 
 redox::ResourceHandle<redox::IResource> redox::graphics::ShaderFactory::load(const Path& path) {
+	return finalize(path, decode(path));
+}
 
-	auto outputDir = path.parent_path() / "compiled";
-	if (!io::exists(outputDir)) {
-		io::create_directory(outputDir);
+redox::UniquePtr<redox::IResourcePayload> redox::graphics::ShaderFactory::decode(const Path& path) {
+	//the stage is taken from the extension, so it is part of the key. editing an include
+	//changes the output as well, their contents are folded in
+	auto& cache = ResourceManager::instance()->derived_data();
+	auto includes = ShaderCompiler::includes(path);
+	auto key = DerivedDataCache::make_key(path, ShaderCompiler::Tool, path.extension().string());
+	for (const auto& include : includes)
+		key = DerivedDataCache::combine(key, include);
+
+	auto spirv = make_unique<spirv_payload>();
+	spirv->file = cache.map(key, io::MappedFile::Advice::WILLNEED);
+	if (!spirv->file) {
+		auto output = cache.store(key, [&path](const Path& staged) {
+			ShaderCompiler::compile_to(path, staged);
+		});
+		spirv->file = make_unique<io::MappedFile>(output, io::MappedFile::Advice::WILLNEED);
 	}
+	spirv->includes = std::move(includes);
+	return spirv;
+}
+
+redox::UniquePtr<redox::IResourcePayload> redox::graphics::ShaderFactory::decode(const Path& path, Span<const byte> data) {
+	//archives carry shaders compiled at pack time
+	u32 magic = 0;
+	if (data.size() >= sizeof(magic))
+		std::memcpy(&magic, data.data(), sizeof(magic));
+	if (magic != SpirvMagic)
+		throw Exception(redox::format("packed shader {0} is not SPIR-V", path));
+
+	auto spirv = make_unique<spirv_payload>();
+	spirv->packed.assign(data.begin(), data.end());
+	return spirv;
+}
 
-	auto output = ShaderCompiler::compile(path, outputDir, true);
-	io::File fstream(output, io::File::Mode::READ | io::File::Mode::THROW_IF_INVALID);
+redox::ResourceHandle<redox::IResource> redox::graphics::ShaderFactory::finalize(
+	const Path& path, UniquePtr<IResourcePayload> payload) {
 
-	auto buffer = fstream.read();
-	return std::make_shared<Shader>(std::move(buffer));
+	//saving an include reloads the shader
+	auto spirv = static_cast<spirv_payload*>(payload.get());
+	for (const auto& include : spirv->includes)
+		ResourceManager::instance()->add_dependency(include);
+	return std::make_shared<Shader>(spirv->code());
 }
 
 bool redox::graphics::ShaderFactory::supports_ext(const Path& ext) {
@@ -33,5 +33,9 @@ namespace redox::graphics {
 	public:
 		ResourceHandle<IResource> load(const Path& path) override;
 		bool supports_ext(const Path& ext) override;
+
+		UniquePtr<IResourcePayload> decode(const Path& path) override;
+		UniquePtr<IResourcePayload> decode(const Path& path, Span<const byte> data) override;
+		ResourceHandle<IResource> finalize(const Path& path, UniquePtr<IResourcePayload> payload) override;
 	};
 }
\ No newline at end of file
@@ -24,47 +24,272 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #include "texture_factory.h"
+#include "graphics\vulkan\graphics.h"
+#include "graphics\vulkan\resources\streaming_texture.h"
+#include "resources\importer\texture_cooker.h"
+#include "platform\filesystem.h"
+#include "resources\resource_manager.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <thirdparty/stbimage/stb_image.h>
 
 namespace {
-	bool load_image(const redox::Path& path, redox::Buffer<redox::byte>& buffer, redox::i32& width, redox::i32& height) {
-		[[maybe_unused]] redox::i32 chan;
-		auto ps = path.string();
-		stbi_uc* pixels = stbi_load(ps.c_str(),
-			&width, &height, &chan, STBI_rgb_alpha);
+	struct image_payload : redox::IResourcePayload {
+		redox::Buffer<redox::byte> pixels;
+		redox::i32 width;
+		redox::i32 height;
 
+		//dds and ktx2 files are kept as they are and uploaded level by level,
+		//either from the mapped file or from a copy in pixels
+		redox::UniquePtr<redox::io::MappedFile> file;
+		redox::Span<const redox::byte> cooked;
+	};
+
+	redox::UniquePtr<image_payload> make_cooked_payload(redox::UniquePtr<image_payload> image) {
+		try {
+			redox::CookedTexture texture(image->cooked);
+			image->width = static_cast<redox::i32>(texture.width());
+			image->height = static_cast<redox::i32>(texture.height());
+			return image;
+		}
+		catch (const redox::Exception& e) {
+			RDX_LOG("failed to load image: {0}", redox::ConsoleColor::RED, e.what());
+			return nullptr;
+		}
+	}
+
+	redox::UniquePtr<image_payload> map_cooked(redox::UniquePtr<redox::io::MappedFile> file) {
+		auto image = redox::make_unique<image_payload>();
+		image->file = std::move(file);
+		image->cooked = image->file->data();
+		return make_cooked_payload(std::move(image));
+	}
+
+	redox::UniquePtr<image_payload> map_cooked(const redox::Path& path) {
+		try {
+			return map_cooked(redox::make_unique<redox::io::MappedFile>(path, redox::io::MappedFile::Advice::SEQUENTIAL));
+		}
+		catch (const redox::Exception& e) {
+			RDX_LOG("failed to load image: {0}", redox::ConsoleColor::RED, e.what());
+			return nullptr;
+		}
+	}
+
+	redox::TextureCooker::Settings cook_settings(redox::graphics::TextureUsage usage) {
+		redox::TextureCooker::Settings settings;
+		settings.workers = &redox::ResourceManager::instance()->workers();
+
+		//encoding and srgb are part of the cache key, so each usage gets its own artifact
+		switch (usage) {
+		case redox::graphics::TextureUsage::NORMAL:
+			settings.encoding = redox::bc::Encoding::BC5;
+			settings.srgb = false;
+			break;
+		case redox::graphics::TextureUsage::DATA:
+			settings.srgb = false;
+			break;
+		default:
+			break;
+		}
+		return settings;
+	}
+
+	redox::String cook_tool() {
+		return "TextureCooker/" + std::to_string(redox::TextureCooker::Version);
+	}
+
+	redox::String cook_options(const redox::TextureCooker::Settings& settings) {
+		return std::to_string(static_cast<redox::u32>(settings.encoding)) + " " +
+			std::to_string(settings.srgb) + " " + std::to_string(settings.mipmaps);
+	}
+
+	//decoded images are cooked once, later loads map the cached result
+	redox::UniquePtr<image_payload> cook_payload(redox::UniquePtr<image_payload> image,
+		redox::DerivedDataCache::key_type key, const redox::TextureCooker::Settings& settings) {
+		if (!image)
+			return nullptr;
+
+		image->pixels = redox::TextureCooker::cook(image->pixels, image->width, image->height, settings);
+		//the cooked pixels are used either way, a failed store only costs the next load a cook
+		try {
+			redox::ResourceManager::instance()->derived_data().store(key, image->pixels);
+		}
+		catch (const redox::Exception& e) {
+			RDX_LOG("failed to cache cooked texture: {0}", redox::ConsoleColor::RED, e.what());
+		}
+		image->cooked = image->pixels;
+		return make_cooked_payload(std::move(image));
+	}
+
+	bool is_cooked_ext(const redox::Path& ext) {
+		return ext == ".dds" || ext == ".ktx2";
+	}
+
+	VkFormat to_vk_format(redox::bc::Encoding encoding) {
+		//sampled as unorm like the uncompressed path, the srgb flag only drives mip filtering
+		switch (encoding) {
+		case redox::bc::Encoding::BC1: return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+		case redox::bc::Encoding::BC3: return VK_FORMAT_BC3_UNORM_BLOCK;
+		case redox::bc::Encoding::BC5: return VK_FORMAT_BC5_UNORM_BLOCK;
+		case redox::bc::Encoding::BC7: return VK_FORMAT_BC7_UNORM_BLOCK;
+		default: return VK_FORMAT_R8G8B8A8_UNORM;
+		}
+	}
+
+	bool supports_sampling(VkFormat format) {
+		VkFormatProperties properties;
+		vkGetPhysicalDeviceFormatProperties(redox::graphics::Graphics::instance().physical_device(), format, &properties);
+		return (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+	}
+
+	redox::UniquePtr<image_payload> make_payload(stbi_uc* pixels, redox::i32 width, redox::i32 height) {
 		if (pixels == nullptr) {
 			RDX_LOG("failed to load image: {0}", redox::ConsoleColor::RED, stbi_failure_reason());
-			return false;
+			return nullptr;
 		}
 
 		RDX_SCOPE_GUARD([pixels]() {
 			stbi_image_free(pixels);
 		});
 
-		auto size = width * height * 4;
-		buffer.assign(pixels, pixels + size);
-		return true;
+		auto image = redox::make_unique<image_payload>();
+		image->width = width;
+		image->height = height;
+		image->pixels.assign(pixels, pixels + width * height * 4);
+		return image;
 	}
 }
 
+redox::graphics::TextureFactory::TextureFactory(TextureStreamer* streamer) :
+	_streamer(streamer) {
+}
+
 redox::ResourceHandle<redox::IResource> redox::graphics::TextureFactory::load(const Path& path) {
+	return finalize(path, decode(path));
+}
+
+redox::UniquePtr<redox::IResourcePayload> redox::graphics::TextureFactory::decode(const Path& path) {
+	if (is_cooked_ext(path.extension())) {
+		return map_cooked(path);
+	}
+
+	auto settings = cook_settings(_usage(path));
+	auto& cache = ResourceManager::instance()->derived_data();
+	DerivedDataCache::key_type key;
+	try {
+		key = DerivedDataCache::make_key(path, cook_tool(), cook_options(settings));
+	}
+	catch (const Exception& e) {
+		RDX_LOG("failed to load image: {0}", ConsoleColor::RED, e.what());
+		return nullptr;
+	}
+
+	if (auto cached = cache.map(key, io::MappedFile::Advice::SEQUENTIAL)) {
+		return map_cooked(std::move(cached));
+	}
+
+	[[maybe_unused]] i32 chan;
 	i32 width, height;
-	redox::Buffer<byte> buffer;
-	if (!load_image(path, buffer, width, height)) {
+	auto ps = path.string();
+	return cook_payload(make_payload(stbi_load(ps.c_str(), &width, &height, &chan, STBI_rgb_alpha), width, height),
+		key, settings);
+}
+
+redox::UniquePtr<redox::IResourcePayload> redox::graphics::TextureFactory::decode(const Path& path, Span<const byte> data) {
+	if (CookedTexture::is_cooked(data)) {
+		auto image = make_unique<image_payload>();
+		image->pixels.assign(data.begin(), data.end());
+		image->cooked = image->pixels;
+		return make_cooked_payload(std::move(image));
+	}
+
+	auto settings = cook_settings(_usage(path));
+	auto key = DerivedDataCache::make_key(data, cook_tool(), cook_options(settings));
+	if (auto cached = ResourceManager::instance()->derived_data().map(key, io::MappedFile::Advice::SEQUENTIAL)) {
+		return map_cooked(std::move(cached));
+	}
+
+	[[maybe_unused]] i32 chan;
+	i32 width, height;
+	return cook_payload(make_payload(stbi_load_from_memory(data.data(), static_cast<int>(data.size()),
+		&width, &height, &chan, STBI_rgb_alpha), width, height), key, settings);
+}
+
+redox::ResourceHandle<redox::IResource> redox::graphics::TextureFactory::finalize(
+	const Path& path, UniquePtr<IResourcePayload> payload) {
+
+	if (!payload) {
 		return nullptr;
 	}
 
+	auto image = static_cast<image_payload*>(payload.get());
+	if (!image->cooked.empty()) {
+		CookedTexture texture(image->cooked);
+		const VkExtent2D extent{ texture.width(), texture.height() };
+
+		auto format = to_vk_format(texture.encoding());
+		if (_streamer && supports_sampling(format) && StreamingTexture::is_streamable(texture)) {
+			const auto cooked = image->cooked;
+			auto streamed = std::make_shared<StreamingTexture>(std::move(payload), cooked, format);
+			_streamer->add(streamed);
+			return streamed;
+		}
+
+		if (supports_sampling(format)) {
+			redox::Buffer<Span<const byte>> levels;
+			for (u32 i = 0; i < texture.level_count(); i++)
+				levels.push_back(texture.level(i).data);
+			return std::make_shared<SampleTexture>(levels, format, extent);
+		}
+
+		//no block compression on this device, expand every level to RGBA8. BC7 written by
+		//other encoders uses modes the decoder lacks, those textures are rejected up front
+		for (u32 i = 0; i < texture.level_count(); i++) {
+			const auto level = texture.level(i);
+			if (!bc::decodable(texture.encoding(), level.data.data(), level.width, level.height)) {
+				RDX_LOG("block compressed format {0} is not supported and {1} cannot be decompressed, "
+					"only bc7 mode 6 blocks are", ConsoleColor::RED, static_cast<i32>(format), path.string());
+				return nullptr;
+			}
+		}
+
+		RDX_LOG("block compressed format {0} is not supported, decompressing {1}",
+			static_cast<i32>(format), path.string());
+		redox::Buffer<redox::Buffer<u8>> decoded(texture.level_count());
+		redox::Buffer<Span<const byte>> levels;
+		for (u32 i = 0; i < texture.level_count(); i++) {
+			const auto level = texture.level(i);
+			decoded[i].resize(std::size_t(level.width) * level.height * 4);
+			bc::decode(texture.encoding(), level.data.data(), level.width, level.height, decoded[i].data());
+			levels.push_back(decoded[i]);
+		}
+		return std::make_shared<SampleTexture>(levels, VK_FORMAT_R8G8B8A8_UNORM, extent);
+	}
+
 	return std::make_shared<SampleTexture>(
-		std::move(buffer), VK_FORMAT_R8G8B8A8_UNORM,
-		VkExtent2D{ static_cast<uint32_t>(width), static_cast<uint32_t>(height) 
+		std::move(image->pixels), VK_FORMAT_R8G8B8A8_UNORM,
+		VkExtent2D{ static_cast<uint32_t>(image->width), static_cast<uint32_t>(image->height) 
 	});
 }
 
+bool redox::graphics::TextureFactory::decodes_from_memory(const Path& ext) {
+	//images are read whole for their cache key anyway, cooked ones are mapped in place instead
+	return !is_cooked_ext(ext);
+}
+
+void redox::graphics::TextureFactory::set_usage(const Path& path, TextureUsage usage) {
+	std::lock_guard<std::mutex> lock(_usageMutex);
+	_usages[StringId(path.filename().generic_string())] = usage;
+}
+
+redox::graphics::TextureUsage redox::graphics::TextureFactory::_usage(const Path& path) {
+	std::lock_guard<std::mutex> lock(_usageMutex);
+	auto it = _usages.find(StringId(path.filename().generic_string()));
+	return it != _usages.end() ? it->second : TextureUsage::COLOR;
+}
+
 bool redox::graphics::TextureFactory::supports_ext(const Path& ext) {
-	Array<StringView, 9> supported = { ".jpeg", ".jpg", ".png", ".tga", ".bmp", ".psd", ".gif", ".hdr", ".pic" };
+	Array<StringView, 11> supported = { ".jpeg", ".jpg", ".png", ".tga", ".bmp", ".psd", ".gif", ".hdr", ".pic", ".dds", ".ktx2" };
 	return std::find(supported.begin(), supported.end(), ext) != supported.end();
 }
 
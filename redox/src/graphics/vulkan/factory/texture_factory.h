@@ -25,15 +25,43 @@ SOFTWARE.
 */
 #pragma once
 #include "graphics\vulkan\resources\texture.h"
-#include "resources\resource.h"	
+#include "resources\resource.h"
+#include "core\string_id.h"
+
+#include <mutex> //std::mutex	
 
 namespace redox::graphics {
+	class TextureStreamer;
+
+	//decides how loose images are cooked: color is mip filtered in linear light,
+	//normal maps keep two linear channels in BC5 and other data stays linear BC7
+	enum class TextureUsage {
+		COLOR, NORMAL, DATA
+	};
 	
 	class TextureFactory : public IResourceFactory {
 	public:
+		//cooked textures with a mip chain are streamed through streamer when given
+		explicit TextureFactory(TextureStreamer* streamer = nullptr);
 		~TextureFactory() override = default;
 		ResourceHandle<IResource> load(const Path& path) override;
 		bool supports_ext(const Path& ext) override;
+
+		UniquePtr<IResourcePayload> decode(const Path& path) override;
+		UniquePtr<IResourcePayload> decode(const Path& path, Span<const byte> data) override;
+		ResourceHandle<IResource> finalize(const Path& path, UniquePtr<IResourcePayload> payload) override;
+		bool decodes_from_memory(const Path& ext) override;
+
+		//images are cooked as COLOR unless hinted before their first load. hints are
+		//keyed by file name, so they also apply when the file is hot reloaded.
+		void set_usage(const Path& path, TextureUsage usage);
+
+	private:
+		TextureUsage _usage(const Path& path);
+
+		TextureStreamer* _streamer;
+		std::mutex _usageMutex;
+		Hashmap<StringId, TextureUsage> _usages;
 	};
 
 }
\ No newline at end of file
@@ -27,6 +27,9 @@ SOFTWARE.
 #include <core/utility.h>
 #include <core/profiling/profiler.h>
 #include <core/application.h>
+#include <graphics/vulkan/cluster_culling.h>
+
+#include <algorithm> //std::remove_if
 
 const redox::graphics::RenderSystem* redox::graphics::RenderSystem::instance() {
 	return Application::instance->render_system();
@@ -50,8 +53,9 @@ redox::graphics::RenderSystem::RenderSystem() :
 		pipeline->set_viewport(_swapchain->extent());
 	};
 
-	_textureFactory = make_unique<TextureFactory>();
-	_modelFactory = make_unique<ModelFactory>(&_descriptorPool, _pipelineCache.get());
+	_textureStreamer = make_unique<TextureStreamer>(TextureStreamingBudget);
+	_textureFactory = make_unique<TextureFactory>(_textureStreamer.get());
+	_modelFactory = make_unique<ModelFactory>(&_descriptorPool, _pipelineCache.get(), _textureFactory.get());
 	_shaderFactory = make_unique<ShaderFactory>();
 
 	ResourceManager::instance()->register_factory(_textureFactory.get());
@@ -59,35 +63,49 @@ redox::graphics::RenderSystem::RenderSystem() :
 	ResourceManager::instance()->register_factory(_shaderFactory.get());
 
 	_demo_load_assets();
+
+	ResourceManager::instance()->onReloadResource += [this](auto old, auto resource) {
+		if (old != _demoModel)
+			return;
+
+		_retired.emplace_back(_frames, std::move(_demoModel));
+		_demoModel = std::static_pointer_cast<Model>(resource);
+		for (auto& mat : _demoModel->materials()) {
+			mat->set_buffer(BufferKeys::MVP, _mvpBuffer);
+		}
+	};
 }
 
 redox::graphics::RenderSystem::~RenderSystem() {
 	Graphics::instance().wait_pending();
+	_retired.clear();
+	_demoModel = nullptr;
+
+	//cached materials hold sets of the pool destroyed with this system
+	ResourceManager::instance()->clear_cache(ResourceGroup::GRAPHICS);
 }
 
 void redox::graphics::RenderSystem::_demo_cam_move() {
-	static math::Vec3f camPosition{ 0,0,-30 };
-
 	auto input = Application::instance->input_system();
 	if (input->key_state(input::Keys::W) == input::KeyState::PRESSED) {
-		camPosition.z += 0.5f;
+		_demoCamPosition.z += 0.5f;
 	}
 	else if (input->key_state(input::Keys::S) == input::KeyState::PRESSED) {
-		camPosition.z -= 0.5f;
+		_demoCamPosition.z -= 0.5f;
 	}
 
 	if (input->key_state(input::Keys::D) == input::KeyState::PRESSED) {
-		camPosition.x += 0.5f;
+		_demoCamPosition.x += 0.5f;
 	}
 	else if (input->key_state(input::Keys::A) == input::KeyState::PRESSED) {
-		camPosition.x -= 0.5f;
+		_demoCamPosition.x -= 0.5f;
 	}
 
 	if (input->key_state(input::Keys::Q) == input::KeyState::PRESSED) {
-		camPosition.y += 0.5f;
+		_demoCamPosition.y += 0.5f;
 	}
 	else if (input->key_state(input::Keys::E) == input::KeyState::PRESSED) {
-		camPosition.y -= 0.5f;
+		_demoCamPosition.y -= 0.5f;
 	}
 
 	_mvpBuffer.map<mvp_uniform>([this](mvp_uniform* data) {
@@ -95,8 +113,8 @@ void redox::graphics::RenderSystem::_demo_cam_move() {
 		auto ratio = static_cast<f32>(extent.width) / static_cast<f32>(extent.height);
 
 		data->model = math::Mat44f::rotate_euler({ -90, 0, 0 });
-		data->projection = math::Mat44f::perspective(45.0f, ratio, 0.1f, 1000.f);
-		data->view = math::Mat44f::translate(camPosition);
+		data->projection = math::Mat44f::perspective(_demoFov, ratio, 0.1f, 1000.f);
+		data->view = math::Mat44f::translate(_demoCamPosition);
 	});
 
 	_mvpBuffer.upload();
@@ -107,12 +125,43 @@ void redox::graphics::RenderSystem::_demo_draw() {
 		RDX_UNUSED(commandBuffer.scoped_record());
 		RDX_UNUSED(_forwardPass->scoped_begin(frameBuffer, commandBuffer));
 
+		const auto extent = _swapchain->extent();
+		const auto screenHeight = static_cast<f32>(extent.height);
+
+		//same transforms as the uniform, the eye is moved into model space for the cone test
+		const auto objectToClip = math::Mat44f::perspective(_demoFov,
+			static_cast<f32>(extent.width) / screenHeight, 0.1f, 1000.f) *
+			math::Mat44f::translate(_demoCamPosition) * math::Mat44f::rotate_euler({ -90, 0, 0 });
+		const math::Vec4f eye = math::Mat44f::rotate_euler({ 90, 0, 0 }) *
+			math::Vec4f(-_demoCamPosition.x, -_demoCamPosition.y, -_demoCamPosition.z, 1.0f);
+		const auto cullView = CullView::from(objectToClip, { eye.x, eye.y, eye.z });
+		redox::Buffer<IndexRange> ranges;
+
 		for (const auto& mesh : _demoModel->meshes()) {
+			//the demo camera orbits the model origin, so the distance to the rotated
+			//bounds is at least the camera distance minus the offset of their center
+			const auto& bounds = mesh->bounds();
+			const auto distance = _demoCamPosition.length() - bounds.center().length();
+			const auto screenRadius = projected_radius(bounds.radius(), distance,
+				math::deg2rad(_demoFov), screenHeight);
+
 			for (const auto& sm : mesh->submeshes()) {
 				auto material = _demoModel->materials()[sm.materialIndex];
-				commandBuffer.submit(make_unique<IndexedDraw>(
-					mesh, material, IndexRange{sm.indexOffset, sm.indexCount}
-				));
+				auto level = sm.select_lod(screenRadius);
+				material->request_detail(2.0f * screenRadius);
+
+				//clusters only exist for the full level, coarser levels are drawn whole
+				ranges.clear();
+				if (level == 0 && sm.meshletCount > 0) {
+					ClusterCuller::cull(mesh->meshlets(sm), cullView, ranges);
+				}
+				else {
+					auto lod = sm.lod(level);
+					ranges.push_back({ lod.indexOffset, lod.indexCount });
+				}
+
+				for (const auto& range : ranges)
+					commandBuffer.submit(make_unique<IndexedDraw>(mesh, material, range));
 			}
 		}
 	});
@@ -133,6 +182,9 @@ void redox::graphics::RenderSystem::_demo_load_assets() {
 }
 
 void redox::graphics::RenderSystem::render() {
+	_frames++;
+	_release_retired();
+	_textureStreamer->update();
 	_demo_cam_move();
 	_demo_draw();
 	_swapchain->present();
@@ -145,4 +197,10 @@ void redox::graphics::RenderSystem::_swapchain_event_resize() {
 
 	_forwardPass->resize_attachments(_swapchain->extent());
 	_swapchain->create_fbs(*_forwardPass);
+}
+
+void redox::graphics::RenderSystem::_release_retired() {
+	_retired.erase(std::remove_if(_retired.begin(), _retired.end(), [this](const auto& retired) {
+		return retired.first + RetireDelay <= _frames;
+	}), _retired.end());
 }
\ No newline at end of file
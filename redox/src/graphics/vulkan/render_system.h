@@ -31,6 +31,7 @@ SOFTWARE.
 #include "platform\window.h"
 #include "graphics.h"
 #include "render_pass.h"
+#include "resources\streaming_texture.h"
 #include "math\math.h"
 
 namespace redox::graphics {
@@ -38,6 +39,11 @@ namespace redox::graphics {
 	class RenderSystem : public NonCopyable {
 	public:
 		static const RenderSystem* instance();
+		//device memory the streamed textures may take together
+		static constexpr VkDeviceSize TextureStreamingBudget = 256ull * 1024 * 1024;
+		//replaced models may still be referenced by frames in flight, they are
+		//released RetireDelay frames later
+		static constexpr u64 RetireDelay = 3;
 
 		RenderSystem();
 		~RenderSystem();
@@ -52,20 +58,27 @@ namespace redox::graphics {
 		};
 		
 		void _swapchain_event_resize();
+		void _release_retired();
 
 		UniformBuffer _mvpBuffer;
 		DescriptorPool _descriptorPool;
 
 		//@DEMO
 		ResourceHandle<Model> _demoModel;
+		math::Vec3f _demoCamPosition{ 0, 0, -30 };
+		static constexpr f32 _demoFov = 45.0f;
 		void _demo_cam_move();
 		void _demo_draw();
 		void _demo_load_assets();
 		//@@@
 
+		u64 _frames = 0;
+		redox::Buffer<std::pair<u64, ResourceHandle<Model>>> _retired;
+
 		UniquePtr<Swapchain> _swapchain;
 		UniquePtr<RenderPass> _forwardPass;
 		UniquePtr<PipelineCache> _pipelineCache;
+		UniquePtr<TextureStreamer> _textureStreamer;
 
 		UniquePtr<ModelFactory> _modelFactory;
 		UniquePtr<TextureFactory> _textureFactory;
@@ -26,19 +26,32 @@ SOFTWARE.
 #include "material.h"
 #include "graphics\vulkan\graphics.h"
 
-redox::graphics::Material::Material(PipelineHandle pipeline, DescriptorSetView descSet) :
-	_pipeline(std::move(pipeline)),
-	_descSet(descSet) {
+redox::graphics::Material::Material(PipelineHandle pipeline, const DescriptorPool* pool, DescriptorSetView descSet) :
+	_descPool(pool),
+	_descSet(descSet),
+	_pipeline(std::move(pipeline)) {
+}
+
+redox::graphics::Material::~Material() {
+	_descPool->free(_descSet);
 }
 
 void redox::graphics::Material::bind(const CommandBufferView& commandBuffer) {
+	//streamed textures swap their image, the set has to point at the new view
+	for (auto& it : _textures) {
+		if (it.second.generation != it.second.texture->generation()) {
+			_bind_texture(it.first, *it.second.texture);
+			it.second.generation = it.second.texture->generation();
+		}
+	}
+
 	_pipeline->bind(commandBuffer);
 	_descSet.bind(commandBuffer, *_pipeline);
 }
 
 void redox::graphics::Material::upload() {
 	for (auto& it : _textures)
-		it.second->upload();
+		it.second.texture->upload();
 }
 
 redox::ResourceGroup redox::graphics::Material::res_group() const {
@@ -55,15 +68,25 @@ void redox::graphics::Material::set_buffer(BufferKeys key, const UniformBuffer&
 }
 
 void redox::graphics::Material::set_texture(TextureKeys key, ResourceHandle<SampleTexture> texture) {
+	_bind_texture(key, *texture);
+
+	const auto generation = texture->generation();
+	_textures.insert({ key, { std::move(texture), generation } });
+}
+
+void redox::graphics::Material::request_detail(f32 screenSize) {
+	for (auto& it : _textures)
+		it.second.texture->request_detail(screenSize);
+}
+
+void redox::graphics::Material::_bind_texture(TextureKeys key, const SampleTexture& texture) {
 
 	switch (key) {
 	case redox::graphics::TextureKeys::ALBEDO:
-		_descSet.bind_resource(*texture, 1);
+		_descSet.bind_resource(texture, 1);
 		break;
 	case redox::graphics::TextureKeys::NORMAL:
-		_descSet.bind_resource(*texture, 2);
+		_descSet.bind_resource(texture, 2);
 		break;
 	}
-
-	_textures.insert({ key, std::move(texture) });
 }
@@ -44,8 +44,9 @@ namespace redox::graphics {
 
 	class Material : public IResource {
 	public:
-		Material(PipelineHandle pipeline, DescriptorSetView descSet);
-		~Material() override = default;
+		//descSet is allocated from pool and returned to it on destruction
+		Material(PipelineHandle pipeline, const DescriptorPool* pool, DescriptorSetView descSet);
+		~Material() override;
 
 		void bind(const CommandBufferView& commandBuffer);
 		void upload() override;
@@ -53,11 +54,21 @@ namespace redox::graphics {
 
 		void set_buffer(BufferKeys key, const UniformBuffer& buffer);
 		void set_texture(TextureKeys key, ResourceHandle<SampleTexture> texture);
+		//forwards how large the material appears on screen to its textures
+		void request_detail(f32 screenSize);
 
 	private:
+		struct bound_texture {
+			ResourceHandle<SampleTexture> texture;
+			u32 generation;
+		};
+
+		void _bind_texture(TextureKeys key, const SampleTexture& texture);
+
+		const DescriptorPool* _descPool;
 		DescriptorSetView _descSet;
 		PipelineHandle _pipeline;
 
-		redox::Hashmap<TextureKeys, ResourceHandle<SampleTexture>> _textures;
+		redox::Hashmap<TextureKeys, bound_texture> _textures;
 	};
 }
\ No newline at end of file
@@ -27,20 +27,53 @@ SOFTWARE.
 #include "graphics\vulkan\graphics.h"
 #include "graphics\vulkan\command_pool.h"
 
-redox::graphics::Mesh::Mesh(const redox::Buffer<MeshVertex>& vertices,
-	const redox::Buffer<uint16_t>& indices, redox::Buffer<SubMesh> submeshes) :
-	_vertexCount(vertices.size()),
-	_indexCount(indices.size()),
+#include <cmath> //std::tan
+#include <algorithm> //std::max
+
+redox::math::Vec3f redox::graphics::MeshBounds::center() const {
+	return (min + max) * 0.5f;
+}
+
+redox::f32 redox::graphics::MeshBounds::radius() const {
+	return (max - min).length() * 0.5f;
+}
+
+redox::f32 redox::graphics::projected_radius(f32 radius, f32 distance, f32 fovY, f32 screenHeight) {
+	constexpr f32 nearest = 1e-3f;
+	return radius * screenHeight / (2.0f * std::tan(fovY * 0.5f) * std::max(distance, nearest));
+}
+
+redox::graphics::SubMeshLod redox::graphics::SubMesh::lod(uint32_t level) const {
+	if (level == 0 || level > lodCount)
+		return { indexOffset, indexCount, 0.0f };
+	return lods[level - 1];
+}
+
+uint32_t redox::graphics::SubMesh::select_lod(f32 screenRadius, f32 pixelError) const {
+	uint32_t level = 0;
+	while (level < lodCount && lods[level].error * screenRadius <= pixelError)
+		level++;
+	return level;
+}
+
+redox::graphics::Mesh::Mesh(Span<const MeshVertex> vertices, Span<const byte> indices, IndexType indexType,
+	redox::Buffer<SubMesh> submeshes, const MeshBounds& bounds, redox::Buffer<Meshlet> meshlets) :
+	_vertexCount(static_cast<uint32_t>(vertices.size())),
+	_indexCount(static_cast<uint32_t>(indices.size() / static_cast<uint32_t>(indexType))),
+	_indexType(indexType),
+	_bounds(bounds),
 	_submeshes(std::move(submeshes)),
-	_vertexBuffer(util::byte_size(vertices)),
-	_indexBuffer(util::byte_size(indices)) {
+	_meshlets(std::move(meshlets)),
+	_vertexBuffer(vertices.size_bytes()),
+	_indexBuffer(indices.size_bytes(),
+		indexType == IndexType::U32 ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16) {
 
 	_vertexBuffer.map([&vertices](void* dest) {
-		std::memcpy(dest, vertices.data(), util::byte_size(vertices));
+		std::memcpy(dest, vertices.data(), vertices.size_bytes());
 	});
 
 	_indexBuffer.map([&indices](void* dest) {
-		std::memcpy(dest, indices.data(), util::byte_size(indices));
+		std::memcpy(dest, indices.data(), indices.size_bytes());
 	});
 }
 
@@ -48,7 +81,7 @@ void redox::graphics::Mesh::bind(const CommandBufferView& commandBuffer) {
 	VkBuffer vb = _vertexBuffer.handle();
 	VkDeviceSize offset = 0;
 	vkCmdBindVertexBuffers(commandBuffer.handle(), 0, 1, &vb, &offset);
-	vkCmdBindIndexBuffer(commandBuffer.handle(), _indexBuffer.handle(), 0, VK_INDEX_TYPE_UINT16);
+	vkCmdBindIndexBuffer(commandBuffer.handle(), _indexBuffer.handle(), 0, _indexBuffer.index_type());
 }
 
 void redox::graphics::Mesh::upload() {
@@ -60,6 +93,15 @@ redox::ResourceGroup redox::graphics::Mesh::res_group() const {
 	return ResourceGroup::GRAPHICS;
 }
 
+redox::ResourceSize redox::graphics::Mesh::size() const {
+	//both buffers keep their staging copy
+	const auto buffers = _indexBuffer.size() + _vertexBuffer.size();
+	return {
+		buffers + _submeshes.size() * sizeof(SubMesh) + _meshlets.size() * sizeof(Meshlet),
+		buffers
+	};
+}
+
 uint32_t redox::graphics::Mesh::vertex_count() const {
 	return _vertexCount;
 }
@@ -68,6 +110,18 @@ uint32_t redox::graphics::Mesh::index_count() const {
 	return _indexCount;
 }
 
+redox::graphics::IndexType redox::graphics::Mesh::index_type() const {
+	return _indexType;
+}
+
 const redox::Buffer<redox::graphics::SubMesh>& redox::graphics::Mesh::submeshes() const {
 	return _submeshes;
 }
+
+const redox::graphics::MeshBounds& redox::graphics::Mesh::bounds() const {
+	return _bounds;
+}
+
+redox::Span<const redox::graphics::Meshlet> redox::graphics::Mesh::meshlets(const SubMesh& submesh) const {
+	return Span<const Meshlet>(_meshlets).subspan(submesh.firstMeshlet, submesh.meshletCount);
+}
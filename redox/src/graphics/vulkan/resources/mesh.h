@@ -38,32 +38,97 @@ namespace redox::graphics {
 		math::Vec2f uv;
 	};
 
+	//cluster of at most 64 vertices and 124 triangles, stored as a contiguous
+	//index range so it can be culled and drawn on its own
+	struct Meshlet {
+		uint32_t indexOffset;	//elements, relative to the mesh
+		uint32_t indexCount;
+		math::Vec3f center;
+		f32 radius;
+
+		//every triangle faces away from eye positions p with
+		//dot(normalize(coneApex - p), coneAxis) >= coneCutoff. cutoff > 1 never culls.
+		math::Vec3f coneApex;
+		math::Vec3f coneAxis;
+		f32 coneCutoff;
+	};
+
+	struct SubMeshLod {
+		uint32_t indexOffset;
+		uint32_t indexCount;
+		f32 error;	//deviation from the full mesh, relative to the bounds radius
+	};
+
 	struct SubMesh {
+		static constexpr uint32_t MaxLods = 4;
+
 		uint32_t indexOffset;
 		uint32_t indexCount;
 		std::size_t materialIndex;
+
+		//coarser levels over the same vertices, ordered by increasing error
+		uint32_t lodCount = 0;
+		Array<SubMeshLod, MaxLods> lods{};
+
+		//clusters of the full resolution range, into Mesh::meshlets
+		uint32_t firstMeshlet = 0;
+		uint32_t meshletCount = 0;
+
+		//level 0 is the full resolution range
+		SubMeshLod lod(uint32_t level) const;
+
+		//coarsest level whose error stays below pixelError once the bounds
+		//cover screenRadius pixels
+		uint32_t select_lod(f32 screenRadius, f32 pixelError = 1.0f) const;
+	};
+
+	//values double as the index stride in bytes. there is no 8 bit variant,
+	//core vulkan cannot bind one
+	enum class IndexType : uint32_t {
+		U16 = 2,
+		U32 = 4
 	};
 
+	struct MeshBounds {
+		math::Vec3f min;
+		math::Vec3f max;
+
+		math::Vec3f center() const;
+		f32 radius() const;
+	};
+
+	//radius in pixels of a bounding sphere seen by a perspective camera
+	f32 projected_radius(f32 radius, f32 distance, f32 fovY, f32 screenHeight);
+
 	class Mesh : public IResource {
 	public:
-		Mesh(const redox::Buffer<MeshVertex>& vertices, 
-			const redox::Buffer<uint16_t>& indices, redox::Buffer<SubMesh> submeshes);
+		//indices holds tightly packed values of the given type
+		Mesh(Span<const MeshVertex> vertices, Span<const byte> indices, IndexType indexType,
+			redox::Buffer<SubMesh> submeshes, const MeshBounds& bounds = {},
+			redox::Buffer<Meshlet> meshlets = {});
 		~Mesh() override = default;
 
 		void bind(const CommandBufferView& commandBuffer);
 		void upload() override;
 		ResourceGroup res_group() const override;
+		ResourceSize size() const override;
 
 		uint32_t vertex_count() const;
 		uint32_t index_count() const;
+		IndexType index_type() const;
 
 		const redox::Buffer<SubMesh>& submeshes() const;
+		const MeshBounds& bounds() const;
+		Span<const Meshlet> meshlets(const SubMesh& submesh) const;
 
 	private:
 		uint32_t _vertexCount;
 		uint32_t _indexCount;
+		IndexType _indexType;
+		MeshBounds _bounds;
 
 		redox::Buffer<SubMesh> _submeshes;
+		redox::Buffer<Meshlet> _meshlets;
 
 		IndexBuffer _indexBuffer;
 		VertexBuffer _vertexBuffer;
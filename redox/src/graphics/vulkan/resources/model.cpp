@@ -42,6 +42,16 @@ redox::ResourceGroup redox::graphics::Model::res_group() const {
 	return ResourceGroup::GRAPHICS;
 }
 
+redox::ResourceSize redox::graphics::Model::size() const {
+	ResourceSize size{ 0, 0 };
+	for (const auto& mesh : _meshes) {
+		auto meshSize = mesh->size();
+		size.cpu += meshSize.cpu;
+		size.gpu += meshSize.gpu;
+	}
+	return size;
+}
+
 const redox::graphics::Model::mesh_buffer& redox::graphics::Model::meshes() const {
 	return _meshes;
 }
@@ -40,6 +40,8 @@ namespace redox::graphics {
 		~Model() override = default;
 		void upload() override;
 		ResourceGroup res_group() const override;
+		//meshes belong to the model, textures are cached on their own
+		ResourceSize size() const override;
 
 		const mesh_buffer& meshes() const;
 		const material_buffer& materials() const;
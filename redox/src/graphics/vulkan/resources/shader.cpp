@@ -28,12 +28,12 @@ SOFTWARE.
 
 #include "platform\filesystem.h"
 
-redox::graphics::Shader::Shader(const redox::Buffer<i8>& buffer) {
+redox::graphics::Shader::Shader(Span<const byte> code) {
 
 	VkShaderModuleCreateInfo createInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-	createInfo.codeSize = buffer.size();
-	createInfo.pCode = reinterpret_cast<const uint32_t*>(buffer.data());
+	createInfo.codeSize = code.size();
+	createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
 
 	if (vkCreateShaderModule(Graphics::instance().device(), &createInfo, nullptr, &_handle) != VK_SUCCESS)
 		throw Exception("failed to create shader module");
@@ -34,7 +34,7 @@ namespace redox::graphics {
 	class Shader : public IResource
 	{
 	public:
-		Shader(const redox::Buffer<i8>& buffer);
+		Shader(Span<const byte> code);
 		~Shader() override;
 
 		VkShaderModule handle() const;
@@ -28,26 +28,193 @@ SOFTWARE.
 #include <platform/filesystem.h>
 #include <platform/process.h>
 
+#include <algorithm> //std::find
+#include <atomic> //std::atomic
+#include <fstream> //std::ifstream, std::ofstream
+#include <iterator> //std::istreambuf_iterator
+#include <thread> //std::this_thread
+
+#ifdef RDX_WITH_SHADERC
+#pragma warning(push, 0)
+#include <shaderc/shaderc.hpp>
+#pragma warning(pop)
+#pragma comment(lib, "shaderc_combined.lib")
+#endif
+
+namespace {
+#ifdef RDX_WITH_SHADERC
+	void write_file(const redox::Path& file, redox::Span<const redox::byte> data) {
+		std::ofstream stream(file, std::ios::binary | std::ios::trunc);
+		stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+		if (!stream)
+			throw redox::Exception("failed to write shader binary");
+	}
+
+	shaderc_shader_kind to_shader_kind(const redox::Path& ext) {
+		if (ext == ".vert") return shaderc_vertex_shader;
+		if (ext == ".frag") return shaderc_fragment_shader;
+		if (ext == ".geom") return shaderc_geometry_shader;
+		if (ext == ".comp") return shaderc_compute_shader;
+		throw redox::Exception("unknown shader stage");
+	}
+
+	//resolves #include "file" against the including file and #include <file> against the shader root
+	class includer : public shaderc::CompileOptions::IncluderInterface {
+	public:
+		explicit includer(redox::Path root) : _root(std::move(root)) {}
+
+		shaderc_include_result* GetInclude(const char* requested, shaderc_include_type type,
+			const char* requesting, std::size_t) override {
+
+			auto result = new include_result();
+			auto file = type == shaderc_include_type_relative ?
+				redox::Path(requesting).parent_path() / requested : _root / requested;
+
+			std::ifstream stream(file, std::ios::binary);
+			if (stream) {
+				result->path = file.string();
+				result->text.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+			}
+			else {
+				//an empty name reports the content as the error
+				result->text = "cannot open " + file.string();
+			}
+
+			result->source_name = result->path.c_str();
+			result->source_name_length = result->path.size();
+			result->content = result->text.c_str();
+			result->content_length = result->text.size();
+			result->user_data = nullptr;
+			return result;
+		}
+
+		void ReleaseInclude(shaderc_include_result* data) override {
+			delete static_cast<include_result*>(data);
+		}
+
+	private:
+		struct include_result : shaderc_include_result {
+			redox::String path;
+			redox::String text;
+		};
+
+		redox::Path _root;
+	};
+#endif
+}
+
+redox::Buffer<redox::byte> redox::graphics::ShaderCompiler::compile(const Path& source) {
+#ifdef RDX_WITH_SHADERC
+	std::ifstream stream(source, std::ios::binary);
+	if (!stream)
+		throw Exception("failed to open shader source");
+	String glsl(std::istreambuf_iterator<char>(stream), {});
+
+	shaderc::CompileOptions options;
+	options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_0);
+	options.SetOptimizationLevel(shaderc_optimization_level_performance);
+	options.SetIncluder(make_unique<includer>(source.parent_path()));
+
+	//a compiler may be shared by any number of threads
+	static const shaderc::Compiler compiler;
+	auto name = source.string();
+	auto result = compiler.CompileGlslToSpv(glsl, to_shader_kind(source.extension()), name.c_str(), options);
+
+	if (result.GetCompilationStatus() != shaderc_compilation_status_success) {
+		RDX_LOG("Failed to compile shader {0}\n {1}", ConsoleColor::RED, name, result.GetErrorMessage());
+		throw Exception("failed to compile shader.");
+	}
+
+	auto begin = reinterpret_cast<const byte*>(result.cbegin());
+	return redox::Buffer<byte>(begin, reinterpret_cast<const byte*>(result.cend()));
+#else
+	//glslangValidator only writes files, the output goes through a private temporary
+	static std::atomic<u64> counter = 0;
+	auto output = io::temp_directory_path() / redox::format("redox_{0}_{1}.spv",
+		static_cast<i64>(std::hash<std::thread::id>{}(std::this_thread::get_id()) & 0xffffff), static_cast<i64>(counter++));
+	RDX_SCOPE_GUARD([&output]() {
+		std::error_code ec;
+		io::remove(output, ec);
+	});
+
+	compile_to(source, output);
+	io::MappedFile file(output);
+	return redox::Buffer<byte>(file.data().begin(), file.data().end());
+#endif
+}
+
 redox::Path redox::graphics::ShaderCompiler::compile(const Path& source, const Path& outputFolder, bool overwrite) {
 	std::hash<Path> hash;
 	auto cacheFile = outputFolder / (redox::lexical_cast(hash(source)) + ".spv");
 
 	if (!io::exists(cacheFile) || overwrite) {
-		RDX_LOG("Compiling shader...");
+		compile_to(source, cacheFile);
+	}
 
-		auto args = redox::format("glslangValidator -o {0} -V {1}", cacheFile, source);
-		RDX_DEBUG_LOG("{0}", args);
+	return cacheFile;
+}
 
-		platform::Process p(args);
-		auto result = p.join();
+void redox::graphics::ShaderCompiler::compile_to(const Path& source, const Path& output) {
+#ifdef RDX_WITH_SHADERC
+	auto binary = compile(source);
+	write_file(output, binary);
+#else
+	RDX_LOG("Compiling shader...");
 
-		if (result.errorCode != 0) {
-			RDX_LOG("Failed to compile shader [Exit Code: {0}] \n {1}", ConsoleColor::RED,
-				result.errorCode, result.stdOut);
-			throw Exception("failed to invoke glslangValidator.");
-		}
+	auto args = redox::format("glslangValidator -o {0} -V {1}", output, source);
+	RDX_DEBUG_LOG("{0}", args);
+
+	platform::Process p(args);
+	auto result = p.join();
 
+	if (result.errorCode != 0) {
+		RDX_LOG("Failed to compile shader [Exit Code: {0}] \n {1}", ConsoleColor::RED,
+			result.errorCode, result.stdOut);
+		throw Exception("failed to invoke glslangValidator.");
 	}
+#endif
+}
 
-	return cacheFile;
+redox::Buffer<redox::Path> redox::graphics::ShaderCompiler::includes(const Path& source) {
+	redox::Buffer<Path> files;
+	redox::Buffer<Path> pending{ source };
+	while (!pending.empty()) {
+		auto file = std::move(pending.back());
+		pending.pop_back();
+
+		std::ifstream stream(file);
+		String line;
+		while (std::getline(stream, line)) {
+			auto begin = line.find_first_not_of(" \t");
+			if (begin == String::npos || line.compare(begin, 8, "#include") != 0)
+				continue;
+
+			auto open = line.find_first_of("\"<", begin + 8);
+			if (open == String::npos)
+				continue;
+			const bool relative = line[open] == '"';
+			auto close = line.find(relative ? '"' : '>', open + 1);
+			if (close == String::npos)
+				continue;
+
+			//"file" against the including file, <file> against the shader root
+			auto included = ((relative ? file.parent_path() : source.parent_path()) /
+				line.substr(open + 1, close - open - 1)).lexically_normal();
+			if (io::is_regular_file(included) && std::find(files.begin(), files.end(), included) == files.end()) {
+				files.push_back(included);
+				pending.push_back(std::move(included));
+			}
+		}
+	}
+	return files;
+}
+
+redox::Buffer<redox::Buffer<redox::byte>> redox::graphics::ShaderCompiler::compile_all(
+	Span<const Path> sources, concurrency::WorkerPool& workers) {
+
+	redox::Buffer<redox::Buffer<byte>> binaries(sources.size());
+	workers.parallel_for(sources.size(), [&sources, &binaries](std::size_t i) {
+		binaries[i] = compile(sources[i]);
+	});
+	return binaries;
 }
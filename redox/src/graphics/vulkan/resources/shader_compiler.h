@@ -26,10 +26,32 @@ SOFTWARE.
 #pragma once
 #include <core/core.h>
 #include <core/non_copyable.h>
+#include <core/concurrency/worker_pool.h>
 
 namespace redox::graphics {
+	//GLSL to SPIR-V, the stage is taken from the extension and #include resolves relative
+	//to the including file. built with RDX_WITH_SHADERC (the Release configurations) the
+	//compiler runs in process through shaderc from the Vulkan SDK and optimizes with
+	//spirv-opt. the SDK ships no debug shaderc libraries, so Debug spawns glslangValidator.
 	class ShaderCompiler : public NonCopyable {
 	public:
+		//identifies the compiler in derived data keys, bump it when the invocation changes
+#ifdef RDX_WITH_SHADERC
+		static constexpr StringView Tool = "shaderc -O/1";
+#else
+		static constexpr StringView Tool = "glslangValidator -V/1";
+#endif
+
+		static redox::Buffer<byte> compile(const Path& source);
 		static Path compile(const Path& source, const Path& outputFolder, bool overwrite = false);
+		static void compile_to(const Path& source, const Path& output);
+
+		//files source includes directly or through other includes, resolved like the compiler
+		//does. includes that cannot be opened are left for the compiler to report.
+		static redox::Buffer<Path> includes(const Path& source);
+
+		//compiles the sources concurrently, results are in the order of sources.
+		//the first failure is rethrown once every compile finished.
+		static redox::Buffer<redox::Buffer<byte>> compile_all(Span<const Path> sources, concurrency::WorkerPool& workers);
 	};
-}
\ No newline at end of file
+}
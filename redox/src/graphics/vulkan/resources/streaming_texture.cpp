@@ -0,0 +1,337 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "streaming_texture.h"
+#include "graphics\vulkan\graphics.h"
+#include "resources\resource_manager.h"
+
+#include <algorithm> //std::sort, std::find_if
+#include <cmath> //std::log2
+
+redox::graphics::StreamingTexture::StreamingTexture(UniquePtr<IResourcePayload> source, Span<const byte> cooked, VkFormat format) :
+	StreamingTexture(std::move(source), CookedTexture(cooked), format) {
+}
+
+redox::graphics::StreamingTexture::StreamingTexture(UniquePtr<IResourcePayload> source, CookedTexture cooked, VkFormat format) :
+	SampleTexture(_levels(cooked, _tail_level(cooked)), format, _extent(cooked, _tail_level(cooked))),
+	_source(std::move(source)),
+	_cooked(std::move(cooked)),
+	_tailLevel(_tail_level(_cooked)),
+	_residentLevel(_tailLevel) {
+}
+
+void redox::graphics::StreamingTexture::upload() {
+	//streamed images are complete once swapped in, only the tail goes through the staging buffer
+	if (_residentLevel == _tailLevel)
+		StagedTexture::upload();
+}
+
+redox::ResourceSize redox::graphics::StreamingTexture::size() const {
+	auto size = StagedTexture::size();
+	size.cpu += _cooked.blob().size();
+	return size;
+}
+
+void redox::graphics::StreamingTexture::request_detail(f32 screenSize) {
+	//one texel per pixel, every halving of the size on screen drops a level
+	const auto size = static_cast<f32>(std::max(_cooked.width(), _cooked.height()));
+	u32 level = _tailLevel;
+	if (screenSize >= size)
+		level = 0;
+	else if (screenSize > 0.0f)
+		level = std::min(_tailLevel, static_cast<u32>(std::log2(size / screenSize)));
+
+	_requestedLevel = std::min(_requestedLevel, level);
+}
+
+redox::u32 redox::graphics::StreamingTexture::level_count() const {
+	return _cooked.level_count();
+}
+
+redox::u32 redox::graphics::StreamingTexture::tail_level() const {
+	return _tailLevel;
+}
+
+redox::u32 redox::graphics::StreamingTexture::resident_level() const {
+	return _residentLevel;
+}
+
+bool redox::graphics::StreamingTexture::is_streamable(const CookedTexture& texture) {
+	return _tail_level(texture) > 0;
+}
+
+redox::u32 redox::graphics::StreamingTexture::_tail_level(const CookedTexture& texture) {
+	for (u32 i = 0; i < texture.level_count(); i++) {
+		const auto level = texture.level(i);
+		if (std::max(level.width, level.height) <= TailSize)
+			return i;
+	}
+	//truncated chain, the smallest level there is stays resident
+	return texture.level_count() - 1;
+}
+
+redox::Buffer<redox::Span<const redox::byte>> redox::graphics::StreamingTexture::_levels(const CookedTexture& texture, u32 first) {
+	redox::Buffer<Span<const byte>> levels;
+	for (u32 i = first; i < texture.level_count(); i++)
+		levels.push_back(texture.level(i).data);
+	return levels;
+}
+
+VkExtent2D redox::graphics::StreamingTexture::_extent(const CookedTexture& texture, u32 level) {
+	const auto data = texture.level(level);
+	return { data.width, data.height };
+}
+
+redox::u32 redox::graphics::StreamingTexture::_take_request() {
+	return std::exchange(_requestedLevel, NoRequest);
+}
+
+VkDeviceSize redox::graphics::StreamingTexture::_image_size(u32 level) const {
+	VkDeviceSize size = 0;
+	for (u32 i = level; i < _cooked.level_count(); i++)
+		size += _cooked.level(i).data.size();
+	return size;
+}
+
+redox::UniquePtr<redox::graphics::Texture> redox::graphics::StreamingTexture::_create_image(u32 level) const {
+	return make_unique<Texture>(_format, _extent(_cooked, level),
+		VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VK_IMAGE_ASPECT_COLOR_BIT,
+		_cooked.level_count() - level);
+}
+
+redox::UniquePtr<redox::graphics::Buffer> redox::graphics::StreamingTexture::_stage(u32 level,
+	redox::Buffer<VkBufferImageCopy>& regions) const {
+
+	const auto levels = _levels(_cooked, level);
+	auto staging = make_unique<Buffer>(_staging_size(levels), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+	_stage_levels(*staging, levels, _extent(_cooked, level), regions);
+	return staging;
+}
+
+void redox::graphics::StreamingTexture::_exchange(Texture& image, u32 level) {
+	_swap_image(image);
+	_residentLevel = level;
+}
+
+redox::graphics::TextureStreamer::TextureStreamer(VkDeviceSize budget) :
+	_budget(budget) {
+
+	_commandPool.allocate(MaxUploads);
+
+	VkFenceCreateInfo fenceInfo{};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	for (u32 i = 0; i < MaxUploads; i++) {
+		if (vkCreateFence(Graphics::instance().device(), &fenceInfo, nullptr, &_fences[i]) != VK_SUCCESS)
+			throw Exception("failed to create upload fence");
+		_freeSlots.push_back(i);
+	}
+}
+
+redox::graphics::TextureStreamer::~TextureStreamer() {
+	Graphics::instance().wait_pending();
+	_uploads.clear();
+	_retired.clear();
+
+	for (auto fence : _fences)
+		vkDestroyFence(Graphics::instance().device(), fence, nullptr);
+}
+
+void redox::graphics::TextureStreamer::add(const ResourceHandle<StreamingTexture>& texture) {
+	std::lock_guard<std::mutex> lock(_addMutex);
+	_added.push_back(texture);
+}
+
+void redox::graphics::TextureStreamer::update() {
+	_updates++;
+	_finish_uploads();
+
+	{
+		std::lock_guard<std::mutex> lock(_addMutex);
+		for (const auto& added : _added) {
+			if (auto texture = added.lock()) {
+				_entries.push_back({ added, texture->memory_size(),
+					texture->resident_level(), texture->tail_level(), _updates, false, 0 });
+				_residentSize += texture->memory_size();
+			}
+		}
+		_added.clear();
+	}
+
+	_collect_requests();
+	_schedule();
+}
+
+VkDeviceSize redox::graphics::TextureStreamer::budget() const {
+	return _budget;
+}
+
+VkDeviceSize redox::graphics::TextureStreamer::resident_size() const {
+	return _residentSize;
+}
+
+void redox::graphics::TextureStreamer::_finish_uploads() {
+	for (auto it = _uploads.begin(); it != _uploads.end();) {
+		if (vkGetFenceStatus(Graphics::instance().device(), _fences[it->slot]) != VK_SUCCESS) {
+			++it;
+			continue;
+		}
+
+		auto texture = it->texture.lock();
+		if (auto e = texture ? _find(texture.get()) : nullptr) {
+			texture->_exchange(*it->image, it->level);
+			ResourceManager::instance()->resized(texture.get());
+			e->size = texture->memory_size();
+			e->residentLevel = it->level;
+			e->uploading = false;
+		}
+
+		//either the previous image or one nobody is waiting for anymore,
+		//it stays charged until it is released
+		_retired.emplace_back(_updates, std::move(it->image));
+
+		vkResetFences(Graphics::instance().device(), 1, &_fences[it->slot]);
+		_freeSlots.push_back(it->slot);
+		it = _uploads.erase(it);
+	}
+
+	streaming::retire(_retired, _updates, RetireDelay, [this](const UniquePtr<Texture>& image) {
+		_residentSize -= image->memory_size();
+	});
+}
+
+void redox::graphics::TextureStreamer::_collect_requests() {
+	for (auto it = _entries.begin(); it != _entries.end();) {
+		auto texture = it->texture.lock();
+		if (!texture) {
+			_residentSize -= it->size;
+			it = _entries.erase(it);
+			continue;
+		}
+
+		if (auto level = texture->_take_request(); level != StreamingTexture::NoRequest) {
+			it->wantedLevel = level;
+			it->lastRequest = _updates;
+		}
+		else if (_updates - it->lastRequest > RetainUpdates) {
+			it->wantedLevel = texture->tail_level();
+		}
+		++it;
+	}
+}
+
+void redox::graphics::TextureStreamer::_schedule() {
+	redox::Buffer<entry*> candidates;
+	for (auto& e : _entries) {
+		if (!e.uploading && e.wantedLevel != e.residentLevel)
+			candidates.push_back(&e);
+	}
+
+	//drops free memory for upgrades so they go first, upgrades by how many levels are missing
+	std::sort(candidates.begin(), candidates.end(), [](const entry* a, const entry* b) {
+		const bool dropA = a->wantedLevel > a->residentLevel;
+		const bool dropB = b->wantedLevel > b->residentLevel;
+		if (dropA != dropB)
+			return dropA;
+		return static_cast<i32>(a->residentLevel - a->wantedLevel) >
+			static_cast<i32>(b->residentLevel - b->wantedLevel);
+	});
+
+	for (auto e : candidates) {
+		if (_freeSlots.empty())
+			break;
+
+		auto texture = e->texture.lock();
+		if (!texture)
+			continue;
+
+		try {
+			//drops give their memory back once the previous image is released, upgrades
+			//settle for fewer levels when the wanted ones do not fit
+			const auto padding = e->padding;
+			const auto level = streaming::select_level(e->wantedLevel, e->residentLevel, _residentSize, _budget,
+				[&texture, padding](u32 l) { return texture->_image_size(l) + padding; });
+			if (level == e->residentLevel)
+				continue;
+
+			//the blob only bounds the allocation from below, the image is measured before it
+			//is charged. one that does not fit teaches the estimate for the next update
+			auto image = texture->_create_image(level);
+			const auto bytes = texture->_image_size(level);
+			e->padding = image->memory_size() > bytes ? image->memory_size() - bytes : 0;
+			if (level < e->residentLevel && _residentSize + image->memory_size() > _budget)
+				continue;
+
+			_start(*e, *texture, level, std::move(image));
+		}
+		catch (const Exception& ex) {
+			RDX_LOG("failed to stream texture: {0}", ConsoleColor::RED, ex.what());
+			e->wantedLevel = e->residentLevel;
+		}
+	}
+}
+
+void redox::graphics::TextureStreamer::_start(entry& e, StreamingTexture& texture, u32 level, UniquePtr<Texture> image) {
+	upload job;
+	job.texture = e.texture;
+	job.level = level;
+	job.slot = _freeSlots.back();
+
+	redox::Buffer<VkBufferImageCopy> regions;
+	job.image = std::move(image);
+	job.staging = texture._stage(level, regions);
+
+	auto commandBuffer = _commandPool[job.slot];
+	{
+		RDX_UNUSED(commandBuffer.scoped_record());
+		job.image->record_transfer_layout(commandBuffer, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+		vkCmdCopyBufferToImage(commandBuffer.handle(), job.staging->handle(), job.image->handle(),
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
+		job.image->record_transfer_layout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	}
+
+	//the device only exposes the graphics queue, the fence lets rendering go on meanwhile
+	const auto handle = commandBuffer.handle();
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &handle;
+
+	if (vkQueueSubmit(Graphics::instance().graphics_queue(), 1, &submitInfo, _fences[job.slot]) != VK_SUCCESS)
+		throw Exception("failed to submit texture upload");
+
+	_freeSlots.pop_back();
+	_residentSize += job.image->memory_size();
+	e.uploading = true;
+	_uploads.push_back(std::move(job));
+}
+
+redox::graphics::TextureStreamer::entry* redox::graphics::TextureStreamer::_find(const StreamingTexture* texture) {
+	auto it = std::find_if(_entries.begin(), _entries.end(), [texture](const entry& e) {
+		return e.texture.lock().get() == texture;
+	});
+	return it != _entries.end() ? &*it : nullptr;
+}
@@ -0,0 +1,186 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include "core\non_copyable.h"
+#include "texture.h"
+#include "graphics\vulkan\command_pool.h"
+#include "resources\importer\texture_cooker.h"
+
+#include <mutex> //std::mutex, std::lock_guard
+#include <limits> //std::numeric_limits
+
+namespace redox::graphics {
+
+	//decisions of the TextureStreamer, kept free of device objects
+	namespace streaming {
+		//drops are taken as wanted. upgrades settle for the finest level from wanted on whose
+		//image fits next to the used bytes, resident if none does. size estimates the image
+		//starting at a level
+		template<class SizeFn>
+		u32 select_level(u32 wanted, u32 resident, VkDeviceSize used, VkDeviceSize budget, SizeFn&& size) {
+			if (wanted >= resident)
+				return wanted;
+
+			for (auto level = wanted; level < resident; level++) {
+				if (used + size(level) <= budget)
+					return level;
+			}
+			return resident;
+		}
+
+		//erases the items retired delay or more updates before now, release sees each first
+		template<class T, class ReleaseFn>
+		void retire(redox::Buffer<std::pair<u64, T>>& retired, u64 now, u64 delay, ReleaseFn&& release) {
+			for (auto it = retired.begin(); it != retired.end();) {
+				if (it->first + delay > now) {
+					++it;
+					continue;
+				}
+
+				release(it->second);
+				it = retired.erase(it);
+			}
+		}
+	}
+
+	//sample texture whose upper mip levels are loaded on demand. it starts with the
+	//mip tail, the draw path reports how large it appears on screen and the
+	//TextureStreamer swaps in an image with more (or fewer) levels from the cooked blob.
+	class StreamingTexture : public SampleTexture {
+	public:
+		//levels up to this size along the larger axis are always resident
+		static constexpr u32 TailSize = 64;
+
+		//source owns the bytes cooked points into and is kept for later uploads
+		StreamingTexture(UniquePtr<IResourcePayload> source, Span<const byte> cooked, VkFormat format);
+		~StreamingTexture() override = default;
+
+		void upload() override;
+		//the cooked blob stays with the texture for later uploads
+		ResourceSize size() const override;
+		void request_detail(f32 screenSize) override;
+
+		//finest level the streamer may upload and the coarsest it may drop to
+		u32 level_count() const;
+		u32 tail_level() const;
+		//index into the full chain of the level the image starts with
+		u32 resident_level() const;
+
+		//whether a cooked texture has levels above its tail worth streaming
+		static bool is_streamable(const CookedTexture& texture);
+
+	private:
+		friend class TextureStreamer;
+		static constexpr u32 NoRequest = std::numeric_limits<u32>::max();
+
+		StreamingTexture(UniquePtr<IResourcePayload> source, CookedTexture cooked, VkFormat format);
+
+		static u32 _tail_level(const CookedTexture& texture);
+		static redox::Buffer<Span<const byte>> _levels(const CookedTexture& texture, u32 first);
+		static VkExtent2D _extent(const CookedTexture& texture, u32 level);
+
+		//finest level requested since the last call, NoRequest if none
+		u32 _take_request();
+		//bytes of the levels from level on in the blob, a lower bound for the image allocation
+		VkDeviceSize _image_size(u32 level) const;
+		UniquePtr<Texture> _create_image(u32 level) const;
+		UniquePtr<Buffer> _stage(u32 level, redox::Buffer<VkBufferImageCopy>& regions) const;
+		//takes over image, which then holds the previous one
+		void _exchange(Texture& image, u32 level);
+
+		UniquePtr<IResourcePayload> _source;
+		CookedTexture _cooked;
+		u32 _tailLevel;
+		u32 _residentLevel;
+		u32 _requestedLevel = NoRequest;
+	};
+
+	//keeps streaming textures within a fixed device memory budget. uploads are recorded
+	//into command buffers of its own and polled by fence, finished ones replace the image
+	//of their texture at the next update. materials rebind the new image when they record.
+	class TextureStreamer : public NonCopyable {
+	public:
+		//uploads in flight at once, each owns a command buffer and a fence
+		static constexpr u32 MaxUploads = 4;
+		//updates a texture keeps its detail after it was last requested
+		static constexpr u64 RetainUpdates = 120;
+		//replaced images may still be sampled by frames in flight, they are
+		//released RetireDelay updates later
+		static constexpr u64 RetireDelay = 3;
+
+		explicit TextureStreamer(VkDeviceSize budget);
+		~TextureStreamer();
+
+		//may be called from any thread, the texture is picked up by the next update
+		void add(const ResourceHandle<StreamingTexture>& texture);
+		//once per frame before recording, consumes the requests of the previous frame
+		void update();
+
+		VkDeviceSize budget() const;
+		//bytes held by streaming textures including uploads in flight and retired images
+		VkDeviceSize resident_size() const;
+
+	private:
+		struct entry {
+			WeakResourceHandle<StreamingTexture> texture;
+			VkDeviceSize size;
+			u32 residentLevel;
+			u32 wantedLevel;
+			u64 lastRequest;
+			bool uploading;
+			//allocation beyond the blob bytes seen for the last image, refines the estimate
+			VkDeviceSize padding;
+		};
+
+		struct upload {
+			WeakResourceHandle<StreamingTexture> texture;
+			u32 level;
+			u32 slot;
+			UniquePtr<Texture> image;
+			UniquePtr<Buffer> staging;
+		};
+
+		void _finish_uploads();
+		void _collect_requests();
+		void _schedule();
+		void _start(entry& e, StreamingTexture& texture, u32 level, UniquePtr<Texture> image);
+		entry* _find(const StreamingTexture* texture);
+
+		CommandPool _commandPool;
+		Array<VkFence, MaxUploads> _fences;
+		redox::Buffer<u32> _freeSlots;
+
+		redox::Buffer<entry> _entries;
+		redox::Buffer<upload> _uploads;
+		redox::Buffer<std::pair<u64, UniquePtr<Texture>>> _retired;
+		std::mutex _addMutex;
+		redox::Buffer<WeakResourceHandle<StreamingTexture>> _added;
+
+		VkDeviceSize _budget;
+		VkDeviceSize _residentSize = 0;
+		u64 _updates = 0;
+	};
+}
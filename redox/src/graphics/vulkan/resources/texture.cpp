@@ -29,11 +29,12 @@ SOFTWARE.
 #include "graphics\vulkan\command_pool.h"
 
 redox::graphics::Texture::Texture(VkFormat format, const VkExtent2D& size,
-	VkImageUsageFlags usage, VkImageAspectFlags viewAspectFlags) :
+	VkImageUsageFlags usage, VkImageAspectFlags viewAspectFlags, u32 mipLevels) :
 	_format(format),
 	_dimensions(size),
 	_usageFlags(usage),
-	_viewAspectFlags(viewAspectFlags) {
+	_viewAspectFlags(viewAspectFlags),
+	_mipLevels(mipLevels) {
 
 	_init();
 	_init_view();
@@ -69,6 +70,29 @@ const redox::graphics::Sampler& redox::graphics::Texture::sampler() const {
 	return _sampler;
 }
 
+redox::u32 redox::graphics::Texture::mip_levels() const {
+	return _mipLevels;
+}
+
+VkDeviceSize redox::graphics::Texture::memory_size() const {
+	return _memorySize;
+}
+
+redox::u32 redox::graphics::Texture::generation() const {
+	return _generation;
+}
+
+void redox::graphics::Texture::_swap_image(Texture& other) {
+	std::swap(_handle, other._handle);
+	std::swap(_view, other._view);
+	std::swap(_memory, other._memory);
+	std::swap(_memorySize, other._memorySize);
+	std::swap(_dimensions, other._dimensions);
+	std::swap(_mipLevels, other._mipLevels);
+	_generation++;
+	other._generation++;
+}
+
 void redox::graphics::Texture::_init() {
 
 	VkImageCreateInfo imageInfo{};
@@ -77,7 +101,7 @@ void redox::graphics::Texture::_init() {
 	imageInfo.extent.width = _dimensions.width;
 	imageInfo.extent.height = _dimensions.height;
 	imageInfo.extent.depth = 1;
-	imageInfo.mipLevels = 1;
+	imageInfo.mipLevels = _mipLevels;
 	imageInfo.arrayLayers = 1;
 	imageInfo.format = _format;
 	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
@@ -95,6 +119,7 @@ void redox::graphics::Texture::_init() {
 	VkMemoryAllocateInfo allocInfo{};
 	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
 	allocInfo.allocationSize = memRequirements.size;
+	_memorySize = memRequirements.size;
 	auto memType = Graphics::instance().pick_memory_type(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 	if (!memType)
 		throw Exception("could not find suitable memory type");
@@ -114,7 +139,7 @@ void redox::graphics::Texture::_init_view() {
 	viewInfo.format = _format;
 	viewInfo.subresourceRange.aspectMask = _viewAspectFlags; //VK_IMAGE_ASPECT_COLOR_BIT;
 	viewInfo.subresourceRange.baseMipLevel = 0;
-	viewInfo.subresourceRange.levelCount = 1;
+	viewInfo.subresourceRange.levelCount = _mipLevels;
 	viewInfo.subresourceRange.baseArrayLayer = 0;
 	viewInfo.subresourceRange.layerCount = 1;
 
@@ -123,6 +148,13 @@ void redox::graphics::Texture::_init_view() {
 }
 
 void redox::graphics::Texture::_transfer_layout(VkImageLayout oldLayout, VkImageLayout newLayout) const {
+	AuxCommandPool::instance().submit([&](CommandBufferView cbo) {
+		record_transfer_layout(cbo, oldLayout, newLayout);
+	});
+}
+
+void redox::graphics::Texture::record_transfer_layout(const CommandBufferView& commandBuffer,
+	VkImageLayout oldLayout, VkImageLayout newLayout) const {
 	
 	VkImageMemoryBarrier barrier{};
 	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -132,7 +164,7 @@ void redox::graphics::Texture::_transfer_layout(VkImageLayout oldLayout, VkImage
 	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 	barrier.image = _handle;
 	barrier.subresourceRange.baseMipLevel = 0;
-	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.levelCount = _mipLevels;
 	barrier.subresourceRange.baseArrayLayer = 0;
 	barrier.subresourceRange.layerCount = 1;
 
@@ -167,10 +199,8 @@ void redox::graphics::Texture::_transfer_layout(VkImageLayout oldLayout, VkImage
 	}
 	else throw Exception("unsupported layout transition");
 
-	AuxCommandPool::instance().submit([&](CommandBufferView cbo) {
-		vkCmdPipelineBarrier(cbo.handle(), sourceStage, destinationStage,
-			0, 0, nullptr, 0, nullptr, 1, &barrier);
-	});
+	vkCmdPipelineBarrier(commandBuffer.handle(), sourceStage, destinationStage,
+		0, 0, nullptr, 0, nullptr, 1, &barrier);
 }
 
 redox::graphics::StagedTexture::StagedTexture(const redox::Buffer<byte>& pixels, VkFormat format, const VkExtent2D& size,
@@ -181,6 +211,50 @@ redox::graphics::StagedTexture::StagedTexture(const redox::Buffer<byte>& pixels,
 	_stagingBuffer.map([&pixels](void* data) {
 		std::memcpy(data, pixels.data(), pixels.size());
 	});
+
+	VkBufferImageCopy region{};
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.layerCount = 1;
+	region.imageExtent = { size.width, size.height, 1 };
+	_regions.push_back(region);
+}
+
+redox::graphics::StagedTexture::StagedTexture(const redox::Buffer<Span<const byte>>& levels, VkFormat format, const VkExtent2D& size,
+	VkImageUsageFlags usage, VkImageAspectFlags viewAspectFlags) :
+	Texture(format, size, usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT, viewAspectFlags, static_cast<u32>(levels.size())),
+	_stagingBuffer(_staging_size(levels), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) {
+
+	_stage_levels(_stagingBuffer, levels, size, _regions);
+}
+
+void redox::graphics::StagedTexture::_stage_levels(Buffer& staging, const redox::Buffer<Span<const byte>>& levels,
+	const VkExtent2D& size, redox::Buffer<VkBufferImageCopy>& regions) {
+
+	VkDeviceSize offset = 0;
+	for (u32 i = 0; i < levels.size(); i++) {
+		VkBufferImageCopy region{};
+		region.bufferOffset = offset;
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = i;
+		region.imageSubresource.layerCount = 1;
+		region.imageExtent = { std::max(1u, size.width >> i), std::max(1u, size.height >> i), 1 };
+		regions.push_back(region);
+
+		offset = (offset + levels[i].size() + 15) & ~VkDeviceSize(15);
+	}
+
+	staging.map([&regions, &levels](void* data) {
+		for (std::size_t i = 0; i < levels.size(); i++)
+			std::memcpy(static_cast<byte*>(data) + regions[i].bufferOffset, levels[i].data(), levels[i].size());
+	});
+}
+
+VkDeviceSize redox::graphics::StagedTexture::_staging_size(const redox::Buffer<Span<const byte>>& levels) {
+	//offsets must be multiples of the texel block size, 16 covers every format we upload
+	VkDeviceSize size = 0;
+	for (const auto& level : levels)
+		size = (size + level.size() + 15) & ~VkDeviceSize(15);
+	return size;
 }
 
 void redox::graphics::StagedTexture::map(FunctionRef<void(void*)> fn) {
@@ -189,7 +263,7 @@ void redox::graphics::StagedTexture::map(FunctionRef<void(void*)> fn) {
 
 void redox::graphics::StagedTexture::upload() {
 	_transfer_layout(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-	_stagingBuffer.copy_to(*this);
+	_stagingBuffer.copy_to(*this, _regions);
 	_transfer_layout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 }
 
@@ -197,10 +271,18 @@ redox::ResourceGroup redox::graphics::StagedTexture::res_group() const {
 	return ResourceGroup::GRAPHICS;
 }
 
+redox::ResourceSize redox::graphics::StagedTexture::size() const {
+	return { _stagingBuffer.size(), _memorySize };
+}
+
 redox::graphics::SampleTexture::SampleTexture(const redox::Buffer<byte>& pixels, VkFormat format, const VkExtent2D& size) :
 	StagedTexture(pixels, format, size, VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT) {
 }
 
+redox::graphics::SampleTexture::SampleTexture(const redox::Buffer<Span<const byte>>& levels, VkFormat format, const VkExtent2D& size) :
+	StagedTexture(levels, format, size, VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT) {
+}
+
 void redox::graphics::ResizableTexture::resize(const VkExtent2D& extent) {
 	if (extent == _dimensions)
 		return;
@@ -33,10 +33,12 @@ SOFTWARE.
 #include "resources/resource.h"
 
 namespace redox::graphics {
+	class CommandBufferView;
+
 	class Texture : public NonCopyable {
 	public:
 		Texture(VkFormat format, const VkExtent2D& size, 
-			VkImageUsageFlags usage, VkImageAspectFlags viewAspectFlags);
+			VkImageUsageFlags usage, VkImageAspectFlags viewAspectFlags, u32 mipLevels = 1);
 		~Texture();
 
 		VkImage handle() const;
@@ -45,12 +47,22 @@ namespace redox::graphics {
 		const VkExtent2D& dimension() const;
 		const VkFormat& format() const;
 		const Sampler& sampler() const;
+		u32 mip_levels() const;
+		VkDeviceSize memory_size() const;
+		//changes whenever the image is replaced, views held elsewhere are stale then
+		u32 generation() const;
+
+		//records the barrier for every mip level, _transfer_layout submits it right away
+		void record_transfer_layout(const CommandBufferView& commandBuffer,
+			VkImageLayout oldLayout, VkImageLayout newLayout) const;
 	
 	protected:
 		void _destroy();
 		void _init();
 		void _init_view();
 		void _transfer_layout(VkImageLayout oldLayout, VkImageLayout newLayout) const;
+		//exchanges the images of two textures of the same format
+		void _swap_image(Texture& other);
 
 		Sampler _sampler;
 		VkImage _handle;
@@ -59,8 +71,11 @@ namespace redox::graphics {
 		VkImageAspectFlags _viewAspectFlags;
 		VkImageUsageFlags _usageFlags;
 		VkDeviceMemory _memory;
+		VkDeviceSize _memorySize;
 		VkFormat _format;
 		VkExtent2D _dimensions;
+		u32 _mipLevels;
+		u32 _generation = 0;
 	};
 
 	class ResizableTexture : public Texture {
@@ -79,20 +94,36 @@ namespace redox::graphics {
 	public:
 		StagedTexture(const redox::Buffer<byte>& pixels, VkFormat format,
 			const VkExtent2D& size, VkImageUsageFlags usage, VkImageAspectFlags viewAspectFlags);
+		//levels are the mip chain largest first, already in the layout of format.
+		//all of them share one staging buffer and are copied in one go.
+		StagedTexture(const redox::Buffer<Span<const byte>>& levels, VkFormat format,
+			const VkExtent2D& size, VkImageUsageFlags usage, VkImageAspectFlags viewAspectFlags);
 
 		void map(FunctionRef<void(void*)> fn);
 
 		~StagedTexture() override = default;
 		void upload() override;
 		ResourceGroup res_group() const override;
+		ResourceSize size() const override;
 
 	protected:
+		static VkDeviceSize _staging_size(const redox::Buffer<Span<const byte>>& levels);
+		//copies levels into staging and describes one region per level, size is the first level's
+		static void _stage_levels(Buffer& staging, const redox::Buffer<Span<const byte>>& levels,
+			const VkExtent2D& size, redox::Buffer<VkBufferImageCopy>& regions);
+
 		Buffer _stagingBuffer;
+		redox::Buffer<VkBufferImageCopy> _regions;
 	};
 
 	class SampleTexture : public StagedTexture {
 	public:
 		SampleTexture(const redox::Buffer<byte>& pixels, VkFormat format, const VkExtent2D& size);
+		SampleTexture(const redox::Buffer<Span<const byte>>& levels, VkFormat format, const VkExtent2D& size);
+
+		//feedback from the draw path, screenSize is the extent in pixels the texture
+		//covers on screen. only streaming textures act on it.
+		virtual void request_detail(f32 /*screenSize*/) {}
 	};
 
 }
\ No newline at end of file
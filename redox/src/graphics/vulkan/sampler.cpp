@@ -44,7 +44,7 @@ redox::graphics::Sampler::Sampler() {
 	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
 	samplerInfo.mipLodBias = 0.0f;
 	samplerInfo.minLod = 0.0f;
-	samplerInfo.maxLod = 0.0f;
+	samplerInfo.maxLod = VK_LOD_CLAMP_NONE; //clamped to the mips of the bound view
 
 	if (vkCreateSampler(Graphics::instance().device() , &samplerInfo, nullptr, &_handle) != VK_SUCCESS)
 		throw Exception("failed to create texture sampler");
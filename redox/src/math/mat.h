@@ -62,6 +62,29 @@ namespace redox::math {
 			};
 		}
 
+		//row major, vectors are columns: (a * b) * v == a * (b * v)
+		RDX_INLINE Mat44 operator*(const Mat44& rhs) const {
+			Mat44 result;
+			for (std::size_t i = 0; i < 4; i++) {
+				result._xmm[i] = simd::add(
+					simd::add(
+						simd::mul(simd::swizzle1<0>(_xmm[i]), rhs._xmm[0]),
+						simd::mul(simd::swizzle1<1>(_xmm[i]), rhs._xmm[1])),
+					simd::add(
+						simd::mul(simd::swizzle1<2>(_xmm[i]), rhs._xmm[2]),
+						simd::mul(simd::swizzle1<3>(_xmm[i]), rhs._xmm[3])));
+			}
+			return result;
+		}
+
+		RDX_INLINE vec4_type operator*(const vec4_type& rhs) const {
+			return vec4_type(
+				simd::extract_lower(simd::dot<0xF1>(_xmm[0], rhs._xmm)),
+				simd::extract_lower(simd::dot<0xF1>(_xmm[1], rhs._xmm)),
+				simd::extract_lower(simd::dot<0xF1>(_xmm[2], rhs._xmm)),
+				simd::extract_lower(simd::dot<0xF1>(_xmm[3], rhs._xmm)));
+		}
+
 		RDX_INLINE static Mat44 identity() {
 			return {
 				simd::set(1,0,0,0),
@@ -151,7 +174,7 @@ namespace redox::math {
 			};
 		}
 
-		RDX_INLINE vec4_type operator[](std::size_t index) {
+		RDX_INLINE vec4_type operator[](std::size_t index) const {
 			return _xmm[index];
 		}
 
@@ -27,4 +27,10 @@ SOFTWARE.
 
 #include "constants.h"
 #include "vec.h"
-#include "mat.h"
\ No newline at end of file
+#include "mat.h"
+#include "core\meta\type_hash.h"
+
+RDX_TYPE_HASH(redox::math::Vec2f);
+RDX_TYPE_HASH(redox::math::Vec3f);
+RDX_TYPE_HASH(redox::math::Vec4f);
+RDX_TYPE_HASH(redox::math::Mat44f);
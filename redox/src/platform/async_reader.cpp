@@ -0,0 +1,191 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "async_reader_backend.h"
+#include "filesystem.h"
+#include "core\logging\log.h"
+#include "core\utility.h"
+
+#include <new> //std::align_val_t
+#include <algorithm> //std::min
+
+// AlignedBuffer
+
+redox::io::AlignedBuffer::AlignedBuffer(std::size_t size) :
+	_data(static_cast<byte*>(::operator new(size, std::align_val_t{ Alignment }))),
+	_size(size) {
+}
+
+redox::io::AlignedBuffer::AlignedBuffer(AlignedBuffer&& other) noexcept :
+	_data(std::exchange(other._data, nullptr)),
+	_size(std::exchange(other._size, 0)) {
+}
+
+redox::io::AlignedBuffer& redox::io::AlignedBuffer::operator=(AlignedBuffer&& other) noexcept {
+	std::swap(_data, other._data);
+	std::swap(_size, other._size);
+	return *this;
+}
+
+redox::io::AlignedBuffer::~AlignedBuffer() {
+	if (_data != nullptr)
+		::operator delete(_data, std::align_val_t{ Alignment });
+}
+
+// backend
+
+void redox::io::detail::prepare_target(read_job& job, u64 fileSize, bool direct) {
+	const auto& request = job.request;
+	const auto available = request.offset < fileSize ? fileSize - request.offset : 0;
+	job.length = request.size != 0 ? std::min(request.size, available) : available;
+	job.direct = direct;
+
+	if (!request.target.empty()) {
+		if (request.target.size() < job.length)
+			throw Exception("read target too small");
+		job.target = request.target;
+		return;
+	}
+
+	//direct reads transfer whole blocks, the tail past the file end is never exposed
+	const auto capacity = (job.length + AlignedBuffer::Alignment - 1) & ~u64(AlignedBuffer::Alignment - 1);
+	job.result.storage = AlignedBuffer(static_cast<std::size_t>(std::max<u64>(capacity, 1)));
+	job.target = { job.result.storage.data(), job.result.storage.size() };
+}
+
+void redox::io::AsyncReader::backend::complete(detail::read_job* job, bool success) {
+	job->result.file = job->request.file;
+	job->result.success = success;
+	job->result.data = success ?
+		job->target.subspan(0, static_cast<std::size_t>(std::min(job->completed, job->length))) : Span<byte>();
+
+	auto deliver = [this, job]() {
+		if (job->request.callback)
+			job->request.callback(job->result);
+		delete job;
+
+		if (pending.fetch_sub(1) == 1) {
+			RDX_UNUSED(std::lock_guard(idleMutex));
+			idle.notify_all();
+		}
+	};
+
+	if (completions != nullptr)
+		completions->submit(deliver);
+	else
+		deliver();
+}
+
+void redox::io::AsyncReader::backend::wait_idle() {
+	std::unique_lock lock(idleMutex);
+	idle.wait(lock, [this]() {
+		return pending.load() == 0;
+	});
+}
+
+namespace redox::io::detail {
+	//blocking positional reads on a private pool
+	struct fallback_backend : AsyncReader::backend {
+		fallback_backend(concurrency::WorkerPool* completions, u32 threads) :
+			backend(completions), readers(std::max(1u, threads)) {}
+
+		~fallback_backend() override {
+			wait_idle();
+		}
+
+		void submit(Buffer<read_job*>& jobs) override {
+			for (auto job : jobs) {
+				readers.submit([this, job]() {
+					run(job);
+				});
+			}
+		}
+
+		void run(read_job* job) {
+			bool success = false;
+			try {
+				File file(job->request.file, File::Mode::READ | File::Mode::THROW_IF_INVALID);
+				prepare_target(*job, file.size(), false);
+				job->completed = file.read_at(job->request.offset,
+					job->target.subspan(0, static_cast<std::size_t>(job->length)));
+				success = true;
+			}
+			catch (const std::exception& e) {
+				RDX_LOG("Failed to read {0}: {1}", ConsoleColor::RED, job->request.file, e.what());
+			}
+			complete(job, success);
+		}
+
+		bool native() const override {
+			return false;
+		}
+
+		concurrency::WorkerPool readers;
+	};
+}
+
+// AsyncReader
+
+redox::io::AsyncReader::AsyncReader(concurrency::WorkerPool* completions, const Settings& settings) {
+	if (settings.backend == Backend::AUTO)
+		_backend = detail::make_native_backend(completions, settings);
+
+	if (!_backend)
+		_backend = make_unique<detail::fallback_backend>(completions, settings.fallbackThreads);
+}
+
+redox::io::AsyncReader::AsyncReader(concurrency::WorkerPool* completions) :
+	AsyncReader(completions, Settings{}) {
+}
+
+redox::io::AsyncReader::~AsyncReader() {
+}
+
+void redox::io::AsyncReader::submit_reads(Span<ReadRequest> requests) {
+	Buffer<detail::read_job*> jobs;
+	jobs.reserve(requests.size());
+
+	for (auto& request : requests) {
+		auto job = new detail::read_job();
+		job->request = std::move(request);
+		jobs.push_back(job);
+	}
+
+	_backend->pending += jobs.size();
+	_backend->submit(jobs);
+}
+
+void redox::io::AsyncReader::register_buffers(Span<const Span<byte>> buffers) {
+	_backend->wait_idle();
+	_backend->register_buffers(buffers);
+}
+
+void redox::io::AsyncReader::wait_idle() {
+	_backend->wait_idle();
+}
+
+bool redox::io::AsyncReader::native() const {
+	return _backend->native();
+}
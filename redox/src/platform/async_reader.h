@@ -0,0 +1,104 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include "core/core.h"
+#include "core/non_copyable.h"
+#include "core/concurrency/worker_pool.h"
+
+namespace redox::io {
+	//heap block aligned for direct i/o
+	class AlignedBuffer {
+	public:
+		static constexpr std::size_t Alignment = 4096;
+
+		AlignedBuffer() = default;
+		explicit AlignedBuffer(std::size_t size);
+		AlignedBuffer(AlignedBuffer&& other) noexcept;
+		AlignedBuffer& operator=(AlignedBuffer&& other) noexcept;
+		~AlignedBuffer();
+
+		byte* data() const { return _data; }
+		std::size_t size() const { return _size; }
+
+	private:
+		byte* _data = nullptr;
+		std::size_t _size = 0;
+	};
+
+	struct ReadResult {
+		Path file;
+		Span<byte> data;		//the bytes read, points into storage or the request's target
+		AlignedBuffer storage;	//owned memory when the request had no target
+		bool success = false;
+	};
+
+	struct ReadRequest {
+		Path file;
+		u64 offset = 0;
+		u64 size = 0;			//0 reads to the end of the file
+		Span<byte> target;		//optional caller owned destination, must hold size bytes
+		Function<void(ReadResult& result)> callback;
+	};
+
+	//batched asynchronous file reads. completions are delivered on the given worker pool,
+	//or on the reader's own thread without one. uses io_uring on linux and overlapped
+	//reads on a completion port on windows, both fall back to blocking positional
+	//reads on a small thread pool when unavailable.
+	class AsyncReader : public NonCopyable {
+	public:
+		enum class Backend {
+			AUTO, FALLBACK
+		};
+
+		struct Settings {
+			Backend backend = Backend::AUTO;
+			u32 queueDepth = 64;
+			u32 fallbackThreads = 4;
+			u64 directThreshold = 4 * 1024 * 1024;	//files this large bypass the page cache
+		};
+
+		AsyncReader(concurrency::WorkerPool* completions, const Settings& settings);
+		explicit AsyncReader(concurrency::WorkerPool* completions = nullptr);
+		~AsyncReader();
+
+		//request callbacks are moved out, the span may be reused once this returns
+		void submit_reads(Span<ReadRequest> requests);
+
+		//pins the buffers for the lifetime of the reader, targets inside them skip
+		//the per-read page mapping. replaces previous registrations.
+		void register_buffers(Span<const Span<byte>> buffers);
+
+		//blocks until every submitted read has completed
+		void wait_idle();
+
+		bool native() const;
+
+		struct backend;
+
+	private:
+		UniquePtr<backend> _backend;
+	};
+}
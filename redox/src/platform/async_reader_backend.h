@@ -0,0 +1,71 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include "async_reader.h"
+
+#include <mutex> //std::mutex
+#include <condition_variable> //std::condition_variable
+
+namespace redox::io::detail {
+	struct read_job {
+		ReadRequest request;
+		ReadResult result;
+		Span<byte> target;		//whole destination, rounded up to the alignment for direct i/o
+		u64 length = 0;			//bytes wanted
+		u64 completed = 0;
+		int fd = -1;
+		i32 bufferIndex = -1;	//registered buffer holding target
+		bool direct = false;
+	};
+
+	//resolves the read length against the file size and picks the destination
+	void prepare_target(read_job& job, u64 fileSize, bool direct);
+}
+
+struct redox::io::AsyncReader::backend {
+	explicit backend(concurrency::WorkerPool* completions) :
+		completions(completions) {}
+
+	virtual ~backend() = default;
+	virtual void submit(Buffer<detail::read_job*>& jobs) = 0;
+	virtual void register_buffers(Span<const Span<byte>> /*buffers*/) {}
+	virtual bool native() const = 0;
+
+	//hands the result to the callback and releases the job
+	void complete(detail::read_job* job, bool success);
+	void wait_idle();
+
+	concurrency::WorkerPool* completions;
+	std::atomic<u64> pending{ 0 };
+	std::mutex idleMutex;
+	std::condition_variable idle;
+};
+
+namespace redox::io::detail {
+	//io_uring on linux, a completion port on windows, nullptr when unavailable
+	UniquePtr<AsyncReader::backend> make_native_backend(
+		concurrency::WorkerPool* completions, const AsyncReader::Settings& settings);
+}
@@ -0,0 +1,428 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "core/core.h"
+
+#ifdef RDX_PLATFORM_LINUX
+#include "async_reader_backend.h"
+#include "core/logging/log.h"
+#include "core/utility.h"
+
+#include <linux/io_uring.h> //io_uring_params
+#include <sys/syscall.h> //__NR_io_uring_setup
+#include <sys/mman.h> //mmap
+#include <sys/stat.h> //fstat
+#include <sys/uio.h> //iovec
+#include <fcntl.h> //open
+#include <unistd.h> //close
+#include <cerrno> //errno
+#include <cstring> //std::memset
+#include <deque> //std::deque
+#include <thread> //std::thread
+#include <algorithm> //std::min
+#include <atomic> //std::atomic
+#include <chrono> //std::chrono::milliseconds
+
+namespace redox::io::detail {
+	namespace {
+		int uring_setup(u32 entries, io_uring_params* params) {
+			return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+		}
+
+		int uring_enter(int fd, u32 submit, u32 wait, u32 flags) {
+			return static_cast<int>(::syscall(__NR_io_uring_enter, fd, submit, wait, flags, nullptr, 0));
+		}
+
+		int uring_register(int fd, u32 opcode, const void* args, u32 count) {
+			return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, args, count));
+		}
+
+		template<class T>
+		T load_acquire(const T* p) {
+			return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+		}
+
+		template<class T>
+		void store_release(T* p, T v) {
+			__atomic_store_n(p, v, __ATOMIC_RELEASE);
+		}
+
+		constexpr u64 StopToken = 0;
+		constexpr u64 MaxChunk = 1ull << 30;
+		//longest pause between polls of a ring whose wait keeps failing
+		constexpr u32 MaxBackoffShift = 7;
+	}
+
+	//one submission ring drained by a reaper thread. every job keeps at most one
+	//read in flight, short reads resubmit the remainder. jobs that do not fit the
+	//ring wait in a backlog that is pumped as completions free slots.
+	struct uring_backend : AsyncReader::backend {
+		uring_backend(concurrency::WorkerPool* completions, const AsyncReader::Settings& settings) :
+			backend(completions), directThreshold(settings.directThreshold) {
+
+			io_uring_params params = {};
+			ring = uring_setup(std::max(1u, settings.queueDepth), &params);
+			if (ring < 0)
+				throw Exception("io_uring unavailable");
+
+			sqSize = params.sq_off.array + params.sq_entries * sizeof(u32);
+			cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+			const bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+			if (single)
+				sqSize = cqSize = std::max(sqSize, cqSize);
+
+			sqRing = ::mmap(nullptr, sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+			cqRing = single ? sqRing :
+				::mmap(nullptr, cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_CQ_RING);
+			sqeSize = params.sq_entries * sizeof(io_uring_sqe);
+			void* sqeMap = ::mmap(nullptr, sqeSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQES);
+
+			if (sqRing == MAP_FAILED || cqRing == MAP_FAILED || sqeMap == MAP_FAILED) {
+				_unmap();
+				if (sqeMap != MAP_FAILED)
+					::munmap(sqeMap, sqeSize);
+				::close(ring);
+				throw Exception("failed to map io_uring");
+			}
+			sqes = static_cast<io_uring_sqe*>(sqeMap);
+
+			auto sq = static_cast<byte*>(sqRing);
+			sqHead = reinterpret_cast<u32*>(sq + params.sq_off.head);
+			sqTail = reinterpret_cast<u32*>(sq + params.sq_off.tail);
+			sqMask = *reinterpret_cast<u32*>(sq + params.sq_off.ring_mask);
+			sqArray = reinterpret_cast<u32*>(sq + params.sq_off.array);
+			sqEntries = params.sq_entries;
+
+			auto cq = static_cast<byte*>(cqRing);
+			cqHead = reinterpret_cast<u32*>(cq + params.cq_off.head);
+			cqTail = reinterpret_cast<u32*>(cq + params.cq_off.tail);
+			cqMask = *reinterpret_cast<u32*>(cq + params.cq_off.ring_mask);
+			cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+			reaper = std::thread(&uring_backend::_reap, this);
+		}
+
+		~uring_backend() override {
+			wait_idle();
+			stopping = true;
+			try {
+				RDX_UNUSED(std::lock_guard(sqMutex));
+				//nothing is in flight anymore, a full ring only has to be handed to the kernel
+				io_uring_sqe* sqe;
+				while ((sqe = _acquire_sqe()) == nullptr) {
+					_flush();
+					std::this_thread::yield();
+				}
+				sqe->opcode = IORING_OP_NOP;
+				sqe->user_data = StopToken;
+				_flush();
+			}
+			catch (const Exception&) {
+				//a failing reaper polls and sees stopping without the token
+			}
+			reaper.join();
+
+			::munmap(sqes, sqeSize);
+			_unmap();
+			::close(ring);
+		}
+
+		void submit(Buffer<read_job*>& jobs) override {
+			for (auto job : jobs) {
+				if (!_open(job)) {
+					complete(job, false);
+					continue;
+				}
+				if (job->length == 0) {
+					_finish(job, true);
+					continue;
+				}
+				RDX_UNUSED(std::lock_guard(sqMutex));
+				backlog.push_back(job);
+			}
+
+			RDX_UNUSED(std::lock_guard(sqMutex));
+			_pump();
+		}
+
+		void register_buffers(Span<const Span<byte>> buffers) override {
+			if (!registered.empty())
+				uring_register(ring, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+			registered.clear();
+
+			Buffer<iovec> vecs;
+			for (auto& buffer : buffers)
+				vecs.push_back({ buffer.data(), buffer.size() });
+
+			if (!vecs.empty() && uring_register(ring, IORING_REGISTER_BUFFERS,
+				vecs.data(), static_cast<u32>(vecs.size())) < 0) {
+				RDX_LOG("Failed to register read buffers, errno {0}", ConsoleColor::GRAY, errno);
+				return;
+			}
+			registered = std::move(vecs);
+		}
+
+		bool native() const override {
+			return true;
+		}
+
+		bool _open(read_job* job) {
+			const auto& request = job->request;
+			int fd = ::open(request.file.c_str(), O_RDONLY | O_CLOEXEC);
+			struct stat info;
+			if (fd < 0 || ::fstat(fd, &info) != 0) {
+				RDX_LOG("Failed to open {0}", ConsoleColor::RED, request.file);
+				if (fd >= 0)
+					::close(fd);
+				return false;
+			}
+
+			const auto size = static_cast<u64>(info.st_size);
+			//only owned storage is known to be aligned for the whole transfer
+			const bool direct = request.target.empty() && size >= directThreshold &&
+				request.offset % AlignedBuffer::Alignment == 0;
+
+			try {
+				prepare_target(*job, size, direct);
+			}
+			catch (const Exception& e) {
+				RDX_LOG("Failed to read {0}: {1}", ConsoleColor::RED, request.file, e.what());
+				::close(fd);
+				return false;
+			}
+
+			if (direct && ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_DIRECT) != 0)
+				job->direct = false;
+
+			job->fd = fd;
+			job->bufferIndex = _find_registered(job->target);
+			return true;
+		}
+
+		i32 _find_registered(Span<byte> target) const {
+			auto begin = reinterpret_cast<uintptr_t>(target.data());
+			for (std::size_t i = 0; i < registered.size(); ++i) {
+				auto base = reinterpret_cast<uintptr_t>(registered[i].iov_base);
+				if (begin >= base && begin + target.size() <= base + registered[i].iov_len)
+					return static_cast<i32>(i);
+			}
+			return -1;
+		}
+
+		//sqMutex held
+		io_uring_sqe* _acquire_sqe() {
+			const u32 tail = *sqTail;
+			if (tail - load_acquire(sqHead) >= sqEntries)
+				return nullptr;
+
+			const u32 index = tail & sqMask;
+			auto sqe = &sqes[index];
+			std::memset(sqe, 0, sizeof(io_uring_sqe));
+			sqArray[index] = index;
+			store_release(sqTail, tail + 1);
+			++unsubmitted;
+			return sqe;
+		}
+
+		//sqMutex held. a busy ring keeps the rest for the reaper, which flushes again
+		//once it drained the completions that block it
+		void _flush() {
+			while (unsubmitted > 0) {
+				int submitted = uring_enter(ring, unsubmitted, 0, 0);
+				if (submitted < 0) {
+					if (errno == EINTR)
+						continue;
+					if (errno == EAGAIN || errno == EBUSY)
+						return;
+					throw Exception("io_uring_enter failed");
+				}
+				unsubmitted -= static_cast<u32>(submitted);
+			}
+		}
+
+		//sqMutex held
+		void _pump() {
+			while (!backlog.empty() && inflight < sqEntries) {
+				auto sqe = _acquire_sqe();
+				if (sqe == nullptr)
+					break;
+
+				auto job = backlog.front();
+				backlog.pop_front();
+				++inflight;
+
+				const u64 remaining = job->length - job->completed;
+				u64 chunk = std::min(remaining, MaxChunk);
+				//direct transfers cover whole blocks, the target is rounded up to allow it
+				if (job->direct)
+					chunk = (chunk + AlignedBuffer::Alignment - 1) & ~u64(AlignedBuffer::Alignment - 1);
+
+				sqe->opcode = job->bufferIndex >= 0 ? IORING_OP_READ_FIXED : IORING_OP_READ;
+				sqe->fd = job->fd;
+				sqe->off = job->request.offset + job->completed;
+				sqe->addr = reinterpret_cast<u64>(job->target.data() + job->completed);
+				sqe->len = static_cast<u32>(chunk);
+				sqe->buf_index = static_cast<decltype(sqe->buf_index)>(std::max(job->bufferIndex, 0));
+				sqe->user_data = reinterpret_cast<u64>(job);
+			}
+			_flush();
+		}
+
+		void _reap() {
+			//completions keep arriving in the mapped queue while the wait fails, it is then
+			//polled at a falling rate until the ring recovers or the reader shuts down
+			u32 failures = 0;
+			auto fail = [&failures](const char* what, int error) {
+				if (failures++ == 0)
+					RDX_LOG("io_uring {0} failed, errno {1}", ConsoleColor::RED, what, error);
+			};
+
+			bool running = true;
+			while (running) {
+				if (failures > 0) {
+					if (stopping)
+						break;
+					std::this_thread::sleep_for(std::chrono::milliseconds(1u << std::min(failures, MaxBackoffShift)));
+				}
+
+				const bool waited = uring_enter(ring, 0, 1, IORING_ENTER_GETEVENTS) >= 0 || errno == EINTR;
+				if (!waited)
+					fail("wait", errno);
+
+				u32 head = *cqHead;
+				const u32 tail = load_acquire(cqTail);
+				for (; head != tail; ++head) {
+					const auto& cqe = cqes[head & cqMask];
+					if (cqe.user_data == StopToken)
+						running = false;
+					else
+						_on_complete(reinterpret_cast<read_job*>(cqe.user_data), cqe.res);
+				}
+				store_release(cqHead, head);
+
+				RDX_UNUSED(std::lock_guard(sqMutex));
+				try {
+					_pump();
+					if (waited)
+						failures = 0;
+				}
+				catch (const Exception&) {
+					fail("submit", errno);
+				}
+			}
+		}
+
+		void _on_complete(read_job* job, i32 res) {
+			{
+				RDX_UNUSED(std::lock_guard(sqMutex));
+				--inflight;
+			}
+
+			if (res == -EINVAL && job->direct) {
+				//the filesystem refused direct i/o, continue through the page cache
+				::fcntl(job->fd, F_SETFL, ::fcntl(job->fd, F_GETFL) & ~O_DIRECT);
+				job->direct = false;
+				_requeue(job);
+			}
+			else if (res == -EAGAIN || res == -EINTR) {
+				_requeue(job);
+			}
+			else if (res < 0) {
+				RDX_LOG("Failed to read {0}, errno {1}", ConsoleColor::RED, job->request.file, -res);
+				_finish(job, false);
+			}
+			else {
+				job->completed += static_cast<u64>(res);
+				if (res == 0 || job->completed >= job->length)
+					_finish(job, true);
+				else {
+					//an unaligned remainder cannot stay direct
+					if (job->direct && (job->completed % AlignedBuffer::Alignment) != 0) {
+						::fcntl(job->fd, F_SETFL, ::fcntl(job->fd, F_GETFL) & ~O_DIRECT);
+						job->direct = false;
+					}
+					_requeue(job);
+				}
+			}
+		}
+
+		void _requeue(read_job* job) {
+			RDX_UNUSED(std::lock_guard(sqMutex));
+			backlog.push_back(job);
+		}
+
+		void _finish(read_job* job, bool success) {
+			::close(job->fd);
+			job->fd = -1;
+			complete(job, success);
+		}
+
+		void _unmap() {
+			if (sqRing != MAP_FAILED)
+				::munmap(sqRing, sqSize);
+			if (cqRing != MAP_FAILED && cqRing != sqRing)
+				::munmap(cqRing, cqSize);
+		}
+
+		u64 directThreshold;
+		int ring = -1;
+
+		void* sqRing = MAP_FAILED;
+		void* cqRing = MAP_FAILED;
+		std::size_t sqSize = 0, cqSize = 0, sqeSize = 0;
+
+		u32* sqHead = nullptr;
+		u32* sqTail = nullptr;
+		u32* sqArray = nullptr;
+		u32 sqMask = 0, sqEntries = 0;
+		io_uring_sqe* sqes = nullptr;
+
+		u32* cqHead = nullptr;
+		u32* cqTail = nullptr;
+		u32 cqMask = 0;
+		io_uring_cqe* cqes = nullptr;
+
+		std::atomic<bool> stopping{ false };
+		std::mutex sqMutex;
+		std::deque<read_job*> backlog;
+		u32 inflight = 0;
+		u32 unsubmitted = 0;
+
+		Buffer<iovec> registered;
+		std::thread reaper;
+	};
+}
+
+redox::UniquePtr<redox::io::AsyncReader::backend> redox::io::detail::make_native_backend(
+	concurrency::WorkerPool* completions, const AsyncReader::Settings& settings) {
+	try {
+		return make_unique<uring_backend>(completions, settings);
+	}
+	catch (const Exception& e) {
+		RDX_LOG("{0}, using the thread pool reader", ConsoleColor::GRAY, e.what());
+		return nullptr;
+	}
+}
+#endif
@@ -0,0 +1,294 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "core\core.h"
+
+#ifdef RDX_PLATFORM_WINDOWS
+#include "async_reader_backend.h"
+#include "platform\windows.h"
+#include "core\logging\log.h"
+#include "core\utility.h"
+
+#include <deque> //std::deque
+#include <thread> //std::thread
+#include <algorithm> //std::min
+#include <cstring> //std::memset
+
+namespace redox::io::detail {
+	namespace {
+		constexpr ULONG_PTR ReadKey = 1;
+		constexpr ULONG_PTR StopKey = 2;
+		constexpr u64 MaxChunk = 1ull << 30;
+	}
+
+	//overlapped reads completed through one i/o completion port drained by a reaper
+	//thread. like the io_uring backend every job keeps at most one read in flight,
+	//short reads resubmit the remainder and queueDepth bounds the open files.
+	struct iocp_backend : AsyncReader::backend {
+		struct overlapped_read {
+			OVERLAPPED overlapped;	//first member, completions hand back its address
+			read_job* job;
+			HANDLE file;
+		};
+
+		iocp_backend(concurrency::WorkerPool* completions, const AsyncReader::Settings& settings) :
+			backend(completions),
+			directThreshold(settings.directThreshold),
+			queueDepth(std::max(1u, settings.queueDepth)) {
+
+			port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
+			if (port == NULL)
+				throw Exception("failed to create i/o completion port");
+
+			reaper = std::thread(&iocp_backend::_reap, this);
+		}
+
+		~iocp_backend() override {
+			wait_idle();
+			PostQueuedCompletionStatus(port, 0, StopKey, NULL);
+			reaper.join();
+			CloseHandle(port);
+		}
+
+		void submit(Buffer<read_job*>& jobs) override {
+			{
+				RDX_UNUSED(std::lock_guard(queueMutex));
+				backlog.insert(backlog.end(), jobs.begin(), jobs.end());
+			}
+			_pump();
+		}
+
+		bool native() const override {
+			return true;
+		}
+
+		//opens the files of waiting jobs while slots are free
+		void _pump() {
+			for (;;) {
+				read_job* job;
+				{
+					RDX_UNUSED(std::lock_guard(queueMutex));
+					if (backlog.empty() || inflight >= queueDepth)
+						return;
+					job = backlog.front();
+					backlog.pop_front();
+					++inflight;
+				}
+
+				auto read = _open(job);
+				if (read == nullptr) {
+					_release_slot();
+					complete(job, false);
+				}
+				else if (job->length == 0) {
+					_finish(read, true);
+				}
+				else {
+					_issue(read);
+				}
+			}
+		}
+
+		overlapped_read* _open(read_job* job) {
+			const auto& request = job->request;
+			HANDLE file = _open_handle(request.file, false);
+			LARGE_INTEGER size;
+			if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size)) {
+				RDX_LOG("Failed to open {0}", ConsoleColor::RED, request.file);
+				if (file != INVALID_HANDLE_VALUE)
+					CloseHandle(file);
+				return nullptr;
+			}
+
+			const auto fileSize = static_cast<u64>(size.QuadPart);
+			//only owned storage is known to be aligned for the whole transfer
+			const bool direct = request.target.empty() && fileSize >= directThreshold &&
+				request.offset % AlignedBuffer::Alignment == 0;
+
+			try {
+				prepare_target(*job, fileSize, direct);
+			}
+			catch (const Exception& e) {
+				RDX_LOG("Failed to read {0}: {1}", ConsoleColor::RED, request.file, e.what());
+				CloseHandle(file);
+				return nullptr;
+			}
+
+			//unbuffered access is fixed when the handle is created, reopen for it
+			if (direct) {
+				HANDLE unbuffered = _open_handle(request.file, true);
+				if (unbuffered != INVALID_HANDLE_VALUE) {
+					CloseHandle(file);
+					file = unbuffered;
+				}
+				else {
+					job->direct = false;
+				}
+			}
+
+			auto read = new overlapped_read{};
+			read->job = job;
+			read->file = file;
+			if (!_associate(read)) {
+				delete read;
+				CloseHandle(file);
+				return nullptr;
+			}
+			return read;
+		}
+
+		HANDLE _open_handle(const Path& path, bool direct) const {
+			DWORD flags = FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN;
+			if (direct)
+				flags |= FILE_FLAG_NO_BUFFERING;
+			return CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, flags, NULL);
+		}
+
+		bool _associate(overlapped_read* read) const {
+			if (CreateIoCompletionPort(read->file, port, ReadKey, 0) == NULL) {
+				RDX_LOG("Failed to read {0}, error {1}", ConsoleColor::RED, read->job->request.file, GetLastError());
+				return false;
+			}
+			return true;
+		}
+
+		void _issue(overlapped_read* read) {
+			auto job = read->job;
+			u64 chunk = std::min(job->length - job->completed, MaxChunk);
+			//unbuffered transfers cover whole sectors, the target is rounded up to allow it
+			if (job->direct)
+				chunk = (chunk + AlignedBuffer::Alignment - 1) & ~u64(AlignedBuffer::Alignment - 1);
+
+			const auto offset = job->request.offset + job->completed;
+			std::memset(&read->overlapped, 0, sizeof(OVERLAPPED));
+			read->overlapped.Offset = static_cast<DWORD>(offset);
+			read->overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+			//synchronous successes are queued to the port as well
+			if (!ReadFile(read->file, job->target.data() + job->completed,
+				static_cast<DWORD>(chunk), NULL, &read->overlapped)) {
+				const auto error = GetLastError();
+				if (error == ERROR_HANDLE_EOF) {
+					_finish(read, true);
+				}
+				else if (error != ERROR_IO_PENDING) {
+					RDX_LOG("Failed to read {0}, error {1}", ConsoleColor::RED, job->request.file, error);
+					_finish(read, false);
+				}
+			}
+		}
+
+		void _reap() {
+			for (;;) {
+				DWORD bytes = 0;
+				ULONG_PTR key = 0;
+				OVERLAPPED* overlapped = nullptr;
+				const bool ok = GetQueuedCompletionStatus(port, &bytes, &key, &overlapped, INFINITE) != FALSE;
+
+				if (key == StopKey)
+					break;
+
+				if (overlapped == nullptr) {
+					RDX_LOG("i/o completion wait failed, error {0}", ConsoleColor::RED, GetLastError());
+					continue;
+				}
+
+				_on_complete(reinterpret_cast<overlapped_read*>(overlapped), ok ? ERROR_SUCCESS : GetLastError(), bytes);
+				_pump();
+			}
+		}
+
+		void _on_complete(overlapped_read* read, DWORD error, DWORD bytes) {
+			auto job = read->job;
+			if (error == ERROR_HANDLE_EOF) {
+				_finish(read, true);
+				return;
+			}
+
+			if (error != ERROR_SUCCESS) {
+				RDX_LOG("Failed to read {0}, error {1}", ConsoleColor::RED, job->request.file, error);
+				_finish(read, false);
+				return;
+			}
+
+			job->completed += bytes;
+			if (bytes == 0 || job->completed >= job->length) {
+				_finish(read, true);
+				return;
+			}
+
+			//an unaligned remainder cannot stay unbuffered
+			if (job->direct && (job->completed % AlignedBuffer::Alignment) != 0) {
+				HANDLE buffered = _open_handle(job->request.file, false);
+				CloseHandle(read->file);
+				read->file = buffered;
+				job->direct = false;
+				if (buffered == INVALID_HANDLE_VALUE || !_associate(read)) {
+					_finish(read, false);
+					return;
+				}
+			}
+			_issue(read);
+		}
+
+		void _finish(overlapped_read* read, bool success) {
+			if (read->file != INVALID_HANDLE_VALUE)
+				CloseHandle(read->file);
+
+			auto job = read->job;
+			delete read;
+
+			_release_slot();
+			complete(job, success);
+		}
+
+		void _release_slot() {
+			RDX_UNUSED(std::lock_guard(queueMutex));
+			--inflight;
+		}
+
+		u64 directThreshold;
+		u32 queueDepth;
+		HANDLE port = NULL;
+
+		std::mutex queueMutex;
+		std::deque<read_job*> backlog;
+		u32 inflight = 0;
+
+		std::thread reaper;
+	};
+}
+
+redox::UniquePtr<redox::io::AsyncReader::backend> redox::io::detail::make_native_backend(
+	concurrency::WorkerPool* completions, const AsyncReader::Settings& settings) {
+	try {
+		return make_unique<iocp_backend>(completions, settings);
+	}
+	catch (const Exception& e) {
+		RDX_LOG("{0}, using the thread pool reader", ConsoleColor::GRAY, e.what());
+		return nullptr;
+	}
+}
+#endif
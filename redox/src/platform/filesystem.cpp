@@ -0,0 +1,61 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "filesystem.h"
+
+#include <algorithm> //std::find_if
+
+void redox::io::DirectoryWatcher::subscribe(CallbackType callback) {
+	_callback = std::move(callback);
+}
+
+void redox::io::DirectoryWatcher::subscribe_batch(BatchCallbackType callback) {
+	_batchCallback = std::move(callback);
+}
+
+void redox::io::DirectoryWatcher::_coalesce(Buffer<Change>& changes, Path file, ChangeEvents events) {
+	//batches are small, a linear search keeps the arrival order
+	auto it = std::find_if(changes.begin(), changes.end(), [&file](const Change& change) {
+		return change.file == file;
+	});
+
+	if (it != changes.end())
+		it->events |= events;
+	else
+		changes.push_back({ std::move(file), events });
+}
+
+void redox::io::DirectoryWatcher::_dispatch(const Buffer<Change>& changes) {
+	if (changes.empty())
+		return;
+
+	if (_batchCallback)
+		_batchCallback(changes);
+
+	if (_callback) {
+		for (const auto& change : changes)
+			_callback(change.file, change.events);
+	}
+}
@@ -24,9 +24,9 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #pragma once
-#include <core\core.h>
-#include <core\non_copyable.h>
-#include <core\utility.h>
+#include <core/core.h>
+#include <core/non_copyable.h>
+#include <core/utility.h>
 
 namespace redox::io {
 	class File : public NonCopyable {
@@ -42,9 +42,39 @@ namespace redox::io {
 		~File();
 
 		bool is_valid() const;
-		std::size_t size() const;
+		u64 size() const;
 		Buffer<i8> read();
 
+		//positional read, safe to call concurrently on one file.
+		//returns the bytes read, less than requested only at the end of the file.
+		std::size_t read_at(u64 offset, Span<byte> target) const;
+
+	private:
+		struct internal;
+		UniquePtr<internal> _internal;
+	};
+
+	//read-only view of a whole file, pages are faulted in on first access
+	class MappedFile : public NonCopyable {
+	public:
+		enum class Advice {
+			NORMAL,
+			SEQUENTIAL,
+			RANDOM,
+			WILLNEED,
+			DONTNEED
+		};
+
+		MappedFile(const Path& file, const Advice advice = Advice::NORMAL);
+		~MappedFile();
+
+		Span<const byte> data() const;
+		std::size_t size() const;
+
+		//hints are best effort and ignored where the platform has no equivalent
+		void advise(const Advice advice) const;
+		void advise(const Advice advice, std::size_t offset, std::size_t length) const;
+
 	private:
 		struct internal;
 		UniquePtr<internal> _internal;
@@ -55,21 +85,37 @@ namespace redox::io {
 		FILE_REMOVED = 0x1 << 1,
 		FILE_MODIFIED = 0x1 << 2,
 		FILE_RENAME = 0x1 << 3,
-		UNKNOWN = 0x1 << 4
+		UNKNOWN = 0x1 << 4,
+		RESCAN = 0x1 << 5 //events were dropped, the whole tree may have changed
 	};
 
+	//watches a directory tree, paths are reported relative to the watched directory.
+	//events for the same file are coalesced and delivered in batches.
 	class DirectoryWatcher : public NonCopyable {
 	public:
+		struct Change {
+			Path file;
+			ChangeEvents events;
+		};
+
 		using CallbackType = Function<void(const Path& file, ChangeEvents events)>;
+		using BatchCallbackType = Function<void(const Buffer<Change>& changes)>;
 
 		DirectoryWatcher();
 		~DirectoryWatcher();
 
 		void subscribe(CallbackType callback);
+		void subscribe_batch(BatchCallbackType callback);
 		void start(const Path& directory, ChangeEvents events);
 		void stop();
 
 	private:
+		static void _coalesce(Buffer<Change>& changes, Path file, ChangeEvents events);
+		void _dispatch(const Buffer<Change>& changes);
+
+		CallbackType _callback;
+		BatchCallbackType _batchCallback;
+
 		struct internal;
 		UniquePtr<internal> _internal;
 	};
@@ -0,0 +1,403 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "core/core.h"
+
+#ifdef RDX_PLATFORM_LINUX
+#include "filesystem.h"
+#include "core/logging/log.h"
+
+#include <algorithm> //std::min
+#include <fcntl.h> //open
+#include <unistd.h> //close, pread
+#include <sys/mman.h> //mmap, madvise
+#include <sys/stat.h> //fstat
+#include <sys/inotify.h> //inotify_init1, inotify_add_watch
+#include <sys/epoll.h> //epoll_create1, epoll_wait
+#include <sys/eventfd.h> //eventfd
+#include <cerrno> //errno
+#include <thread> //std::thread
+
+// File
+
+struct redox::io::File::internal {
+	int fd{ -1 };
+};
+
+redox::io::File::File(const redox::Path& file, const Mode mode) :
+	_internal(std::make_unique<internal>()) {
+
+	int flags = O_CLOEXEC;
+	if (util::check_flag(mode, Mode::READ) && util::check_flag(mode, Mode::WRITE))
+		flags |= O_RDWR;
+	else if (util::check_flag(mode, Mode::WRITE))
+		flags |= O_WRONLY;
+	else
+		flags |= O_RDONLY;
+
+	if (util::check_flag(mode, Mode::ALWAYS_CREATE))
+		flags |= O_CREAT | O_TRUNC;
+
+	_internal->fd = open(file.c_str(), flags, 0644);
+
+	if (util::check_flag(mode, Mode::THROW_IF_INVALID) && !is_valid())
+		throw Exception("failed to open file");
+}
+
+redox::io::File::~File() {
+	if (is_valid())
+		close(_internal->fd);
+}
+
+bool redox::io::File::is_valid() const {
+	return (_internal->fd != -1);
+}
+
+redox::u64 redox::io::File::size() const {
+	struct stat st;
+	if (fstat(_internal->fd, &st) != 0)
+		throw Exception("failed to query file size");
+	return static_cast<u64>(st.st_size);
+}
+
+redox::Buffer<redox::i8> redox::io::File::read() {
+	Buffer<i8> out(static_cast<std::size_t>(size()));
+
+	for (std::size_t offset = 0; offset < out.size();) {
+		auto bytes = pread(_internal->fd, out.data() + offset, out.size() - offset, static_cast<off_t>(offset));
+		if (bytes < 0 && errno == EINTR)
+			continue;
+		if (bytes <= 0)
+			throw Exception("failed to read file");
+
+		offset += static_cast<std::size_t>(bytes);
+	}
+
+	return out;
+}
+
+std::size_t redox::io::File::read_at(u64 offset, Span<byte> target) const {
+	std::size_t total = 0;
+
+	while (total < target.size()) {
+		auto bytes = pread(_internal->fd, target.data() + total,
+			target.size() - total, static_cast<off_t>(offset + total));
+
+		if (bytes < 0 && errno == EINTR)
+			continue;
+		if (bytes < 0)
+			throw Exception("failed to read file");
+		if (bytes == 0)
+			break;
+
+		total += static_cast<std::size_t>(bytes);
+	}
+
+	return total;
+}
+
+// MappedFile
+
+namespace {
+	int to_madvise(redox::io::MappedFile::Advice advice) {
+		using Advice = redox::io::MappedFile::Advice;
+		switch (advice) {
+		case Advice::SEQUENTIAL: return MADV_SEQUENTIAL;
+		case Advice::RANDOM: return MADV_RANDOM;
+		case Advice::WILLNEED: return MADV_WILLNEED;
+		case Advice::DONTNEED: return MADV_DONTNEED;
+		default: return MADV_NORMAL;
+		}
+	}
+}
+
+struct redox::io::MappedFile::internal {
+	int fd{ -1 };
+	void* view{ MAP_FAILED };
+	std::size_t size{ 0 };
+
+	~internal() {
+		if (view != MAP_FAILED)
+			munmap(view, size);
+		if (fd != -1)
+			close(fd);
+	}
+};
+
+redox::io::MappedFile::MappedFile(const Path& file, const Advice advice) :
+	_internal(std::make_unique<internal>()) {
+
+	_internal->fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+	if (_internal->fd == -1)
+		throw Exception("failed to open file");
+
+	struct stat st;
+	if (fstat(_internal->fd, &st) != 0)
+		throw Exception("failed to query file size");
+
+	_internal->size = static_cast<std::size_t>(st.st_size);
+
+	//empty files cannot be mapped
+	if (_internal->size == 0)
+		return;
+
+	_internal->view = mmap(nullptr, _internal->size, PROT_READ, MAP_PRIVATE, _internal->fd, 0);
+	if (_internal->view == MAP_FAILED)
+		throw Exception("failed to map file");
+
+	//the mapping keeps the file referenced
+	close(_internal->fd);
+	_internal->fd = -1;
+
+	if (advice != Advice::NORMAL)
+		this->advise(advice);
+}
+
+redox::io::MappedFile::~MappedFile() {
+}
+
+redox::Span<const redox::byte> redox::io::MappedFile::data() const {
+	if (_internal->view == MAP_FAILED)
+		return {};
+	return { static_cast<const byte*>(_internal->view), _internal->size };
+}
+
+std::size_t redox::io::MappedFile::size() const {
+	return _internal->size;
+}
+
+void redox::io::MappedFile::advise(const Advice advice) const {
+	advise(advice, 0, _internal->size);
+}
+
+void redox::io::MappedFile::advise(const Advice advice, std::size_t offset, std::size_t length) const {
+	if (_internal->view == MAP_FAILED || offset >= _internal->size)
+		return;
+
+	//madvise wants a page aligned start
+	const auto page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+	const auto begin = offset & ~(page - 1);
+	const auto end = offset + std::min(length, _internal->size - offset);
+
+	madvise(static_cast<byte*>(_internal->view) + begin, end - begin, to_madvise(advice));
+}
+
+// DirectoryWatcher
+
+struct redox::io::DirectoryWatcher::internal {
+	//a burst of events is collected until the tree stays quiet for this long
+	static constexpr int CoalesceMs = 20;
+	static constexpr int MaxCoalesceRounds = 10;
+
+	int inotifyFd{ -1 };
+	int epollFd{ -1 };
+	int stopFd{ -1 };
+	std::thread thread;
+
+	Path directory;
+	ChangeEvents events;
+	Hashmap<int, Path> watches;
+
+	//added reports the files already inside, which were created before the watch existed
+	void add_watch(const Path& relative, Buffer<Change>* added = nullptr);
+	void read_events(Buffer<Change>& changes);
+	ChangeEvents translate(u32 mask) const;
+	void close_all();
+};
+
+void redox::io::DirectoryWatcher::internal::add_watch(const Path& relative, Buffer<Change>* added) {
+	constexpr u32 mask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE |
+		IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB | IN_DELETE_SELF | IN_ONLYDIR;
+
+	auto absolute = directory / relative;
+	int wd = inotify_add_watch(inotifyFd, absolute.c_str(), mask);
+	if (wd == -1)
+		return;
+
+	watches[wd] = relative;
+
+	std::error_code ec;
+	for (auto it = std::filesystem::directory_iterator(absolute, ec);
+		it != std::filesystem::directory_iterator(); it.increment(ec)) {
+		if (ec)
+			break;
+		if (it->is_directory(ec) && !it->is_symlink(ec))
+			add_watch(relative / it->path().filename(), added);
+		else if (added != nullptr && it->is_regular_file(ec) && util::check_flag(events, ChangeEvents::FILE_ADDED))
+			_coalesce(*added, (relative / it->path().filename()).lexically_normal(), ChangeEvents::FILE_ADDED);
+	}
+}
+
+redox::io::ChangeEvents redox::io::DirectoryWatcher::internal::translate(u32 mask) const {
+	ChangeEvents event{};
+	if (mask & (IN_CREATE | IN_MOVED_TO))
+		event |= ChangeEvents::FILE_ADDED;
+	if (mask & (IN_DELETE | IN_MOVED_FROM))
+		event |= ChangeEvents::FILE_REMOVED;
+	if (mask & (IN_MOVED_FROM | IN_MOVED_TO))
+		event |= ChangeEvents::FILE_RENAME;
+	if (mask & (IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB))
+		event |= ChangeEvents::FILE_MODIFIED;
+	return event & events;
+}
+
+void redox::io::DirectoryWatcher::internal::read_events(Buffer<Change>& changes) {
+	alignas(inotify_event) char buffer[16 * 1024];
+
+	for (;;) {
+		auto bytes = ::read(inotifyFd, buffer, sizeof(buffer));
+		if (bytes <= 0)
+			return;
+
+		for (auto cursor = buffer; cursor < buffer + bytes;) {
+			auto ev = reinterpret_cast<const inotify_event*>(cursor);
+			cursor += sizeof(inotify_event) + ev->len;
+
+			if (ev->mask & IN_Q_OVERFLOW) {
+				_coalesce(changes, Path(), ChangeEvents::RESCAN);
+				continue;
+			}
+
+			if (ev->mask & IN_IGNORED) {
+				watches.erase(ev->wd);
+				continue;
+			}
+
+			auto it = watches.find(ev->wd);
+			if (it == watches.end() || ev->len == 0)
+				continue;
+
+			auto relative = it->second / ev->name;
+			if (ev->mask & IN_ISDIR) {
+				//new subdirectories are watched as well, their own changes are not reported.
+				//a directory moved in or filled before its watch existed brings files with it.
+				if (ev->mask & (IN_CREATE | IN_MOVED_TO))
+					add_watch(relative, &changes);
+				continue;
+			}
+
+			auto event = translate(ev->mask);
+			if (event != ChangeEvents{})
+				_coalesce(changes, relative.lexically_normal(), event);
+		}
+	}
+}
+
+void redox::io::DirectoryWatcher::internal::close_all() {
+	if (thread.joinable()) {
+		u64 signal = 1;
+		[[maybe_unused]] auto written = ::write(stopFd, &signal, sizeof(signal));
+		thread.join();
+	}
+
+	for (auto fd : { inotifyFd, epollFd, stopFd }) {
+		if (fd != -1)
+			close(fd);
+	}
+
+	inotifyFd = epollFd = stopFd = -1;
+	watches.clear();
+}
+
+redox::io::DirectoryWatcher::DirectoryWatcher() :
+	_internal(std::make_unique<internal>()) {
+}
+
+redox::io::DirectoryWatcher::~DirectoryWatcher() {
+	stop();
+}
+
+void redox::io::DirectoryWatcher::start(const Path& directory, ChangeEvents events) {
+	stop();
+
+	_internal->directory = directory;
+	_internal->events = events;
+	_internal->inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	_internal->epollFd = epoll_create1(EPOLL_CLOEXEC);
+	_internal->stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+	if (_internal->inotifyFd == -1 || _internal->epollFd == -1 || _internal->stopFd == -1) {
+		_internal->close_all();
+		throw Exception("failed to initialize inotify");
+	}
+
+	for (auto fd : { _internal->inotifyFd, _internal->stopFd }) {
+		epoll_event ev{};
+		ev.events = EPOLLIN;
+		ev.data.fd = fd;
+		epoll_ctl(_internal->epollFd, EPOLL_CTL_ADD, fd, &ev);
+	}
+
+	_internal->add_watch(Path());
+	if (_internal->watches.empty()) {
+		_internal->close_all();
+		throw Exception("inotify_add_watch() failed.");
+	}
+
+	_internal->thread = std::thread([this]() {
+		auto& internal = *_internal;
+		Buffer<Change> changes;
+		int rounds = 0;
+
+		for (;;) {
+			epoll_event ev;
+			int timeout = changes.empty() ? -1 : internal::CoalesceMs;
+			int ready = epoll_wait(internal.epollFd, &ev, 1, timeout);
+
+			if (ready < 0) {
+				if (errno == EINTR)
+					continue;
+
+				//the descriptors are unusable, nothing would ever arrive again
+				RDX_LOG("Directory watcher stopped, epoll_wait failed with errno {0}", ConsoleColor::RED, errno);
+				if (!changes.empty())
+					_dispatch(changes);
+				break;
+			}
+			if (ready > 0 && ev.data.fd == internal.stopFd)
+				break;
+
+			if (ready > 0) {
+				internal.read_events(changes);
+				++rounds;
+			}
+
+			//deliver once the tree went quiet, or periodically under a steady stream
+			if (changes.empty()) {
+				rounds = 0;
+			}
+			else if (ready == 0 || rounds >= internal::MaxCoalesceRounds) {
+				_dispatch(changes);
+				changes.clear();
+				rounds = 0;
+			}
+		}
+	});
+}
+
+void redox::io::DirectoryWatcher::stop() {
+	_internal->close_all();
+}
+#endif
@@ -29,6 +29,8 @@ SOFTWARE.
 #include "filesystem.h"
 #include "platform\windows.h"
 
+#include <algorithm> //std::min
+
 struct redox::io::File::internal {
 	HANDLE handle;
 };
@@ -47,7 +49,9 @@ redox::io::File::File(const redox::Path& file, const Mode mode) :
 	if (util::check_flag(mode, Mode::ALWAYS_CREATE))
 		creationFlags = CREATE_ALWAYS;
 
-	_internal->handle = CreateFileW(file.c_str(), access, 0, NULL,
+	//readers share, writers stay exclusive
+	DWORD share = util::check_flag(mode, Mode::WRITE) ? 0 : FILE_SHARE_READ;
+	_internal->handle = CreateFileW(file.c_str(), access, share, NULL,
 		creationFlags, FILE_ATTRIBUTE_NORMAL, NULL);
 
 	if (util::check_flag(mode, Mode::THROW_IF_INVALID) && !is_valid())
@@ -63,34 +67,156 @@ bool redox::io::File::is_valid() const {
 	return (_internal->handle != INVALID_HANDLE_VALUE);
 }
 
-std::size_t redox::io::File::size() const {
-	return GetFileSize(_internal->handle, NULL);
+redox::u64 redox::io::File::size() const {
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(_internal->handle, &size))
+		throw Exception("failed to query file size");
+	return static_cast<u64>(size.QuadPart);
 }
 
 redox::Buffer<redox::i8> redox::io::File::read() {
-	Buffer<i8> out(size());
+	Buffer<i8> out(static_cast<std::size_t>(size()));
+
+	//ReadFile takes a DWORD count, larger files are read in chunks
+	constexpr std::size_t maxChunk = 1u << 30;
+	for (std::size_t offset = 0; offset < out.size();) {
+		auto chunk = static_cast<DWORD>(std::min(maxChunk, out.size() - offset));
 
-	DWORD dwBytesRead;
-	if (!ReadFile(_internal->handle,
-		out.data(), static_cast<DWORD>(out.size()), &dwBytesRead, NULL))
-		throw Exception("failed to read file");
+		DWORD dwBytesRead;
+		if (!ReadFile(_internal->handle,
+			out.data() + offset, chunk, &dwBytesRead, NULL) || dwBytesRead == 0)
+			throw Exception("failed to read file");
+
+		offset += dwBytesRead;
+	}
 
 	return out;
 }
 
+std::size_t redox::io::File::read_at(u64 offset, Span<byte> target) const {
+	constexpr std::size_t maxChunk = 1u << 30;
+	std::size_t total = 0;
+
+	while (total < target.size()) {
+		auto position = offset + total;
+		OVERLAPPED overlapped{};
+		overlapped.Offset = static_cast<DWORD>(position);
+		overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+
+		auto chunk = static_cast<DWORD>(std::min(maxChunk, target.size() - total));
+		DWORD dwBytesRead = 0;
+		if (!ReadFile(_internal->handle, target.data() + total, chunk, &dwBytesRead, &overlapped)) {
+			if (GetLastError() == ERROR_HANDLE_EOF)
+				break;
+			throw Exception("failed to read file");
+		}
+
+		if (dwBytesRead == 0)
+			break;
+		total += dwBytesRead;
+	}
+
+	return total;
+}
+
+// MappedFile
+
+struct redox::io::MappedFile::internal {
+	HANDLE file{ INVALID_HANDLE_VALUE };
+	HANDLE mapping{ NULL };
+	const byte* view{ nullptr };
+	std::size_t size{ 0 };
+
+	~internal() {
+		if (view != nullptr)
+			UnmapViewOfFile(view);
+		if (mapping != NULL)
+			CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE)
+			CloseHandle(file);
+	}
+};
+
+redox::io::MappedFile::MappedFile(const Path& file, const Advice advice) :
+	_internal(std::make_unique<internal>()) {
+
+	DWORD flags = FILE_ATTRIBUTE_NORMAL;
+	if (advice == Advice::SEQUENTIAL)
+		flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+	else if (advice == Advice::RANDOM)
+		flags |= FILE_FLAG_RANDOM_ACCESS;
+
+	_internal->file = CreateFileW(file.c_str(), GENERIC_READ, FILE_SHARE_READ,
+		NULL, OPEN_EXISTING, flags, NULL);
+
+	if (_internal->file == INVALID_HANDLE_VALUE)
+		throw Exception("failed to open file");
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(_internal->file, &size))
+		throw Exception("failed to query file size");
+
+	_internal->size = static_cast<std::size_t>(size.QuadPart);
+
+	//empty files cannot be mapped
+	if (_internal->size == 0)
+		return;
+
+	_internal->mapping = CreateFileMappingW(_internal->file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (_internal->mapping == NULL)
+		throw Exception("failed to create file mapping");
+
+	_internal->view = static_cast<const byte*>(
+		MapViewOfFile(_internal->mapping, FILE_MAP_READ, 0, 0, 0));
+
+	if (_internal->view == nullptr)
+		throw Exception("failed to map file");
+
+	if (advice == Advice::WILLNEED)
+		this->advise(advice);
+}
+
+redox::io::MappedFile::~MappedFile() {
+}
+
+redox::Span<const redox::byte> redox::io::MappedFile::data() const {
+	return { _internal->view, _internal->size };
+}
+
+std::size_t redox::io::MappedFile::size() const {
+	return _internal->size;
+}
+
+void redox::io::MappedFile::advise(const Advice advice) const {
+	advise(advice, 0, _internal->size);
+}
+
+void redox::io::MappedFile::advise(const Advice advice, std::size_t offset, std::size_t length) const {
+	if (_internal->view == nullptr || offset >= _internal->size)
+		return;
+
+	//access patterns are fixed at CreateFileW, only prefetching can be requested later
+	if (advice == Advice::WILLNEED) {
+		WIN32_MEMORY_RANGE_ENTRY range;
+		range.VirtualAddress = const_cast<byte*>(_internal->view + offset);
+		range.NumberOfBytes = std::min(length, _internal->size - offset);
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+	}
+}
+
 // DirectoryWatcher
 
 struct redox::io::DirectoryWatcher::internal {
 	bool running{ false };
 	Path directory;
 	ChangeEvents events;
-	CallbackType callback;
 	HANDLE directoryHandle;
 	HANDLE waitHandle;
 	OVERLAPPED overlapped;
-	Buffer<i8> buffer;
+	Buffer<DWORD> buffer;
 
 	void read_changes();
+	ChangeEvents translate(DWORD action) const;
 	static VOID CALLBACK WaitCallback(
 		_In_ PVOID   lpParameter,
 		_In_ BOOLEAN TimerOrWaitFired);
@@ -104,10 +230,6 @@ redox::io::DirectoryWatcher::~DirectoryWatcher() {
 	stop();
 }
 
-void redox::io::DirectoryWatcher::subscribe(CallbackType callback) {
-	_internal->callback = std::move(callback);
-}
-
 void redox::io::DirectoryWatcher::start(const Path& directory, ChangeEvents events) {
 	stop();
 
@@ -116,7 +238,7 @@ void redox::io::DirectoryWatcher::start(const Path& directory, ChangeEvents even
 	_internal->directoryHandle = CreateFileW(
 		directory.c_str(),
 		FILE_LIST_DIRECTORY,
-		FILE_SHARE_WRITE | FILE_SHARE_READ,
+		FILE_SHARE_WRITE | FILE_SHARE_READ | FILE_SHARE_DELETE,
 		NULL,
 		OPEN_EXISTING,
 		FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
@@ -126,9 +248,11 @@ void redox::io::DirectoryWatcher::start(const Path& directory, ChangeEvents even
 		throw Exception("CreateFileW() failed.");
 	}
 
-	constexpr auto bfSize = 10 * (sizeof(FILE_NOTIFY_INFORMATION));
+	//DWORD aligned as required by ReadDirectoryChangesW, 64kb is the network share limit
+	constexpr std::size_t bfSize = 64 * 1024;
+	_internal->overlapped = {};
 	_internal->overlapped.hEvent = CreateEvent(0, 0, 0, 0);
-	_internal->buffer.reserve(static_cast<size_t>(bfSize));
+	_internal->buffer.resize(bfSize / sizeof(DWORD));
 
 	if (!RegisterWaitForSingleObject(
 		&_internal->waitHandle,
@@ -145,7 +269,8 @@ void redox::io::DirectoryWatcher::start(const Path& directory, ChangeEvents even
 
 void redox::io::DirectoryWatcher::stop() {
 	if (_internal->running) {
-		UnregisterWaitEx(_internal->waitHandle, NULL);
+		CancelIoEx(_internal->directoryHandle, &_internal->overlapped);
+		UnregisterWaitEx(_internal->waitHandle, INVALID_HANDLE_VALUE);
 		CloseHandle(_internal->overlapped.hEvent);
 		CloseHandle(_internal->directoryHandle);
 		_internal->running = false;
@@ -153,64 +278,81 @@ void redox::io::DirectoryWatcher::stop() {
 }
 
 void redox::io::DirectoryWatcher::internal::read_changes() {
-	buffer.clear();
-
-	auto filter = FILE_NOTIFY_CHANGE_FILE_NAME;
+	auto filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME;
 	if (util::check_flag(events, ChangeEvents::FILE_MODIFIED)) {
 		filter |= FILE_NOTIFY_CHANGE_ATTRIBUTES | FILE_NOTIFY_CHANGE_SIZE |
-			FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_LAST_ACCESS |
-			FILE_NOTIFY_CHANGE_CREATION | FILE_NOTIFY_CHANGE_SECURITY;
+			FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_CREATION;
 	}
 
-	[[maybe_unused]] DWORD bytes;
 	if (!ReadDirectoryChangesW(
-		directoryHandle, buffer.data(), static_cast<DWORD>(buffer.capacity()),
-		TRUE, filter, &bytes, &overlapped, NULL)) {
+		directoryHandle, buffer.data(), static_cast<DWORD>(buffer.size() * sizeof(DWORD)),
+		TRUE, filter, NULL, &overlapped, NULL)) {
 
 		throw Exception("ReadDirectoryChangesW() failed.");
 	}
 }
 
+redox::io::ChangeEvents redox::io::DirectoryWatcher::internal::translate(DWORD action) const {
+	ChangeEvents event{ ChangeEvents::UNKNOWN };
+	switch (action) {
+	case FILE_ACTION_ADDED:
+		event = ChangeEvents::FILE_ADDED;
+		break;
+	case FILE_ACTION_MODIFIED:
+		event = ChangeEvents::FILE_MODIFIED;
+		break;
+	case FILE_ACTION_REMOVED:
+		event = ChangeEvents::FILE_REMOVED;
+		break;
+	case FILE_ACTION_RENAMED_OLD_NAME:
+		event = ChangeEvents::FILE_RENAME | ChangeEvents::FILE_REMOVED;
+		break;
+	case FILE_ACTION_RENAMED_NEW_NAME:
+		event = ChangeEvents::FILE_RENAME | ChangeEvents::FILE_ADDED;
+		break;
+	}
+	return event & events;
+}
+
 VOID CALLBACK redox::io::DirectoryWatcher::internal::WaitCallback(
 	_In_ PVOID lpParameter, _In_ BOOLEAN TimerOrWaitFired) {
 
 	auto instance = static_cast<DirectoryWatcher*>(lpParameter);
 	auto& internal = *instance->_internal;
-	auto fni = reinterpret_cast<FILE_NOTIFY_INFORMATION*>(internal.buffer.data());
-
-	if (internal.callback) {
-
-		ChangeEvents event{ ChangeEvents::UNKNOWN };
-		if (util::check_flag(fni->Action, FILE_ACTION_ADDED)
-			&& util::check_flag(internal.events, ChangeEvents::FILE_ADDED)) {
-			event |= ChangeEvents::FILE_ADDED;
-		}
-
-		if (util::check_flag(fni->Action, FILE_ACTION_MODIFIED)
-			&& util::check_flag(internal.events, ChangeEvents::FILE_MODIFIED)) {
-			event |= ChangeEvents::FILE_MODIFIED;
-		}
-
-		if (util::check_flag(fni->Action, FILE_ACTION_REMOVED)
-			&& util::check_flag(internal.events, ChangeEvents::FILE_REMOVED)) {
-			event |= ChangeEvents::FILE_REMOVED;
-		}
 
-		if (util::check_flag(fni->Action, FILE_ACTION_RENAMED_OLD_NAME)
-			&& util::check_flag(internal.events, ChangeEvents::FILE_RENAME)) {
-			event |= ChangeEvents::FILE_REMOVED;
-		}
+	DWORD bytes = 0;
+	if (!GetOverlappedResult(internal.directoryHandle, &internal.overlapped, &bytes, FALSE)) {
+		//cancelled by stop()
+		return;
+	}
 
-		if (event != ChangeEvents::UNKNOWN) {
-			WString wstr{ fni->FileName, fni->FileNameLength / sizeof(WCHAR) };
-			Path path(wstr);
-			if (io::is_regular_file(internal.directory / path)) {
-				internal.callback(path, event);
+	Buffer<Change> changes;
+	if (bytes == 0) {
+		//the notification buffer overflowed and the system dropped its contents
+		changes.push_back({ Path(), ChangeEvents::RESCAN });
+	}
+	else {
+		auto cursor = reinterpret_cast<const byte*>(internal.buffer.data());
+		for (;;) {
+			auto fni = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(cursor);
+			auto event = internal.translate(fni->Action);
+
+			if (event != ChangeEvents{}) {
+				Path path(WString{ fni->FileName, fni->FileNameLength / sizeof(WCHAR) });
+				if (!io::is_directory(internal.directory / path)) {
+					_coalesce(changes, std::move(path), event);
+				}
 			}
+
+			if (fni->NextEntryOffset == 0)
+				break;
+			cursor += fni->NextEntryOffset;
 		}
 	}
 
+	//rearm before dispatching so no changes are missed while callbacks run
 	internal.read_changes();
+	instance->_dispatch(changes);
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,89 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "core\core.h"
+#include "timer.h"
+
+#include <thread> //std::this_thread::sleep_for
+
+#ifdef RDX_ARCH_X64
+#ifndef RDX_COMPILER_MSVC
+#include <cpuid.h> //__cpuid_count
+#endif
+
+namespace {
+	struct cpuid_regs { redox::u32 eax, ebx, ecx, edx; };
+
+	cpuid_regs cpuid(redox::u32 leaf) {
+		cpuid_regs r;
+#ifdef RDX_COMPILER_MSVC
+		int regs[4];
+		__cpuidex(regs, static_cast<int>(leaf), 0);
+		r = { static_cast<redox::u32>(regs[0]), static_cast<redox::u32>(regs[1]),
+			static_cast<redox::u32>(regs[2]), static_cast<redox::u32>(regs[3]) };
+#else
+		__cpuid_count(leaf, 0, r.eax, r.ebx, r.ecx, r.edx);
+#endif
+		return r;
+	}
+
+	redox::f64 measure_tsc_frequency(redox::u64 osFrequency) {
+		using namespace redox::platform;
+		const auto os0 = clock::os_ticks();
+		const auto tsc0 = __rdtsc();
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		const auto os1 = clock::os_ticks();
+		const auto tsc1 = __rdtsc();
+
+		return static_cast<redox::f64>(tsc1 - tsc0) * osFrequency / (os1 - os0);
+	}
+}
+#endif
+
+redox::platform::clock::Calibration redox::platform::clock::detail::calibrate() {
+	const auto osFrequency = os_frequency();
+	Calibration c{ Source::Os, false, static_cast<f64>(osFrequency), 0.0, 0.0 };
+
+#ifdef RDX_ARCH_X64
+	const auto maxExt = cpuid(0x80000000).eax;
+	if (maxExt >= 0x80000007 && (cpuid(0x80000007).edx & (1u << 8))) {
+		c.source = Source::Tsc;
+		c.rdtscp = (cpuid(0x80000001).edx & (1u << 27)) != 0;
+
+		//leaf 0x15 reports the tsc/crystal ratio on newer cpus,
+		//everything else is measured against the os clock
+		const auto maxLeaf = cpuid(0).eax;
+		const auto tsc = maxLeaf >= 0x15 ? cpuid(0x15) : cpuid_regs{};
+		if (tsc.eax != 0 && tsc.ebx != 0 && tsc.ecx != 0)
+			c.frequency = static_cast<f64>(tsc.ecx) * tsc.ebx / tsc.eax;
+		else
+			c.frequency = measure_tsc_frequency(osFrequency);
+	}
+#endif
+
+	c.toMs = 1000.0 / c.frequency;
+	c.toNs = 1000000000.0 / c.frequency;
+	return c;
+}
@@ -24,21 +24,104 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #pragma once
-#include "core\core.h"
+#include "core/core.h"
+
+#ifdef RDX_ARCH_X64
+#ifdef RDX_COMPILER_MSVC
+#include <intrin.h> //__rdtsc, __rdtscp
+#else
+#include <x86intrin.h> //__rdtsc, __rdtscp
+#endif
+#endif
 
 namespace redox::platform {
+	namespace clock {
+		enum class Source {
+			Tsc,	//invariant time stamp counter, calibrated against the os clock
+			Os		//QueryPerformanceCounter / CLOCK_MONOTONIC_RAW
+		};
+
+		struct Calibration {
+			Source source;
+			bool rdtscp;
+			f64 frequency;	//ticks per second
+			f64 toMs;
+			f64 toNs;
+		};
+
+		//monotonic os clock, implemented per platform
+		u64 os_ticks();
+		u64 os_frequency();
+
+		namespace detail {
+			Calibration calibrate();
+		}
+
+		//probed once on first use, the tsc is only used if it is invariant
+		RDX_INLINE const Calibration& calibration() {
+			static const Calibration c = detail::calibrate();
+			return c;
+		}
+
+		RDX_INLINE u64 now() {
+#ifdef RDX_ARCH_X64
+			if (calibration().source == Source::Tsc)
+				return __rdtsc();
+#endif
+			return os_ticks();
+		}
+
+		//waits for all previous instructions to retire before sampling,
+		//use it to close a measured region
+		RDX_INLINE u64 now_ordered() {
+#ifdef RDX_ARCH_X64
+			const auto& c = calibration();
+			if (c.source == Source::Tsc && c.rdtscp) {
+				unsigned int aux;
+				return __rdtscp(&aux);
+			}
+#endif
+			return now();
+		}
+
+		RDX_INLINE f64 to_ms(u64 ticks) {
+			return static_cast<f64>(ticks) * calibration().toMs;
+		}
+
+		RDX_INLINE u64 to_ns(u64 ticks) {
+			return static_cast<u64>(static_cast<f64>(ticks) * calibration().toNs);
+		}
+	}
+
 	class Timer {
 	public:
-		Timer();
-		~Timer();
+		RDX_INLINE Timer() : _start(clock::now()) {}
+
+		RDX_INLINE void start() {
+			_start = clock::now();
+		}
+
+		RDX_INLINE void reset() {
+			_start = clock::now();
+		}
+
+		RDX_INLINE u64 ticks() const {
+			return clock::now_ordered() - _start;
+		}
+
+		RDX_INLINE redox::f64 elapsed() const {
+			return clock::to_ms(ticks());
+		}
+
+		RDX_INLINE redox::u64 elapsed_ns() const {
+			return clock::to_ns(ticks());
+		}
 
-		void start();
-		void reset();
-		redox::f64 elapsed() const;
-		redox::f64 freq() const;
+		RDX_INLINE redox::f64 freq() const {
+			return clock::calibration().frequency;
+		}
 
 	private:
-		struct internal;
-		UniquePtr<internal> _internal;
+		u64 _start;
 	};
-}
\ No newline at end of file
+}
@@ -29,34 +29,15 @@ SOFTWARE.
 #include "timer.h"
 #include "windows.h"
 
-struct redox::platform::Timer::internal {
-	LARGE_INTEGER start;
-	LARGE_INTEGER end;
-	LARGE_INTEGER freq;
-};
-
-redox::platform::Timer::Timer() : _internal(std::make_unique<internal>()) {
-	QueryPerformanceFrequency(&_internal->freq);
-}
-
-redox::platform::Timer::~Timer() {
-}
-
-void redox::platform::Timer::start() {
-	QueryPerformanceCounter(&_internal->start);
+redox::u64 redox::platform::clock::os_ticks() {
+	LARGE_INTEGER ticks;
+	QueryPerformanceCounter(&ticks);
+	return static_cast<u64>(ticks.QuadPart);
 }
 
-void redox::platform::Timer::reset() {
-	QueryPerformanceCounter(&_internal->start);
-}
-
-redox::f64 redox::platform::Timer::elapsed() const {
-	QueryPerformanceCounter(&_internal->end);
-	return static_cast<redox::f64>(
-		_internal->end.QuadPart - _internal->start.QuadPart) / _internal->freq.QuadPart * 1000.;
-}
-
-redox::f64 redox::platform::Timer::freq() const {
-	return static_cast<redox::f64>(_internal->freq.QuadPart);
+redox::u64 redox::platform::clock::os_frequency() {
+	LARGE_INTEGER freq;
+	QueryPerformanceFrequency(&freq);
+	return static_cast<u64>(freq.QuadPart);
 }
-#endif
\ No newline at end of file
+#endif
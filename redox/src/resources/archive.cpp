@@ -0,0 +1,246 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "archive.h"
+#include "core\hash.h"
+#include "core\compression\lz4.h"
+#include "core\logging\log.h"
+
+#include <fstream> //std::ofstream
+#include <algorithm> //std::sort
+
+namespace {
+	redox::u32 next_pow2(redox::u32 v) {
+		redox::u32 p = 1;
+		while (p < v)
+			p <<= 1;
+		return p;
+	}
+
+	redox::u64 align_up(redox::u64 v, redox::u64 alignment) {
+		return (v + alignment - 1) & ~(alignment - 1);
+	}
+}
+
+// ResourceArchive
+
+redox::ResourceArchive::ResourceArchive(const Path& file) :
+	_path(file), _file(file, io::MappedFile::Advice::RANDOM) {
+
+	auto bytes = _file.data();
+	if (bytes.size() < sizeof(Header))
+		throw Exception("archive too small");
+
+	_header = reinterpret_cast<const Header*>(bytes.data());
+	if (_header->magic != Magic || _header->version != Version)
+		throw Exception("not a resource archive or unsupported version");
+
+	//a free slot has to remain, otherwise lookups of missing names never end
+	const auto slotCount = _header->slotCount;
+	const u64 tocSize = u64(_header->entryCount) * sizeof(Entry) + u64(slotCount) * sizeof(u32);
+	if ((slotCount & (slotCount - 1)) != 0 || slotCount <= _header->entryCount ||
+		_header->tocOffset + tocSize > bytes.size() ||
+		_header->namesOffset + _header->namesSize > bytes.size()) {
+		throw Exception("archive table of contents is corrupt");
+	}
+
+	_entries = { reinterpret_cast<const Entry*>(bytes.data() + _header->tocOffset), _header->entryCount };
+	_slots = { reinterpret_cast<const u32*>(_entries.end()), slotCount };
+	_names = reinterpret_cast<const char*>(bytes.data() + _header->namesOffset);
+
+	for (const auto& entry : _entries) {
+		if (entry.offset + entry.packedSize > bytes.size() ||
+			u64(entry.nameOffset) + entry.nameLength > _header->namesSize) {
+			throw Exception("archive entry out of bounds");
+		}
+	}
+
+	for (auto index : _slots) {
+		if (index > _header->entryCount)
+			throw Exception("archive table of contents is corrupt");
+	}
+}
+
+const redox::ResourceArchive::Entry* redox::ResourceArchive::find(StringView name) const {
+	if (_slots.empty())
+		return nullptr;
+
+	const auto hash = hash::fnv1a(name);
+	const auto mask = _slots.size() - 1;
+	for (auto slot = hash & mask;; slot = (slot + 1) & mask) {
+		const auto index = _slots[slot];
+		if (index == 0)
+			return nullptr;
+
+		const auto& entry = _entries[index - 1];
+		if (entry.nameHash == hash && this->name(entry) == name)
+			return &entry;
+	}
+}
+
+redox::StringView redox::ResourceArchive::name(const Entry& entry) const {
+	return { _names + entry.nameOffset, entry.nameLength };
+}
+
+redox::Span<const redox::ResourceArchive::Entry> redox::ResourceArchive::entries() const {
+	return _entries;
+}
+
+redox::ResourceArchive::Data redox::ResourceArchive::read(const Entry& entry) const {
+	Data result;
+	result.view = _file.data().subspan(static_cast<std::size_t>(entry.offset),
+		static_cast<std::size_t>(entry.packedSize));
+
+	switch (entry.codec) {
+	case Codec::NONE:
+		_file.advise(io::MappedFile::Advice::WILLNEED,
+			static_cast<std::size_t>(entry.offset), static_cast<std::size_t>(entry.size));
+		break;
+
+	case Codec::LZ4:
+		result.storage.resize(static_cast<std::size_t>(entry.size));
+		if (!compression::lz4::decompress(result.view, result.storage))
+			throw Exception(redox::format("failed to decompress {0}", name(entry)));
+		//the compressed pages are not needed again
+		_file.advise(io::MappedFile::Advice::DONTNEED,
+			static_cast<std::size_t>(entry.offset), static_cast<std::size_t>(entry.packedSize));
+		break;
+
+	default:
+		throw Exception("unsupported archive codec");
+	}
+	return result;
+}
+
+bool redox::ResourceArchive::verify(const Entry& entry) const {
+	auto data = read(entry);
+	auto bytes = data.data();
+	return bytes.size() == entry.size &&
+		hash::xxh64(bytes.data(), bytes.size()) == entry.contentHash;
+}
+
+const redox::Path& redox::ResourceArchive::path() const {
+	return _path;
+}
+
+// ArchiveBuilder
+
+void redox::ArchiveBuilder::add(String name, Buffer<byte> data, Codec codec) {
+	_pending.push_back({ std::move(name), std::move(data), codec });
+}
+
+void redox::ArchiveBuilder::add_file(String name, const Path& file, Codec codec) {
+	io::MappedFile mapped(file, io::MappedFile::Advice::SEQUENTIAL);
+	auto bytes = mapped.data();
+	add(std::move(name), Buffer<byte>(bytes.begin(), bytes.end()), codec);
+}
+
+std::size_t redox::ArchiveBuilder::size() const {
+	return _pending.size();
+}
+
+void redox::ArchiveBuilder::write(const Path& output) {
+	using Entry = ResourceArchive::Entry;
+
+	std::sort(_pending.begin(), _pending.end(), [](const auto& a, const auto& b) {
+		return a.name < b.name;
+	});
+
+	for (std::size_t i = 1; i < _pending.size(); ++i) {
+		if (_pending[i].name == _pending[i - 1].name)
+			throw Exception(redox::format("duplicate archive entry {0}", _pending[i].name));
+	}
+
+	std::ofstream file(output, std::ios::binary | std::ios::trunc);
+	if (!file)
+		throw Exception("failed to create archive");
+
+	auto write_at = [&file](u64 offset, const void* data, std::size_t size) {
+		file.seekp(static_cast<std::streamoff>(offset));
+		file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+	};
+
+	Buffer<Entry> entries;
+	String names;
+	u64 offset = ResourceArchive::Alignment;
+
+	for (const auto& item : _pending) {
+		Entry entry{};
+		entry.nameHash = hash::fnv1a(item.name);
+		entry.contentHash = hash::xxh64(item.data.data(), item.data.size());
+		entry.size = item.data.size();
+		entry.nameOffset = static_cast<u32>(names.size());
+		entry.nameLength = static_cast<u32>(item.name.size());
+		entry.offset = offset;
+		names += item.name;
+
+		Buffer<byte> packed;
+		if (item.codec == Codec::LZ4)
+			compression::lz4::compress(item.data, packed);
+
+		//entries that do not shrink are stored raw
+		if (!packed.empty() && packed.size() < item.data.size()) {
+			entry.codec = Codec::LZ4;
+			entry.packedSize = packed.size();
+			write_at(offset, packed.data(), packed.size());
+		}
+		else {
+			entry.codec = Codec::NONE;
+			entry.packedSize = item.data.size();
+			write_at(offset, item.data.data(), item.data.size());
+		}
+
+		offset = align_up(offset + entry.packedSize, ResourceArchive::Alignment);
+		entries.push_back(entry);
+	}
+
+	Buffer<u32> slots(next_pow2(std::max<u32>(1, static_cast<u32>(entries.size()) * 2)), 0);
+	const auto mask = slots.size() - 1;
+	for (std::size_t i = 0; i < entries.size(); ++i) {
+		auto slot = entries[i].nameHash & mask;
+		while (slots[slot] != 0)
+			slot = (slot + 1) & mask;
+		slots[slot] = static_cast<u32>(i + 1);
+	}
+
+	ResourceArchive::Header header{};
+	header.magic = ResourceArchive::Magic;
+	header.version = ResourceArchive::Version;
+	header.entryCount = static_cast<u32>(entries.size());
+	header.slotCount = static_cast<u32>(slots.size());
+	header.tocOffset = offset;
+	header.namesOffset = offset + entries.size() * sizeof(Entry) + slots.size() * sizeof(u32);
+	header.namesSize = names.size();
+
+	write_at(header.tocOffset, entries.data(), entries.size() * sizeof(Entry));
+	write_at(header.tocOffset + entries.size() * sizeof(Entry), slots.data(), slots.size() * sizeof(u32));
+	write_at(header.namesOffset, names.data(), names.size());
+	write_at(0, &header, sizeof(header));
+
+	if (!file.flush())
+		throw Exception("failed to write archive");
+
+	RDX_LOG("Packed {0} entries into {1}", entries.size(), output);
+}
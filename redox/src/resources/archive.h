@@ -0,0 +1,119 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include <core/core.h>
+#include <core/non_copyable.h>
+#include <platform/filesystem.h>
+
+namespace redox {
+	//packed resources (.rpak). entries are stored 4K aligned behind a fixed header,
+	//the table of contents and a name blob follow the data. names are resolved through
+	//an open addressed hash table stored in the file, so lookups never touch the
+	//filesystem and uncompressed entries are served straight from the mapping.
+	class ResourceArchive : public NonCopyable {
+	public:
+		enum class Codec : u32 {
+			NONE, LZ4
+		};
+
+		struct Header {
+			u32 magic;
+			u32 version;
+			u32 entryCount;
+			u32 slotCount;		//power of two above entryCount, holds entry index + 1, 0 marks a free slot
+			u64 tocOffset;		//Entry[entryCount], then u32[slotCount]
+			u64 namesOffset;
+			u64 namesSize;
+		};
+
+		struct Entry {
+			u64 nameHash;
+			u64 contentHash;	//xxh64 of the decompressed bytes
+			u64 offset;
+			u64 packedSize;
+			u64 size;
+			u32 nameOffset;
+			u32 nameLength;
+			Codec codec;
+			u32 reserved;
+		};
+
+		//bytes of one entry, either a view into the mapping or decompressed storage
+		struct Data {
+			Span<const byte> view;
+			Buffer<byte> storage;
+
+			Span<const byte> data() const {
+				return storage.empty() ? view : Span<const byte>(storage);
+			}
+		};
+
+		static constexpr u32 Magic = 0x4b415052; //"RPAK"
+		static constexpr u32 Version = 1;
+		static constexpr u64 Alignment = 4096;
+
+		explicit ResourceArchive(const Path& file);
+
+		//names are generic paths relative to the packed root
+		const Entry* find(StringView name) const;
+		StringView name(const Entry& entry) const;
+		Span<const Entry> entries() const;
+
+		Data read(const Entry& entry) const;
+		bool verify(const Entry& entry) const;
+
+		const Path& path() const;
+
+	private:
+		Path _path;
+		io::MappedFile _file;
+		const Header* _header = nullptr;
+		Span<const Entry> _entries;
+		Span<const u32> _slots;
+		const char* _names = nullptr;
+	};
+
+	class ArchiveBuilder {
+	public:
+		using Codec = ResourceArchive::Codec;
+
+		void add(String name, Buffer<byte> data, Codec codec = Codec::LZ4);
+		void add_file(String name, const Path& file, Codec codec = Codec::LZ4);
+		std::size_t size() const;
+
+		//entries are written sorted by name, so identical inputs produce identical archives
+		void write(const Path& output);
+
+	private:
+		struct pending {
+			String name;
+			Buffer<byte> data;
+			Codec codec;
+		};
+
+		Buffer<pending> _pending;
+	};
+}
@@ -0,0 +1,261 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "derived_data_cache.h"
+#include <core/logging/log.h>
+
+#include <algorithm> //std::sort, std::min_element
+#include <fstream> //std::ofstream
+#include <thread> //std::this_thread
+#include <chrono> //std::chrono::hours
+
+namespace {
+	constexpr redox::StringView ArtifactExt = ".ddc";
+	constexpr redox::StringView StagingExt = ".tmp";
+	//staging files untouched for this long belong to a writer that crashed,
+	//younger ones may still be written by another process sharing the cache
+	constexpr std::chrono::hours StagingExpiry{ 1 };
+
+	redox::String to_hex(redox::u64 value) {
+		constexpr char digits[] = "0123456789abcdef";
+		redox::String hex(16, '0');
+		for (auto i = 16; i-- > 0; value >>= 4)
+			hex[i] = digits[value & 0xf];
+		return hex;
+	}
+
+	bool from_hex(const redox::String& hex, redox::u64& value) {
+		if (hex.size() != 16)
+			return false;
+
+		value = 0;
+		for (auto c : hex) {
+			if (c >= '0' && c <= '9') value = (value << 4) | redox::u64(c - '0');
+			else if (c >= 'a' && c <= 'f') value = (value << 4) | redox::u64(c - 'a' + 10);
+			else return false;
+		}
+		return true;
+	}
+}
+
+redox::DerivedDataCache::DerivedDataCache(const Path& directory, u64 capacity) :
+	_directory(directory),
+	_capacity(capacity) {
+
+	std::error_code ec;
+	io::create_directories(_directory, ec);
+	if (ec)
+		throw Exception("failed to create derived data directory");
+
+	struct found {
+		key_type key;
+		u64 size;
+		io::file_time_type time;
+	};
+	Buffer<found> artifacts;
+
+	const auto now = io::file_time_type::clock::now();
+	for (const auto& file : io::directory_iterator(_directory, ec)) {
+		const auto& path = file.path();
+		if (path.extension() == StagingExt) {
+			std::error_code timeError;
+			const auto written = file.last_write_time(timeError);
+			if (!timeError && now - written > StagingExpiry)
+				io::remove(path, ec);
+			continue;
+		}
+
+		key_type key;
+		if (path.extension() != ArtifactExt || !from_hex(path.stem().string(), key))
+			continue;
+
+		artifacts.push_back({ key, file.file_size(ec), file.last_write_time(ec) });
+	}
+
+	//hits touch the file time, so it orders the entries of earlier runs
+	std::sort(artifacts.begin(), artifacts.end(), [](const found& a, const found& b) {
+		return a.time < b.time;
+	});
+
+	for (const auto& artifact : artifacts) {
+		_entries[artifact.key] = { artifact.size, ++_clock };
+		_size += artifact.size;
+	}
+
+	if (_size > _capacity) {
+		RDX_UNUSED(std::lock_guard(_mutex));
+		_trim(0);
+	}
+}
+
+redox::DerivedDataCache::key_type redox::DerivedDataCache::make_key(Span<const byte> source, StringView tool, StringView options) {
+	auto key = hash::xxh64(source.data(), source.size());
+	key = hash::combine(key, hash::fnv1a(tool));
+	return hash::combine(key, hash::fnv1a(options));
+}
+
+redox::DerivedDataCache::key_type redox::DerivedDataCache::make_key(const Path& source, StringView tool, StringView options) {
+	io::MappedFile file(source, io::MappedFile::Advice::SEQUENTIAL);
+	return make_key(file.data(), tool, options);
+}
+
+redox::DerivedDataCache::key_type redox::DerivedDataCache::combine(key_type key, const Path& input) {
+	io::MappedFile file(input, io::MappedFile::Advice::SEQUENTIAL);
+	return hash::combine(key, hash::xxh64(file.data().data(), file.size()));
+}
+
+std::optional<redox::Path> redox::DerivedDataCache::find(key_type key) {
+	{
+		RDX_UNUSED(std::lock_guard(_mutex));
+		auto it = _entries.find(key);
+		if (it == _entries.end())
+			return std::nullopt;
+		it->second.lastUse = ++_clock;
+	}
+
+	//persists the recency for the next run, failing to do so only costs accuracy
+	auto artifact = _artifact(key);
+	std::error_code ec;
+	io::last_write_time(artifact, io::file_time_type::clock::now(), ec);
+	return artifact;
+}
+
+redox::UniquePtr<redox::io::MappedFile> redox::DerivedDataCache::map(key_type key, io::MappedFile::Advice advice) {
+	auto artifact = _artifact(key);
+	UniquePtr<io::MappedFile> file;
+	{
+		//trims hold the lock as well, once mapped the contents stay readable even if removed
+		RDX_UNUSED(std::lock_guard(_mutex));
+		auto it = _entries.find(key);
+		if (it == _entries.end())
+			return nullptr;
+
+		try {
+			file = make_unique<io::MappedFile>(artifact, advice);
+		}
+		catch (const Exception&) {
+			_size -= it->second.size;
+			_entries.erase(it);
+			return nullptr;
+		}
+		it->second.lastUse = ++_clock;
+	}
+
+	std::error_code ec;
+	io::last_write_time(artifact, io::file_time_type::clock::now(), ec);
+	return file;
+}
+
+redox::Path redox::DerivedDataCache::store(key_type key, Span<const byte> data) {
+	auto staged = _staging(key);
+	{
+		std::ofstream stream(staged, std::ios::binary | std::ios::trunc);
+		stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+		if (!stream)
+			throw Exception("failed to write derived data");
+	}
+	return _publish(key, staged);
+}
+
+redox::Path redox::DerivedDataCache::store(key_type key, FunctionRef<void(const Path& output)> produce) {
+	auto staged = _staging(key);
+	try {
+		produce(staged);
+	}
+	catch (...) {
+		std::error_code ec;
+		io::remove(staged, ec);
+		throw;
+	}
+	return _publish(key, staged);
+}
+
+redox::u64 redox::DerivedDataCache::size() const {
+	RDX_UNUSED(std::lock_guard(_mutex));
+	return _size;
+}
+
+redox::u64 redox::DerivedDataCache::capacity() const {
+	return _capacity;
+}
+
+const redox::Path& redox::DerivedDataCache::directory() const {
+	return _directory;
+}
+
+redox::Path redox::DerivedDataCache::_artifact(key_type key) const {
+	return _directory / (to_hex(key) + String(ArtifactExt));
+}
+
+redox::Path redox::DerivedDataCache::_staging(key_type key) {
+	//unique per writer, two threads or processes may produce the same key at once
+	const auto writer = hash::combine(std::hash<std::thread::id>{}(std::this_thread::get_id()),
+		hash::combine(reinterpret_cast<std::uintptr_t>(this), _stagingCounter++));
+	return _directory / (to_hex(key) + "." + to_hex(writer) + String(StagingExt));
+}
+
+redox::Path redox::DerivedDataCache::_publish(key_type key, const Path& staged) {
+	std::error_code ec;
+	const auto size = io::file_size(staged, ec);
+	if (ec) {
+		io::remove(staged, ec);
+		throw Exception("failed to stage derived data");
+	}
+
+	auto artifact = _artifact(key);
+	RDX_UNUSED(std::lock_guard(_mutex));
+
+	//rename replaces an artifact published concurrently for the same key
+	io::rename(staged, artifact, ec);
+	if (ec) {
+		io::remove(staged, ec);
+		throw Exception("failed to publish derived data");
+	}
+
+	auto& entry = _entries[key];
+	_size = _size - entry.size + size;
+	entry = { size, ++_clock };
+
+	_trim(key);
+	return artifact;
+}
+
+void redox::DerivedDataCache::_trim(key_type keep) {
+	while (_size > _capacity && _entries.size() > 1) {
+		auto oldest = std::min_element(_entries.begin(), _entries.end(), [keep](const auto& a, const auto& b) {
+			//the artifact just published is never the victim
+			if (a.first == keep) return false;
+			if (b.first == keep) return true;
+			return a.second.lastUse < b.second.lastUse;
+		});
+
+		//artifacts still mapped elsewhere may refuse removal on some platforms,
+		//they are forgotten here and picked up again by the next scan
+		std::error_code ec;
+		io::remove(_artifact(oldest->first), ec);
+		_size -= oldest->second.size;
+		_entries.erase(oldest);
+	}
+}
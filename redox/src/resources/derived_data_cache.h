@@ -0,0 +1,92 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include <core/core.h>
+#include <core/non_copyable.h>
+#include <core/hash.h>
+#include <platform/filesystem.h>
+
+#include <mutex> //std::mutex
+#include <atomic> //std::atomic
+#include <optional> //std::optional
+
+namespace redox {
+	//artifacts derived from source files (SPIR-V, cooked meshes and textures) kept on disk
+	//across runs. entries are keyed by the content of their inputs, so renames and touched
+	//files still hit while edits and tool upgrades miss. the least recently used entries
+	//are evicted once the directory grows past its capacity. safe to use from any thread.
+	class DerivedDataCache : public NonCopyable {
+	public:
+		using key_type = hash::hash_type;
+
+		//picks up the artifacts of earlier runs in directory, capacity is in bytes
+		DerivedDataCache(const Path& directory, u64 capacity);
+
+		//tool names the producer and its output version, options everything else the
+		//output depends on. bump the version whenever the artifact format changes.
+		static key_type make_key(Span<const byte> source, StringView tool, StringView options = "");
+		static key_type make_key(const Path& source, StringView tool, StringView options = "");
+		//folds another input, e.g. a buffer referenced by the source, into a key
+		static key_type combine(key_type key, const Path& input);
+
+		//path of a cached artifact, marks it as most recently used. the artifact may be
+		//evicted before the caller opens it, prefer map to read it
+		std::optional<Path> find(key_type key);
+		//maps a cached artifact before it can be evicted, marks it as most recently used.
+		//an artifact removed by another process counts as a miss
+		UniquePtr<io::MappedFile> map(key_type key, io::MappedFile::Advice advice = io::MappedFile::Advice::NORMAL);
+
+		//writes to a staging file first and renames it into place,
+		//readers never observe a partially written artifact
+		Path store(key_type key, Span<const byte> data);
+		//for tools that write their output themselves, produce receives the staging path
+		Path store(key_type key, FunctionRef<void(const Path& output)> produce);
+
+		u64 size() const;
+		u64 capacity() const;
+		const Path& directory() const;
+
+	private:
+		struct entry {
+			u64 size;
+			u64 lastUse;
+		};
+
+		Path _artifact(key_type key) const;
+		Path _staging(key_type key);
+		Path _publish(key_type key, const Path& staged);
+		void _trim(key_type keep);
+
+		Path _directory;
+		u64 _capacity;
+
+		mutable std::mutex _mutex;
+		Hashmap<key_type, entry> _entries;
+		u64 _size = 0;
+		u64 _clock = 0;
+		std::atomic<u64> _stagingCounter = 0;
+	};
+}
@@ -0,0 +1,263 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "accessor_decoder.h"
+#include "math\simd.h"
+
+#include <cstring> //std::memcpy, std::memset
+#include <algorithm> //std::max
+#include <limits> //std::numeric_limits
+#include <type_traits> //std::is_same_v, std::is_signed_v
+
+namespace {
+	using namespace redox;
+	using gltf::AccessorView;
+	using gltf::SparseView;
+	using gltf::ComponentType;
+
+	template<class C>
+	constexpr f32 normalize_scale() {
+		return 1.0f / static_cast<f32>(std::numeric_limits<C>::max());
+	}
+
+	template<class C>
+	RDX_INLINE f32 to_float(C value, bool normalized) {
+		if constexpr (std::is_same_v<C, f32>)
+			return value;
+		else if constexpr (std::is_signed_v<C>)
+			return normalized ? std::max(value * normalize_scale<C>(), -1.0f) : static_cast<f32>(value);
+		else
+			return normalized ? value * normalize_scale<C>() : static_cast<f32>(value);
+	}
+
+	//widens four components starting at source to f32 lanes
+	template<class C>
+	RDX_INLINE simd::f32x4 load_wide(const byte* source) {
+		if constexpr (std::is_same_v<C, f32>) {
+			return _mm_loadu_ps(reinterpret_cast<const f32*>(source));
+		}
+		else if constexpr (sizeof(C) == 1) {
+			i32 packed;
+			std::memcpy(&packed, source, sizeof(packed));
+			const auto raw = _mm_cvtsi32_si128(packed);
+			return _mm_cvtepi32_ps(std::is_signed_v<C> ? _mm_cvtepi8_epi32(raw) : _mm_cvtepu8_epi32(raw));
+		}
+		else {
+			const auto raw = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source));
+			return _mm_cvtepi32_ps(std::is_signed_v<C> ? _mm_cvtepi16_epi32(raw) : _mm_cvtepu16_epi32(raw));
+		}
+	}
+
+	//same as load_wide, but never reads past the element
+	template<class C>
+	RDX_INLINE simd::f32x4 load_element(const byte* source, std::size_t size) {
+		alignas(16) byte lanes[16]{};
+		std::memcpy(lanes, source, size);
+		return load_wide<C>(lanes);
+	}
+
+	template<class C>
+	void decode_floats_scalar(const AccessorView& accessor, f32* output) {
+		auto source = accessor.data;
+		for (std::size_t i = 0; i < accessor.count; i++, source += accessor.stride) {
+			for (u32 c = 0; c < accessor.components; c++) {
+				C value;
+				std::memcpy(&value, source + c * sizeof(C), sizeof(C));
+				*output++ = to_float(value, accessor.normalized);
+			}
+		}
+	}
+
+	template<class C, u32 N>
+	void decode_floats(const AccessorView& accessor, f32* output) {
+		constexpr auto elementSize = N * sizeof(C);
+
+		if constexpr (std::is_same_v<C, f32>) {
+			if (accessor.stride == elementSize) {
+				std::memcpy(output, accessor.data, accessor.count * elementSize);
+				return;
+			}
+		}
+
+		auto scale = simd::set_all(1.0f);
+		auto lower = simd::set_all(std::numeric_limits<f32>::lowest());
+		if constexpr (!std::is_same_v<C, f32>) {
+			if (accessor.normalized) {
+				scale = simd::set_all(normalize_scale<C>());
+				if constexpr (std::is_signed_v<C>)
+					lower = simd::set_all(-1.0f);
+			}
+		}
+
+		auto source = accessor.data;
+		const auto total = accessor.count * N;
+		const auto end = accessor.data + (accessor.count - 1) * accessor.stride + elementSize;
+		std::size_t i = 0;
+
+		//full width loads and stores spill into the neighbouring element. reads stay
+		//inside the accessor, writes get overwritten by the next iteration.
+		for (; i < accessor.count && i * N + 4 <= total && source + 4 * sizeof(C) <= end;
+			i++, source += accessor.stride, output += N) {
+			_mm_storeu_ps(output, _mm_max_ps(simd::mul(load_wide<C>(source), scale), lower));
+		}
+
+		for (; i < accessor.count; i++, source += accessor.stride, output += N) {
+			alignas(16) f32 lanes[4];
+			_mm_store_ps(lanes, _mm_max_ps(simd::mul(load_element<C>(source, elementSize), scale), lower));
+			std::memcpy(output, lanes, N * sizeof(f32));
+		}
+	}
+
+	template<class C>
+	void decode_floats(const AccessorView& accessor, f32* output) {
+		switch (accessor.components) {
+		case 1: return decode_floats<C, 1>(accessor, output);
+		case 2: return decode_floats<C, 2>(accessor, output);
+		case 3: return decode_floats<C, 3>(accessor, output);
+		case 4: return decode_floats<C, 4>(accessor, output);
+		default: return decode_floats_scalar<C>(accessor, output);
+		}
+	}
+
+	template<class C, class T>
+	void decode_integers(const AccessorView& accessor, T* output) {
+		if constexpr (std::is_same_v<C, T>) {
+			if (accessor.stride == sizeof(C) * accessor.components) {
+				std::memcpy(output, accessor.data, accessor.count * accessor.element_size());
+				return;
+			}
+		}
+
+		C largest = 0;
+		auto source = accessor.data;
+		for (std::size_t i = 0; i < accessor.count; i++, source += accessor.stride) {
+			for (u32 c = 0; c < accessor.components; c++) {
+				C value;
+				std::memcpy(&value, source + c * sizeof(C), sizeof(C));
+				largest = std::max(largest, value);
+				*output++ = static_cast<T>(value);
+			}
+		}
+
+		if constexpr (sizeof(C) > sizeof(T)) {
+			if (largest > std::numeric_limits<T>::max())
+				throw Exception("accessor value exceeds output type");
+		}
+	}
+
+	template<class T>
+	void decode_dense(const AccessorView& accessor, T* output) {
+		if (accessor.count == 0)
+			return;
+
+		if (accessor.data == nullptr) {
+			std::memset(output, 0, accessor.count * accessor.components * sizeof(T));
+			return;
+		}
+
+		if constexpr (std::is_same_v<T, f32>) {
+			switch (accessor.type) {
+			case ComponentType::I8: return decode_floats<int8_t>(accessor, output);
+			case ComponentType::U8: return decode_floats<u8>(accessor, output);
+			case ComponentType::I16: return decode_floats<int16_t>(accessor, output);
+			case ComponentType::U16: return decode_floats<uint16_t>(accessor, output);
+			case ComponentType::U32: return decode_floats_scalar<u32>(accessor, output);
+			case ComponentType::F32: return decode_floats<f32>(accessor, output);
+			}
+		}
+		else {
+			switch (accessor.type) {
+			case ComponentType::U8: return decode_integers<u8>(accessor, output);
+			case ComponentType::U16: return decode_integers<uint16_t>(accessor, output);
+			case ComponentType::U32: return decode_integers<u32>(accessor, output);
+			default: throw Exception("unsupported integer component type");
+			}
+		}
+	}
+
+	u32 read_index(const byte* source, ComponentType type) {
+		switch (type) {
+		case ComponentType::U8: return *source;
+		case ComponentType::U16: {
+			uint16_t value;
+			std::memcpy(&value, source, sizeof(value));
+			return value;
+		}
+		case ComponentType::U32: {
+			u32 value;
+			std::memcpy(&value, source, sizeof(value));
+			return value;
+		}
+		default:
+			throw Exception("unsupported sparse index type");
+		}
+	}
+
+	template<class T>
+	void decode(const AccessorView& accessor, T* output, const SparseView* sparse) {
+		decode_dense(accessor, output);
+		if (sparse == nullptr)
+			return;
+
+		AccessorView values = accessor;
+		values.count = 1;
+		values.stride = accessor.element_size();
+
+		const auto indexSize = gltf::component_size(sparse->indexType);
+		for (std::size_t i = 0; i < sparse->count; i++) {
+			const auto index = read_index(sparse->indices + i * indexSize, sparse->indexType);
+			if (index >= accessor.count)
+				throw Exception("sparse index out of range");
+
+			values.data = sparse->values + i * values.stride;
+			decode_dense(values, output + index * accessor.components);
+		}
+	}
+}
+
+std::size_t redox::gltf::component_size(ComponentType type) {
+	switch (type) {
+	case ComponentType::I8:
+	case ComponentType::U8:
+		return 1;
+	case ComponentType::I16:
+	case ComponentType::U16:
+		return 2;
+	default:
+		return 4;
+	}
+}
+
+void redox::gltf::decode(const AccessorView& accessor, f32* output, const SparseView* sparse) {
+	::decode(accessor, output, sparse);
+}
+
+void redox::gltf::decode(const AccessorView& accessor, uint16_t* output, const SparseView* sparse) {
+	::decode(accessor, output, sparse);
+}
+
+void redox::gltf::decode(const AccessorView& accessor, u32* output, const SparseView* sparse) {
+	::decode(accessor, output, sparse);
+}
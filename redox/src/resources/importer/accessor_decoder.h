@@ -0,0 +1,66 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include "core\core.h"
+
+namespace redox::gltf {
+	enum class ComponentType {
+		I8, U8, I16, U16, U32, F32
+	};
+
+	std::size_t component_size(ComponentType type);
+
+	//an accessor resolved to raw memory: count elements of components values each,
+	//stride bytes apart. data may be null, in which case the elements read as zero
+	//(sparse accessors without a buffer view)
+	struct AccessorView {
+		const byte* data = nullptr;
+		std::size_t count = 0;
+		std::size_t stride = 0;
+		u32 components = 1;
+		ComponentType type = ComponentType::F32;
+		bool normalized = false;
+
+		std::size_t element_size() const {
+			return components * component_size(type);
+		}
+	};
+
+	//sparse substitution: values are tightly packed elements in the layout of the accessor
+	struct SparseView {
+		std::size_t count = 0;
+		const byte* indices = nullptr;
+		ComponentType indexType = ComponentType::U32;
+		const byte* values = nullptr;
+	};
+
+	//bulk decoders writing count * components values into preallocated output.
+	//tightly packed runs of the output type are copied as is; everything else is
+	//converted element by element without per value dispatch.
+	void decode(const AccessorView& accessor, f32* output, const SparseView* sparse = nullptr);
+	void decode(const AccessorView& accessor, uint16_t* output, const SparseView* sparse = nullptr);
+	void decode(const AccessorView& accessor, u32* output, const SparseView* sparse = nullptr);
+}
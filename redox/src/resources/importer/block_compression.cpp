@@ -0,0 +1,491 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "block_compression.h"
+#include "core\concurrency\worker_pool.h"
+
+#include <cstring> //std::memcpy
+#include <cmath> //std::abs, std::lround
+#include <algorithm> //std::min, std::max, std::swap
+#include <limits> //std::numeric_limits
+
+namespace {
+	using redox::u8;
+	using redox::u32;
+	using redox::u64;
+	using redox::f32;
+	using redox::byte;
+
+	constexpr u32 PixelsPerBlock = 16;
+
+	//principal axis of the block in the first dims channels, the endpoints
+	//are the extreme projections onto it
+	void fit_endpoints(const u8* rgba, u32 dims, f32* lower, f32* upper) {
+		f32 mean[4]{};
+		for (u32 p = 0; p < PixelsPerBlock; p++)
+			for (u32 c = 0; c < dims; c++)
+				mean[c] += rgba[p * 4 + c];
+		for (u32 c = 0; c < dims; c++)
+			mean[c] /= PixelsPerBlock;
+
+		f32 covariance[4][4]{};
+		for (u32 p = 0; p < PixelsPerBlock; p++) {
+			for (u32 i = 0; i < dims; i++) {
+				for (u32 j = 0; j < dims; j++)
+					covariance[i][j] += (rgba[p * 4 + i] - mean[i]) * (rgba[p * 4 + j] - mean[j]);
+			}
+		}
+
+		f32 axis[4] = { 1, 1, 1, 1 };
+		for (u32 iteration = 0; iteration < 8; iteration++) {
+			f32 next[4]{};
+			f32 length = 0.0f;
+			for (u32 i = 0; i < dims; i++) {
+				for (u32 j = 0; j < dims; j++)
+					next[i] += covariance[i][j] * axis[j];
+				length = std::max(length, std::abs(next[i]));
+			}
+			if (length == 0.0f)
+				break;
+			for (u32 i = 0; i < dims; i++)
+				axis[i] = next[i] / length;
+		}
+
+		f32 tmin = std::numeric_limits<f32>::max();
+		f32 tmax = std::numeric_limits<f32>::lowest();
+		for (u32 p = 0; p < PixelsPerBlock; p++) {
+			f32 t = 0.0f;
+			for (u32 c = 0; c < dims; c++)
+				t += (rgba[p * 4 + c] - mean[c]) * axis[c];
+			tmin = std::min(tmin, t);
+			tmax = std::max(tmax, t);
+		}
+
+		f32 norm = 0.0f;
+		for (u32 c = 0; c < dims; c++)
+			norm += axis[c] * axis[c];
+		if (norm == 0.0f)
+			tmin = tmax = norm = 1.0f;
+
+		for (u32 c = 0; c < dims; c++) {
+			lower[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * tmin / norm));
+			upper[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * tmax / norm));
+		}
+	}
+
+	template<class Palette>
+	u32 nearest(const u8* pixel, u32 dims, const Palette& palette, u32 count, u32* error = nullptr) {
+		u32 best = 0;
+		u32 bestError = std::numeric_limits<u32>::max();
+		for (u32 i = 0; i < count; i++) {
+			u32 e = 0;
+			for (u32 c = 0; c < dims; c++) {
+				const int d = int(pixel[c]) - int(palette[i][c]);
+				e += static_cast<u32>(d * d);
+			}
+			if (e < bestError) {
+				bestError = e;
+				best = i;
+			}
+		}
+		if (error)
+			*error += bestError;
+		return best;
+	}
+
+	// BC1
+
+	uint16_t pack_565(const f32* rgb) {
+		const auto r = static_cast<uint16_t>(std::lround(rgb[0] * 31.0f / 255.0f));
+		const auto g = static_cast<uint16_t>(std::lround(rgb[1] * 63.0f / 255.0f));
+		const auto b = static_cast<uint16_t>(std::lround(rgb[2] * 31.0f / 255.0f));
+		return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+	}
+
+	void unpack_565(uint16_t c, u8* rgb) {
+		const u32 r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+		rgb[0] = static_cast<u8>((r << 3) | (r >> 2));
+		rgb[1] = static_cast<u8>((g << 2) | (g >> 4));
+		rgb[2] = static_cast<u8>((b << 3) | (b >> 2));
+	}
+
+	void bc1_palette(uint16_t c0, uint16_t c1, bool fourColor, u8 (&palette)[4][4]) {
+		unpack_565(c0, palette[0]);
+		unpack_565(c1, palette[1]);
+		for (u32 c = 0; c < 3; c++) {
+			if (fourColor) {
+				palette[2][c] = static_cast<u8>((2 * palette[0][c] + palette[1][c]) / 3);
+				palette[3][c] = static_cast<u8>((palette[0][c] + 2 * palette[1][c]) / 3);
+			}
+			else {
+				palette[2][c] = static_cast<u8>((palette[0][c] + palette[1][c]) / 2);
+				palette[3][c] = 0;
+			}
+		}
+		palette[0][3] = palette[1][3] = palette[2][3] = 255;
+		palette[3][3] = fourColor ? 255 : 0;
+	}
+
+	void encode_bc1(const u8* rgba, byte* output) {
+		f32 lower[3], upper[3];
+		fit_endpoints(rgba, 3, lower, upper);
+
+		auto c0 = pack_565(upper);
+		auto c1 = pack_565(lower);
+		if (c0 < c1)
+			std::swap(c0, c1);
+
+		//equal endpoints select the three color mode, index 0 still means c0
+		u32 indices = 0;
+		if (c0 != c1) {
+			u8 palette[4][4];
+			bc1_palette(c0, c1, true, palette);
+			for (u32 p = 0; p < PixelsPerBlock; p++)
+				indices |= nearest(rgba + p * 4, 3, palette, 4) << (p * 2);
+		}
+
+		std::memcpy(output, &c0, 2);
+		std::memcpy(output + 2, &c1, 2);
+		std::memcpy(output + 4, &indices, 4);
+	}
+
+	void decode_bc1(const byte* block, u8* rgba, bool alwaysFourColor) {
+		uint16_t c0, c1;
+		u32 indices;
+		std::memcpy(&c0, block, 2);
+		std::memcpy(&c1, block + 2, 2);
+		std::memcpy(&indices, block + 4, 4);
+
+		u8 palette[4][4];
+		bc1_palette(c0, c1, alwaysFourColor || c0 > c1, palette);
+		for (u32 p = 0; p < PixelsPerBlock; p++)
+			std::memcpy(rgba + p * 4, palette[(indices >> (p * 2)) & 3], 4);
+	}
+
+	// BC4, one channel of BC3 and BC5
+
+	void bc4_palette(u8 a0, u8 a1, u8 (&palette)[8]) {
+		palette[0] = a0;
+		palette[1] = a1;
+		if (a0 > a1) {
+			for (u32 i = 2; i < 8; i++)
+				palette[i] = static_cast<u8>(((8 - i) * a0 + (i - 1) * a1) / 7);
+		}
+		else {
+			for (u32 i = 2; i < 6; i++)
+				palette[i] = static_cast<u8>(((6 - i) * a0 + (i - 1) * a1) / 5);
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	void encode_bc4(const u8* rgba, u32 channel, byte* output) {
+		u8 a0 = 0, a1 = 255;
+		for (u32 p = 0; p < PixelsPerBlock; p++) {
+			a0 = std::max(a0, rgba[p * 4 + channel]);
+			a1 = std::min(a1, rgba[p * 4 + channel]);
+		}
+
+		u64 bits = u64(a0) | (u64(a1) << 8);
+		if (a0 != a1) {
+			u8 palette[8];
+			bc4_palette(a0, a1, palette);
+			for (u32 p = 0; p < PixelsPerBlock; p++) {
+				u32 best = 0;
+				int bestError = 256;
+				for (u32 i = 0; i < 8; i++) {
+					const int e = std::abs(int(rgba[p * 4 + channel]) - int(palette[i]));
+					if (e < bestError) {
+						bestError = e;
+						best = i;
+					}
+				}
+				bits |= u64(best) << (16 + p * 3);
+			}
+		}
+		std::memcpy(output, &bits, 8);
+	}
+
+	void decode_bc4(const byte* block, u32 channel, u8* rgba) {
+		u64 bits;
+		std::memcpy(&bits, block, 8);
+
+		u8 palette[8];
+		bc4_palette(static_cast<u8>(bits), static_cast<u8>(bits >> 8), palette);
+		for (u32 p = 0; p < PixelsPerBlock; p++)
+			rgba[p * 4 + channel] = palette[(bits >> (16 + p * 3)) & 7];
+	}
+
+	// BC7, mode 6 only: one subset, rgba 7.7.7.7 endpoints with a p-bit each, 4 bit indices
+
+	constexpr u32 Bc7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	struct bit_stream {
+		byte* data;
+		u32 position = 0;
+
+		void write(u32 value, u32 count) {
+			for (u32 i = 0; i < count; i++, position++) {
+				if (value & (1u << i))
+					data[position / 8] = static_cast<byte>(u32(data[position / 8]) | (1u << (position % 8)));
+			}
+		}
+	};
+
+	struct bit_reader {
+		const byte* data;
+		u32 position = 0;
+
+		u32 read(u32 count) {
+			u32 value = 0;
+			for (u32 i = 0; i < count; i++, position++)
+				value |= ((u32(data[position / 8]) >> (position % 8)) & 1u) << i;
+			return value;
+		}
+	};
+
+	void bc7_palette(const u8 (&endpoints)[2][4], u8 (&palette)[16][4]) {
+		for (u32 i = 0; i < 16; i++) {
+			for (u32 c = 0; c < 4; c++) {
+				palette[i][c] = static_cast<u8>(((64 - Bc7Weights[i]) * endpoints[0][c] +
+					Bc7Weights[i] * endpoints[1][c] + 32) >> 6);
+			}
+		}
+	}
+
+	void encode_bc7(const u8* rgba, byte* output) {
+		f32 lower[4], upper[4];
+		fit_endpoints(rgba, 4, lower, upper);
+
+		u8 best[2][4]{};
+		u32 bestIndices[PixelsPerBlock]{};
+		u32 bestError = std::numeric_limits<u32>::max();
+		u32 bestPbits = 0;
+
+		//each endpoint shares its lowest bit over all channels, try every combination
+		for (u32 pbits = 0; pbits < 4; pbits++) {
+			u8 endpoints[2][4];
+			for (u32 e = 0; e < 2; e++) {
+				const u32 p = (pbits >> e) & 1;
+				const f32* source = e == 0 ? lower : upper;
+				for (u32 c = 0; c < 4; c++) {
+					const auto q = std::min(127l, std::max(0l, std::lround((source[c] - p) / 2.0f)));
+					endpoints[e][c] = static_cast<u8>((q << 1) | p);
+				}
+			}
+
+			u8 palette[16][4];
+			bc7_palette(endpoints, palette);
+
+			u32 error = 0;
+			u32 indices[PixelsPerBlock];
+			for (u32 p = 0; p < PixelsPerBlock; p++)
+				indices[p] = nearest(rgba + p * 4, 4, palette, 16, &error);
+
+			if (error < bestError) {
+				bestError = error;
+				bestPbits = pbits;
+				std::memcpy(best, endpoints, sizeof(best));
+				std::memcpy(bestIndices, indices, sizeof(indices));
+			}
+		}
+
+		//the msb of the first index is implied zero
+		if (bestIndices[0] >= 8) {
+			std::swap(best[0], best[1]);
+			bestPbits = ((bestPbits & 1) << 1) | (bestPbits >> 1);
+			for (auto& index : bestIndices)
+				index = 15 - index;
+		}
+
+		std::memset(output, 0, 16);
+		bit_stream stream{ output };
+		stream.write(1u << 6, 7);
+		for (u32 c = 0; c < 4; c++) {
+			stream.write(best[0][c] >> 1, 7);
+			stream.write(best[1][c] >> 1, 7);
+		}
+		stream.write(bestPbits & 1, 1);
+		stream.write(bestPbits >> 1, 1);
+		for (u32 p = 0; p < PixelsPerBlock; p++)
+			stream.write(bestIndices[p], p == 0 ? 3 : 4);
+	}
+
+	void decode_bc7(const byte* block, u8* rgba) {
+		bit_reader reader{ block };
+		if (reader.read(7) != (1u << 6))
+			throw redox::Exception("unsupported bc7 mode");
+
+		u8 endpoints[2][4];
+		for (u32 c = 0; c < 4; c++) {
+			endpoints[0][c] = static_cast<u8>(reader.read(7) << 1);
+			endpoints[1][c] = static_cast<u8>(reader.read(7) << 1);
+		}
+		const auto p0 = reader.read(1);
+		const auto p1 = reader.read(1);
+		for (u32 c = 0; c < 4; c++) {
+			endpoints[0][c] |= p0;
+			endpoints[1][c] |= p1;
+		}
+
+		u8 palette[16][4];
+		bc7_palette(endpoints, palette);
+		for (u32 p = 0; p < PixelsPerBlock; p++)
+			std::memcpy(rgba + p * 4, palette[reader.read(p == 0 ? 3 : 4)], 4);
+	}
+
+	u32 blocks(u32 pixels) {
+		return std::max(1u, (pixels + 3) / 4);
+	}
+}
+
+redox::u32 redox::bc::block_size(Encoding encoding) {
+	switch (encoding) {
+	case Encoding::RGBA8: return PixelsPerBlock * 4;
+	case Encoding::BC1: return 8;
+	case Encoding::BC3: return 16;
+	case Encoding::BC5: return 16;
+	case Encoding::BC7: return 16;
+	default: throw Exception("unknown texture encoding");
+	}
+}
+
+std::size_t redox::bc::level_size(Encoding encoding, u32 width, u32 height) {
+	if (encoding == Encoding::RGBA8)
+		return std::size_t(width) * height * 4;
+	return std::size_t(blocks(width)) * blocks(height) * block_size(encoding);
+}
+
+void redox::bc::encode_block(Encoding encoding, const u8* rgba, byte* output) {
+	switch (encoding) {
+	case Encoding::BC1:
+		encode_bc1(rgba, output);
+		break;
+	case Encoding::BC3:
+		encode_bc4(rgba, 3, output);
+		encode_bc1(rgba, output + 8);
+		break;
+	case Encoding::BC5:
+		encode_bc4(rgba, 0, output);
+		encode_bc4(rgba, 1, output + 8);
+		break;
+	case Encoding::BC7:
+		encode_bc7(rgba, output);
+		break;
+	default:
+		throw Exception("encoding has no blocks");
+	}
+}
+
+void redox::bc::decode_block(Encoding encoding, const byte* block, u8* rgba) {
+	switch (encoding) {
+	case Encoding::BC1:
+		decode_bc1(block, rgba, false);
+		break;
+	case Encoding::BC3:
+		decode_bc1(block + 8, rgba, true);
+		decode_bc4(block, 3, rgba);
+		break;
+	case Encoding::BC5:
+		for (u32 p = 0; p < PixelsPerBlock; p++) {
+			rgba[p * 4 + 2] = 0;
+			rgba[p * 4 + 3] = 255;
+		}
+		decode_bc4(block, 0, rgba);
+		decode_bc4(block + 8, 1, rgba);
+		break;
+	case Encoding::BC7:
+		decode_bc7(block, rgba);
+		break;
+	default:
+		throw Exception("encoding has no blocks");
+	}
+}
+
+void redox::bc::encode(Encoding encoding, const u8* rgba, u32 width, u32 height, byte* output,
+	concurrency::WorkerPool* workers) {
+
+	if (encoding == Encoding::RGBA8) {
+		std::memcpy(output, rgba, level_size(encoding, width, height));
+		return;
+	}
+
+	const auto blocksX = blocks(width);
+	const auto size = block_size(encoding);
+	auto encode_row = [&](std::size_t by) {
+		u8 block[PixelsPerBlock * 4];
+		for (u32 bx = 0; bx < blocksX; bx++) {
+			for (u32 p = 0; p < PixelsPerBlock; p++) {
+				const auto x = std::min(bx * 4 + p % 4, width - 1);
+				const auto y = std::min(static_cast<u32>(by) * 4 + p / 4, height - 1);
+				std::memcpy(block + p * 4, rgba + (std::size_t(y) * width + x) * 4, 4);
+			}
+			encode_block(encoding, block, output + (by * blocksX + bx) * size);
+		}
+	};
+
+	if (workers != nullptr) {
+		workers->parallel_for(blocks(height), encode_row);
+	}
+	else {
+		for (u32 by = 0; by < blocks(height); by++)
+			encode_row(by);
+	}
+}
+
+void redox::bc::decode(Encoding encoding, const byte* data, u32 width, u32 height, u8* rgba) {
+	if (encoding == Encoding::RGBA8) {
+		std::memcpy(rgba, data, level_size(encoding, width, height));
+		return;
+	}
+
+	const auto blocksX = blocks(width);
+	const auto size = block_size(encoding);
+	u8 block[PixelsPerBlock * 4];
+	for (u32 by = 0; by < blocks(height); by++) {
+		for (u32 bx = 0; bx < blocksX; bx++) {
+			decode_block(encoding, data + (std::size_t(by) * blocksX + bx) * size, block);
+			for (u32 p = 0; p < PixelsPerBlock; p++) {
+				const auto x = bx * 4 + p % 4;
+				const auto y = by * 4 + p / 4;
+				if (x < width && y < height)
+					std::memcpy(rgba + (std::size_t(y) * width + x) * 4, block + p * 4, 4);
+			}
+		}
+	}
+}
+
+bool redox::bc::decodable(Encoding encoding, const byte* data, u32 width, u32 height) {
+	if (encoding != Encoding::BC7)
+		return true;
+
+	//the mode is the lowest set bit, 6 leaves the first six clear
+	const auto count = std::size_t(blocks(width)) * blocks(height);
+	for (std::size_t i = 0; i < count; i++) {
+		if ((data[i * block_size(encoding)] & 0x7f) != (1u << 6))
+			return false;
+	}
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include "core\core.h"
+
+namespace redox::concurrency {
+	class WorkerPool;
+}
+
+namespace redox::bc {
+	//pixel encodings of cooked textures. BC1 and BC3 keep rgb(a), BC5 keeps rg
+	//for normal maps and BC7 keeps rgba at 8 bits per pixel.
+	enum class Encoding : u32 {
+		RGBA8, BC1, BC3, BC5, BC7
+	};
+
+	//bytes per 4x4 block, 64 for RGBA8
+	u32 block_size(Encoding encoding);
+	std::size_t level_size(Encoding encoding, u32 width, u32 height);
+
+	//rgba holds width * height RGBA8 pixels, blocks on the right and bottom edge
+	//repeat the last row and column. output holds level_size bytes.
+	void encode(Encoding encoding, const u8* rgba, u32 width, u32 height, byte* output,
+		concurrency::WorkerPool* workers = nullptr);
+
+	//BC7 input is limited to the single subset mode the encoder emits
+	void decode(Encoding encoding, const byte* data, u32 width, u32 height, u8* rgba);
+	//whether decode accepts every block of a level, false for BC7 from other encoders
+	bool decodable(Encoding encoding, const byte* data, u32 width, u32 height);
+
+	void encode_block(Encoding encoding, const u8* rgba, byte* output);
+	void decode_block(Encoding encoding, const byte* block, u8* rgba);
+}
@@ -26,17 +26,99 @@ SOFTWARE.
 #include "gltf_importer.h"
 #include "core/logging/log.h"
 
+#include <cstring> //std::strncmp, std::strchr, std::strlen
+
+namespace {
+	redox::gltf::ComponentType component_type(cgltf_component_type type) {
+		using redox::gltf::ComponentType;
+		switch (type) {
+		case cgltf_component_type_r_8: return ComponentType::I8;
+		case cgltf_component_type_r_8u: return ComponentType::U8;
+		case cgltf_component_type_r_16: return ComponentType::I16;
+		case cgltf_component_type_r_16u: return ComponentType::U16;
+		case cgltf_component_type_r_32u: return ComponentType::U32;
+		case cgltf_component_type_r_32f: return ComponentType::F32;
+		default: throw redox::Exception("unsupported accessor component type");
+		}
+	}
+
+	redox::u32 component_count(cgltf_type type) {
+		switch (type) {
+		case cgltf_type_scalar: return 1;
+		case cgltf_type_vec2: return 2;
+		case cgltf_type_vec3: return 3;
+		case cgltf_type_vec4: return 4;
+		case cgltf_type_mat2: return 4;
+		case cgltf_type_mat3: return 9;
+		case cgltf_type_mat4: return 16;
+		default: throw redox::Exception("unsupported accessor type");
+		}
+	}
+
+	bool is_data_uri(const char* uri) {
+		return std::strncmp(uri, "data:", 5) == 0;
+	}
+
+	//data:[<media type>];base64,<payload>
+	redox::Buffer<redox::byte> decode_data_uri(const char* uri) {
+		const char* payload = std::strchr(uri, ',');
+		if (payload == nullptr || payload - uri < 12 || std::strncmp(payload - 7, ";base64", 7) != 0) {
+			throw redox::Exception("unsupported data uri, only base64 is supported");
+		}
+
+		auto sextet = [](char c) -> int {
+			if (c >= 'A' && c <= 'Z') return c - 'A';
+			if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+			if (c >= '0' && c <= '9') return c - '0' + 52;
+			if (c == '+') return 62;
+			if (c == '/') return 63;
+			return -1;
+		};
+
+		redox::Buffer<redox::byte> output;
+		output.reserve(std::strlen(++payload) / 4 * 3);
+
+		redox::u32 bits = 0;
+		int count = 0;
+		for (; *payload != '\0' && *payload != '='; payload++) {
+			const auto value = sextet(*payload);
+			if (value < 0) {
+				throw redox::Exception("invalid base64 in data uri");
+			}
+
+			bits = (bits << 6) | static_cast<redox::u32>(value);
+			count += 6;
+			if (count >= 8) {
+				count -= 8;
+				output.push_back(static_cast<redox::byte>(bits >> count));
+			}
+		}
+		return output;
+	}
+}
+
 redox::GLTFImporter::GLTFImporter(const Path& filePath) :
 	_searchPath(filePath.parent_path()) {
 
-	io::File file(filePath, io::File::Mode::READ | io::File::Mode::THROW_IF_INVALID);
-	auto buffer = file.read();
+	auto file = make_unique<io::MappedFile>(filePath, io::MappedFile::Advice::SEQUENTIAL);
+	_parse(file->data());
+	if (_data.bin != nullptr)
+		_file = std::move(file);
+}
+
+redox::GLTFImporter::GLTFImporter(Span<const byte> document, BufferResolver resolver) :
+	_resolver(std::move(resolver)) {
+	_parse(document);
+}
 
+void redox::GLTFImporter::_parse(Span<const byte> document) {
+	//cgltf tells .gltf and .glb apart by the magic, the BIN chunk is not copied
 	cgltf_options options{};
-	cgltf_result result = cgltf_parse(&options, buffer.data(), buffer.size(), &_data);
+	cgltf_result result = cgltf_parse(&options, document.data(), document.size(), &_data);
 	if (result != cgltf_result_success) {
 		throw Exception("failed to load gltf file");
 	}
+	_buffers.resize(_data.buffers_count);
 }
 
 redox::GLTFImporter::~GLTFImporter() {
@@ -51,6 +133,15 @@ std::size_t redox::GLTFImporter::material_count() const {
 	return _data.material_count;
 }
 
+redox::Buffer<redox::String> redox::GLTFImporter::buffer_uris() const {
+	Buffer<String> uris;
+	for (std::size_t i = 0; i < _data.buffers_count; i++) {
+		if (_data.buffers[i].uri != nullptr && !is_data_uri(_data.buffers[i].uri))
+			uris.emplace_back(_data.buffers[i].uri);
+	}
+	return uris;
+}
+
 redox::GLTFImporter::material_data redox::GLTFImporter::import_material(std::size_t index) {
 	if (index >= _data.material_count) {
 		throw Exception("material index not found");
@@ -59,17 +150,15 @@ redox::GLTFImporter::material_data redox::GLTFImporter::import_material(std::siz
 	const auto& material = _data.materials[index];
 	material_data output{ material.name ? material.name : "unknown" };
 
-	if (material.pbr.base_color_texture.texture) {
-		output.albedoMap = material.pbr.base_color_texture.texture->image->uri;
-	}
-
-	if (material.normal_texture.texture) {
-		output.normalMap = material.normal_texture.texture->image->uri;
-	}
+	//images stored inside the document have no uri and fall back to the default texture
+	auto image_uri = [](const cgltf_texture* texture) -> String {
+		return texture && texture->image->uri && !is_data_uri(texture->image->uri) ?
+			texture->image->uri : "";
+	};
 
-	if (material.occlusion_texture.texture) {
-		output.aoMap = material.occlusion_texture.texture->image->uri;
-	}
+	output.albedoMap = image_uri(material.pbr.base_color_texture.texture);
+	output.normalMap = image_uri(material.normal_texture.texture);
+	output.aoMap = image_uri(material.occlusion_texture.texture);
 
 	return output;
 }
@@ -93,61 +182,156 @@ redox::GLTFImporter::mesh_data redox::GLTFImporter::import_mesh(std::size_t inde
 		}
 
 		submesh_data submesh{};
-		submesh.indexOffset = output.indices.size();
-		output.indices.reserve(primitive.indices->count);
-		read_buffer<uint16_t>(primitive.indices->buffer_view,
-			primitive.indices, [&output](const auto& value) {
-			output.indices.push_back(value);
-		});
-		submesh.indexCount = output.indices.size() - submesh.indexOffset;
 		submesh.attributeOffset = output.positions.size() / 3;
+		submesh.indexOffset = output.indices.size();
+		submesh.indexCount = primitive.indices->count;
+		output.indices.resize(submesh.indexOffset + submesh.indexCount);
+
+		auto indices = output.indices.data() + submesh.indexOffset;
+		_decode(primitive.indices, 1, indices);
+
+		//primitives index their own attributes, rebase them onto the shared vertex range
+		if (submesh.attributeOffset > 0) {
+			for (std::size_t i = 0; i < submesh.indexCount; i++)
+				indices[i] += static_cast<u32>(submesh.attributeOffset);
+		}
 
 		for (std::size_t attrIndex = 0; attrIndex < primitive.attributes_count; attrIndex++) {
 			const auto& attribute = primitive.attributes[attrIndex];
-			const auto& bufferView = attribute.data->buffer_view;
-
-			if (bufferView->type != cgltf_buffer_view_type_vertices) {
-				RDX_LOG("Skipped buffer of type: {0}", bufferView->type);
-				continue;
-			}
 
+			Buffer<float_t>* target;
+			u32 components;
 			switch (attribute.name) {
-			case cgltf_attribute_type_position: {
-
-				output.positions.reserve(output.positions.capacity() + attribute.data->count * 3);
-				read_buffer<float_t>(bufferView, attribute.data, [&output](const auto& value) {
-					output.positions.push_back(value);
-				});
-
+			case cgltf_attribute_type_position:
+				target = &output.positions;
+				components = 3;
 				break;
-			}
-			case cgltf_attribute_type_normal: {
-
-				output.normals.reserve(output.normals.capacity() + attribute.data->count * 3);
-				read_buffer<float_t>(bufferView, attribute.data, [&output](const auto& value) {
-					output.normals.push_back(value);
-				});
-
+			case cgltf_attribute_type_normal:
+				target = &output.normals;
+				components = 3;
 				break;
-			}
-
-			case cgltf_attribute_type_texcoord_0: {
-
-				output.texcoords.reserve(output.texcoords.capacity() + attribute.data->count * 2);
-				read_buffer<float_t>(bufferView, attribute.data, [&output](const auto& value) {
-					output.texcoords.push_back(value);
-				});
-
+			case cgltf_attribute_type_texcoord_0:
+				target = &output.texcoords;
+				components = 2;
 				break;
+			default:
+				continue;
 			}
-			}
+
+			//earlier primitives without this attribute are filled with zeros
+			const auto offset = submesh.attributeOffset * components;
+			if (target->size() > offset)
+				throw Exception("primitive has an attribute twice");
+			target->resize(offset + attribute.data->count * components);
+			_decode(attribute.data, components, target->data() + offset);
 		}
 
 		submesh.attributeCount = output.positions.size() / 3 - submesh.attributeOffset;
+
+		//every attribute array has to line up with the positions
+		const auto vertexEnd = submesh.attributeOffset + submesh.attributeCount;
+		for (auto [target, components] : { std::pair(&output.normals, 3u), std::pair(&output.texcoords, 2u) }) {
+			if (target->empty())
+				continue;
+			if (target->size() > vertexEnd * components ||
+				(target->size() > submesh.attributeOffset * components && target->size() < vertexEnd * components))
+				throw Exception("primitive attribute counts differ");
+			target->resize(vertexEnd * components);
+		}
 		submesh.materialIndex = primitive.material - _data.materials;
 		output.submeshes.push_back(std::move(submesh));
 	}
 
 	output.vertexCount = output.positions.size() / 3;
 	return output;
-}
\ No newline at end of file
+}
+redox::Span<const redox::byte> redox::GLTFImporter::_view_data(const cgltf_buffer_view* bufferView) {
+	auto& blob = _buffers[bufferView->buffer - _data.buffers];
+	{
+		//buffers are shared between meshes, only the first use loads them
+		std::lock_guard guard(_bufferMutex);
+		if (!blob.loaded) {
+			_load_buffer(*bufferView->buffer, blob);
+			blob.loaded = true;
+		}
+	}
+
+	if (bufferView->offset + bufferView->size > blob.bytes.size()) {
+		throw Exception("buffer view out of buffer bounds");
+	}
+
+	if (blob.file)
+		blob.file->advise(io::MappedFile::Advice::WILLNEED, bufferView->offset, bufferView->size);
+
+	return { blob.bytes.data() + bufferView->offset, bufferView->size };
+}
+
+void redox::GLTFImporter::_load_buffer(const cgltf_buffer& buffer, buffer_blob& blob) {
+	if (buffer.uri == nullptr) {
+		//the BIN chunk may carry up to 3 bytes of padding behind the buffer
+		if (_data.bin == nullptr || _data.bin_size < buffer.size) {
+			throw Exception("gltf buffer without uri or BIN chunk");
+		}
+		blob.bytes = { static_cast<const byte*>(_data.bin), buffer.size };
+	}
+	else if (is_data_uri(buffer.uri)) {
+		blob.embedded = decode_data_uri(buffer.uri);
+		blob.bytes = blob.embedded;
+	}
+	else if (_resolver) {
+		blob.packed = _resolver(buffer.uri);
+		blob.bytes = blob.packed.data();
+	}
+	else {
+		blob.file = make_unique<io::MappedFile>(_searchPath / buffer.uri);
+		blob.bytes = blob.file->data();
+	}
+}
+
+template<class T>
+void redox::GLTFImporter::_decode(const cgltf_accessor* accessor, u32 components, T* output) {
+	gltf::AccessorView view;
+	view.count = accessor->count;
+	view.stride = accessor->stride;
+	view.components = component_count(accessor->type);
+	view.type = component_type(accessor->component_type);
+	view.normalized = accessor->normalized;
+
+	if (view.components != components) {
+		throw Exception("unexpected accessor type");
+	}
+
+	if (accessor->buffer_view && view.count > 0) {
+		auto data = _view_data(accessor->buffer_view);
+		auto extent = accessor->offset + (view.count - 1) * view.stride + view.element_size();
+		if (view.stride < view.element_size() || extent > data.size()) {
+			throw Exception("accessor out of buffer bounds");
+		}
+		view.data = data.data() + accessor->offset;
+	}
+
+	if (!accessor->is_sparse) {
+		gltf::decode(view, output);
+		return;
+	}
+
+	const auto& sparse = accessor->sparse;
+	if (!sparse.indices_buffer_view || !sparse.values_buffer_view) {
+		throw Exception("sparse accessor without storage");
+	}
+
+	gltf::SparseView sparseView;
+	sparseView.count = sparse.count;
+	sparseView.indexType = component_type(sparse.indices_component_type);
+
+	auto indices = _view_data(sparse.indices_buffer_view);
+	auto values = _view_data(sparse.values_buffer_view);
+	if (sparse.indices_byte_offset + sparse.count * gltf::component_size(sparseView.indexType) > indices.size()
+		|| sparse.values_byte_offset + sparse.count * view.element_size() > values.size()) {
+		throw Exception("sparse accessor out of buffer bounds");
+	}
+
+	sparseView.indices = indices.data() + sparse.indices_byte_offset;
+	sparseView.values = values.data() + sparse.values_byte_offset;
+	gltf::decode(view, output, &sparseView);
+}
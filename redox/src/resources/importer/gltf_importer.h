@@ -27,6 +27,10 @@ SOFTWARE.
 #include "platform/filesystem.h"
 #include "graphics/vulkan/resources/mesh.h"
 #include "resources/resource.h"
+#include "resources/archive.h"
+#include "accessor_decoder.h"
+
+#include <mutex> //std::mutex
 
 #pragma warning(push, 0)
 #include <thirdparty/gltf/cgltf.h>
@@ -35,7 +39,13 @@ SOFTWARE.
 namespace redox {
 	class GLTFImporter : public NonCopyable {
 	public:
+		//maps a buffer uri to its bytes, used when the document does not live on disk
+		using BufferResolver = Function<ResourceArchive::Data(const String& uri)>;
+
+		//accepts .gltf and .glb, the BIN chunk of a .glb is read in place
 		GLTFImporter(const Path& path);
+		//document must outlive the importer when it is a .glb
+		GLTFImporter(Span<const byte> document, BufferResolver resolver);
 		~GLTFImporter();
 
 		struct submesh_data {
@@ -52,7 +62,7 @@ namespace redox {
 			Buffer<float_t> positions;
 			Buffer<float_t> texcoords;
 			Buffer<float_t> normals;
-			Buffer<uint16_t> indices;
+			Buffer<u32> indices;	//relative to the first vertex of the mesh
 			Buffer<submesh_data> submeshes;
 		};
 
@@ -66,31 +76,42 @@ namespace redox {
 		std::size_t mesh_count() const;
 		std::size_t material_count() const;
 
+		//external buffers the document references, relative to it. buffers
+		//embedded as data uris or in a .glb BIN chunk are not listed.
+		Buffer<String> buffer_uris() const;
+
 		material_data import_material(std::size_t index);
+		//safe to call for different meshes from several threads
 		mesh_data import_mesh(std::size_t index);
 
 	private:
-		template<class ParseType, class Fn>
-		void read_buffer(cgltf_buffer_view* bufferView, cgltf_accessor* accessor, Fn&& fn) {
-			auto it = _buffers.find(bufferView->buffer->uri);
-			if (it == _buffers.end()) {
-				io::File blobFile(_searchPath / bufferView->buffer->uri,
-					io::File::Mode::READ | io::File::Mode::THROW_IF_INVALID);
+		struct buffer_blob {
+			bool loaded = false;
+			Span<const byte> bytes;
+
+			//owners of bytes, none for the BIN chunk of a .glb
+			UniquePtr<io::MappedFile> file;
+			ResourceArchive::Data packed;
+			Buffer<byte> embedded;
+		};
 
-				std::tie(it, std::ignore) = _buffers.insert({ bufferView->buffer->uri, blobFile.read() });
-			}
+		void _parse(Span<const byte> document);
 
-			auto readOffset = bufferView->offset + accessor->offset;
-			auto readSize = accessor->count * accessor->stride;
+		//resolves the bytes of a buffer view, loading its buffer on first use
+		Span<const byte> _view_data(const cgltf_buffer_view* bufferView);
+		void _load_buffer(const cgltf_buffer& buffer, buffer_blob& blob);
 
-			for (size_t bufferIndex = readOffset;
-				bufferIndex < readOffset + readSize; bufferIndex += sizeof(ParseType)) {
-				fn(reinterpret_cast<const ParseType&>(it->second[bufferIndex]));
-			}
-		}
+		//decodes an accessor of the given component count into output, which
+		//must hold accessor->count * components values
+		template<class T>
+		void _decode(const cgltf_accessor* accessor, u32 components, T* output);
 
 		cgltf_data _data;
+		UniquePtr<io::MappedFile> _file;	//kept while the BIN chunk points into it
 		Path _searchPath;
-		Hashmap<String, Buffer<i8>> _buffers;
+		BufferResolver _resolver;
+
+		std::mutex _bufferMutex;
+		Buffer<buffer_blob> _buffers;
 	};
 }
\ No newline at end of file
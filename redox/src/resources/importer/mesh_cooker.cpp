@@ -0,0 +1,428 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "mesh_cooker.h"
+#include "gltf_importer.h"
+#include "core\logging\log.h"
+#include "core\concurrency\worker_pool.h"
+
+#include <fstream> //std::ofstream
+#include <cstring> //std::memcpy
+#include <algorithm> //std::min, std::max
+#include <limits> //std::numeric_limits
+#include <cmath> //std::pow
+
+namespace {
+	using redox::CookedMesh;
+
+	redox::u64 align_up(redox::u64 v, redox::u64 alignment) {
+		return (v + alignment - 1) & ~(alignment - 1);
+	}
+
+	CookedMesh::Bounds empty_bounds() {
+		constexpr auto inf = std::numeric_limits<redox::f32>::infinity();
+		return { { inf, inf, inf }, { -inf, -inf, -inf } };
+	}
+
+	void grow(CookedMesh::Bounds& bounds, const redox::f32* p) {
+		for (int i = 0; i < 3; ++i) {
+			bounds.min[i] = std::min(bounds.min[i], p[i]);
+			bounds.max[i] = std::max(bounds.max[i], p[i]);
+		}
+	}
+
+	struct string_table {
+		CookedMesh::StringRef add(redox::StringView str) {
+			CookedMesh::StringRef ref{ static_cast<redox::u32>(data.size()), static_cast<redox::u32>(str.size()) };
+			data.append(str);
+			return ref;
+		}
+
+		redox::String data;
+	};
+
+	//everything the blob needs from one mesh, built independently of the others
+	struct cooked_part {
+		redox::String name;
+		redox::Buffer<redox::graphics::MeshVertex> vertices;
+		redox::Buffer<redox::u32> indices;	//full level followed by the lods
+		redox::Buffer<CookedMesh::SubmeshRecord> submeshes;
+		redox::Buffer<CookedMesh::MeshletRecord> meshlets;
+		CookedMesh::Bounds bounds;
+		redox::u32 largest = 0;
+
+		bool optimized = false;
+		redox::MeshOptimizer::Report report{};
+	};
+
+	cooked_part cook_mesh(redox::GLTFImporter::mesh_data mesh, const redox::MeshCooker::Settings& settings) {
+		using namespace redox;
+
+		cooked_part part;
+		part.name = std::move(mesh.name);
+
+		if (mesh.positions.size() != mesh.vertexCount * 3 ||
+			(!mesh.normals.empty() && mesh.normals.size() != mesh.vertexCount * 3) ||
+			(!mesh.texcoords.empty() && mesh.texcoords.size() != mesh.vertexCount * 2)) {
+			throw Exception(redox::format("vertex attributes of {0} differ in length", part.name));
+		}
+
+		part.vertices.resize(mesh.vertexCount);
+		for (std::size_t v = 0; v < mesh.vertexCount; ++v) {
+			auto& vertex = part.vertices[v];
+			vertex.pos = { mesh.positions[v * 3 + 0], mesh.positions[v * 3 + 1], mesh.positions[v * 3 + 2] };
+			if (!mesh.normals.empty())
+				vertex.normal = { mesh.normals[v * 3 + 0], mesh.normals[v * 3 + 1], mesh.normals[v * 3 + 2] };
+			if (!mesh.texcoords.empty())
+				vertex.uv = { mesh.texcoords[v * 2 + 0], mesh.texcoords[v * 2 + 1] };
+		}
+
+		for (auto index : mesh.indices) {
+			if (index >= part.vertices.size())
+				throw Exception("mesh index out of vertex range");
+		}
+
+		//meshlets decide which triangles are drawn together and the optimizer then orders the
+		//triangles within each of them, so neither undoes the other. welding first lets the
+		//meshlets grow across vertices the source duplicated.
+		const bool optimize = settings.optimize && !mesh.indices.empty();
+		if (optimize) {
+			part.report.before = MeshOptimizer::analyze(mesh.indices, part.vertices.size(), settings.optimizer.cacheSize);
+			part.report.weldedVertices = part.vertices.size() - MeshOptimizer::weld(part.vertices, mesh.indices);
+		}
+
+		Buffer<MeshOptimizer::IndexRange> ranges;
+		for (const auto& sm : mesh.submeshes) {
+			CookedMesh::SubmeshRecord submesh{};
+			submesh.indexOffset = static_cast<u32>(sm.indexOffset);
+			submesh.indexCount = static_cast<u32>(sm.indexCount);
+			submesh.materialIndex = static_cast<u32>(sm.materialIndex);
+			submesh.firstMeshlet = static_cast<u32>(part.meshlets.size());
+
+			if (settings.meshlets) {
+				Span<u32> range(mesh.indices.data() + sm.indexOffset, sm.indexCount);
+				for (const auto& m : MeshletBuilder::build(part.vertices, range,
+					settings.meshletVertices, settings.meshletTriangles)) {
+					part.meshlets.push_back({
+						static_cast<u32>(sm.indexOffset) + m.indexOffset, m.indexCount,
+						{ m.center.x, m.center.y, m.center.z }, m.radius,
+						{ m.coneApex.x, m.coneApex.y, m.coneApex.z },
+						{ m.coneAxis.x, m.coneAxis.y, m.coneAxis.z }, m.coneCutoff, 0
+					});
+					ranges.push_back({ sm.indexOffset + m.indexOffset, m.indexCount });
+				}
+			}
+			else {
+				ranges.push_back({ sm.indexOffset, sm.indexCount });
+			}
+			submesh.meshletCount = static_cast<u32>(part.meshlets.size()) - submesh.firstMeshlet;
+			part.submeshes.push_back(submesh);
+		}
+
+		if (optimize) {
+			//the vertices are welded already, the statistics before are those of the source order
+			part.report.after = MeshOptimizer::optimize(part.vertices, mesh.indices, ranges, settings.optimizer).after;
+			part.optimized = true;
+		}
+
+		part.bounds = empty_bounds();
+		for (const auto& vertex : part.vertices) {
+			const f32 position[] = { vertex.pos.x, vertex.pos.y, vertex.pos.z };
+			grow(part.bounds, position);
+		}
+
+		for (auto index : mesh.indices)
+			part.largest = std::max(part.largest, index);
+
+		const auto& vertices = part.vertices;
+		for (std::size_t s = 0; s < mesh.submeshes.size(); s++) {
+			const auto& sm = mesh.submeshes[s];
+			auto& submesh = part.submeshes[s];
+
+			//levels are appended behind the full resolution indices of the mesh
+			Span<const u32> base(mesh.indices.data() + sm.indexOffset, sm.indexCount);
+			auto previous = base.size();
+			for (u32 level = 1; level <= std::min(settings.lodCount, graphics::SubMesh::MaxLods); level++) {
+				auto target = static_cast<std::size_t>(base.size() * std::pow(settings.lodReduction, f32(level))) / 3 * 3;
+				f32 error;
+				auto lod = MeshSimplifier::simplify(vertices, base, target, settings.lodError, &error);
+
+				//not worth a level, the error bound or locked borders stopped it early
+				if (lod.empty() || lod.size() > previous * 3 / 4)
+					break;
+
+				MeshOptimizer::optimize_vertex_cache(lod, vertices.size(), settings.optimizer.cacheSize);
+				submesh.lods[submesh.lodCount++] = {
+					static_cast<u32>(mesh.indices.size()), static_cast<u32>(lod.size()), error
+				};
+				previous = lod.size();
+
+				mesh.indices.insert(mesh.indices.end(), lod.begin(), lod.end());
+				base = Span<const u32>(mesh.indices.data() + sm.indexOffset, sm.indexCount);
+			}
+		}
+
+		part.indices = std::move(mesh.indices);
+		return part;
+	}
+
+	template<class T>
+	void append(redox::Buffer<redox::byte>& blob, redox::u64& offset, const T* data, std::size_t count) {
+		offset = align_up(blob.size(), CookedMesh::SectionAlignment);
+		blob.resize(static_cast<std::size_t>(offset));
+		auto bytes = reinterpret_cast<const redox::byte*>(data);
+		blob.insert(blob.end(), bytes, bytes + count * sizeof(T));
+	}
+}
+
+// CookedMesh
+
+redox::CookedMesh::CookedMesh(Span<const byte> blob) : _blob(blob) {
+	if (!is_cooked(blob))
+		throw Exception("not a cooked mesh");
+
+	_header = reinterpret_cast<const Header*>(blob.data());
+	if (_header->version != Version || _header->vertexStride != sizeof(graphics::MeshVertex)) {
+		throw Exception("cooked mesh is out of date, recook it");
+	}
+
+	//touch every section once, _section throws on out of bounds ranges
+	_section<MeshRecord>(_header->meshOffset, _header->meshCount);
+	_section<SubmeshRecord>(_header->submeshOffset, _header->submeshCount);
+	_section<MaterialRecord>(_header->materialOffset, _header->materialCount);
+	_section<MeshletRecord>(_header->meshletOffset, _header->meshletCount);
+	_section<char>(_header->stringOffset, _header->stringSize);
+	_section<byte>(_header->vertexOffset, _header->vertexSize);
+	_section<byte>(_header->indexOffset, _header->indexSize);
+
+	for (const auto& mesh : meshes()) {
+		if (mesh.indexType != graphics::IndexType::U16 && mesh.indexType != graphics::IndexType::U32)
+			throw Exception("cooked mesh has an unknown index type");
+
+		if (u64(mesh.firstMeshlet) + mesh.meshletCount > _header->meshletCount)
+			throw Exception("cooked mesh record out of bounds");
+
+		for (const auto& meshlet : meshlets(mesh)) {
+			if (u64(meshlet.indexOffset) + meshlet.indexCount > mesh.indexCount)
+				throw Exception("cooked meshlet out of bounds");
+		}
+
+		if (u64(mesh.firstSubmesh) + mesh.submeshCount <= _header->submeshCount) {
+			for (const auto& sm : submeshes(mesh)) {
+				bool valid = sm.lodCount <= graphics::SubMesh::MaxLods &&
+					u64(sm.indexOffset) + sm.indexCount <= mesh.indexCount &&
+					u64(sm.firstMeshlet) + sm.meshletCount <= mesh.meshletCount;
+				for (u32 level = 0; valid && level < sm.lodCount; level++)
+					valid = u64(sm.lods[level].indexOffset) + sm.lods[level].indexCount <= mesh.indexCount;
+				if (!valid)
+					throw Exception("cooked submesh out of bounds");
+			}
+		}
+
+		const auto indexStride = static_cast<u32>(mesh.indexType);
+		if ((mesh.firstVertex + mesh.vertexCount) * sizeof(graphics::MeshVertex) > _header->vertexSize ||
+			(_header->indexOffset + mesh.indexOffset) % indexStride != 0 ||
+			mesh.indexOffset + u64(mesh.indexCount) * indexStride > _header->indexSize ||
+			u64(mesh.firstSubmesh) + mesh.submeshCount > _header->submeshCount) {
+			throw Exception("cooked mesh record out of bounds");
+		}
+	}
+}
+
+bool redox::CookedMesh::is_cooked(Span<const byte> blob) {
+	return blob.size() >= sizeof(Header) &&
+		reinterpret_cast<const Header*>(blob.data())->magic == Magic;
+}
+
+const redox::CookedMesh::Header& redox::CookedMesh::header() const {
+	return *_header;
+}
+
+redox::Span<const redox::CookedMesh::MeshRecord> redox::CookedMesh::meshes() const {
+	return _section<MeshRecord>(_header->meshOffset, _header->meshCount);
+}
+
+redox::Span<const redox::CookedMesh::MaterialRecord> redox::CookedMesh::materials() const {
+	return _section<MaterialRecord>(_header->materialOffset, _header->materialCount);
+}
+
+redox::Span<const redox::CookedMesh::SubmeshRecord> redox::CookedMesh::submeshes(const MeshRecord& mesh) const {
+	return _section<SubmeshRecord>(_header->submeshOffset, _header->submeshCount)
+		.subspan(mesh.firstSubmesh, mesh.submeshCount);
+}
+
+redox::Span<const redox::CookedMesh::MeshletRecord> redox::CookedMesh::meshlets(const MeshRecord& mesh) const {
+	return _section<MeshletRecord>(_header->meshletOffset, _header->meshletCount)
+		.subspan(mesh.firstMeshlet, mesh.meshletCount);
+}
+
+redox::Span<const redox::graphics::MeshVertex> redox::CookedMesh::vertices(const MeshRecord& mesh) const {
+	return _section<graphics::MeshVertex>(
+		_header->vertexOffset + mesh.firstVertex * sizeof(graphics::MeshVertex), mesh.vertexCount);
+}
+
+redox::Span<const redox::byte> redox::CookedMesh::index_data(const MeshRecord& mesh) const {
+	return _section<byte>(_header->indexOffset + mesh.indexOffset,
+		u64(mesh.indexCount) * static_cast<u32>(mesh.indexType));
+}
+
+redox::StringView redox::CookedMesh::string(const StringRef& ref) const {
+	if (u64(ref.offset) + ref.length > _header->stringSize)
+		throw Exception("cooked mesh string out of bounds");
+	return { reinterpret_cast<const char*>(_blob.data() + _header->stringOffset + ref.offset), ref.length };
+}
+
+template<class T>
+redox::Span<const T> redox::CookedMesh::_section(u64 offset, u64 count) const {
+	if (offset % alignof(T) != 0 || offset + count * sizeof(T) > _blob.size())
+		throw Exception("cooked mesh section out of bounds");
+	return { reinterpret_cast<const T*>(_blob.data() + offset), static_cast<std::size_t>(count) };
+}
+
+// MeshCooker
+
+redox::Buffer<redox::byte> redox::MeshCooker::cook(GLTFImporter& importer) {
+	return cook(importer, Settings{});
+}
+
+redox::Buffer<redox::byte> redox::MeshCooker::cook(GLTFImporter& importer, const Settings& settings) {
+	//meshes are imported, optimized and split independently, then packed in order
+	Buffer<cooked_part> parts(importer.mesh_count());
+	auto cook_part = [&](std::size_t i) {
+		parts[i] = cook_mesh(importer.import_mesh(i), settings);
+	};
+
+	if (settings.workers != nullptr && parts.size() > 1) {
+		settings.workers->parallel_for(parts.size(), cook_part);
+	}
+	else {
+		for (std::size_t i = 0; i < parts.size(); i++)
+			cook_part(i);
+	}
+
+	Buffer<CookedMesh::MeshRecord> meshes;
+	Buffer<CookedMesh::SubmeshRecord> submeshes;
+	Buffer<CookedMesh::MaterialRecord> materials;
+	Buffer<CookedMesh::MeshletRecord> meshlets;
+	Buffer<graphics::MeshVertex> vertices;
+	Buffer<byte> indices;
+	string_table strings;
+
+	auto modelBounds = empty_bounds();
+
+	for (const auto& part : parts) {
+		if (part.optimized) {
+			RDX_LOG("Optimized mesh {0}: ACMR {1} -> {2}, ATVR {3} -> {4}, {5} vertices welded",
+				part.name, part.report.before.acmr, part.report.after.acmr,
+				part.report.before.atvr, part.report.after.atvr, part.report.weldedVertices);
+		}
+
+		CookedMesh::MeshRecord record{};
+		record.name = strings.add(part.name);
+		record.vertexCount = static_cast<u32>(part.vertices.size());
+		record.indexCount = static_cast<u32>(part.indices.size());
+		record.firstVertex = vertices.size();
+		record.firstSubmesh = static_cast<u32>(submeshes.size());
+		record.submeshCount = static_cast<u32>(part.submeshes.size());
+		record.firstMeshlet = static_cast<u32>(meshlets.size());
+		record.meshletCount = static_cast<u32>(part.meshlets.size());
+		record.bounds = part.bounds;
+
+		vertices.insert(vertices.end(), part.vertices.begin(), part.vertices.end());
+		submeshes.insert(submeshes.end(), part.submeshes.begin(), part.submeshes.end());
+		meshlets.insert(meshlets.end(), part.meshlets.begin(), part.meshlets.end());
+
+		if (!part.vertices.empty()) {
+			grow(modelBounds, record.bounds.min);
+			grow(modelBounds, record.bounds.max);
+		}
+
+		//16 bit indices unless the mesh addresses more vertices than they can reach
+		record.indexType = part.largest > std::numeric_limits<uint16_t>::max() ?
+			graphics::IndexType::U32 : graphics::IndexType::U16;
+		record.indexOffset = align_up(indices.size(), alignof(u32));
+		indices.resize(static_cast<std::size_t>(record.indexOffset + part.indices.size() * static_cast<u32>(record.indexType)));
+
+		if (record.indexType == graphics::IndexType::U32) {
+			std::memcpy(indices.data() + record.indexOffset, part.indices.data(), part.indices.size() * sizeof(u32));
+		}
+		else {
+			auto narrow = reinterpret_cast<uint16_t*>(indices.data() + record.indexOffset);
+			for (auto index : part.indices)
+				*narrow++ = static_cast<uint16_t>(index);
+		}
+
+		meshes.push_back(record);
+	}
+
+	for (std::size_t i = 0; i < importer.material_count(); i++) {
+		auto material = importer.import_material(i);
+		materials.push_back({
+			strings.add(material.name),
+			strings.add(material.albedoMap),
+			strings.add(material.normalMap),
+			strings.add(material.aoMap)
+		});
+	}
+
+	CookedMesh::Header header{};
+	header.magic = CookedMesh::Magic;
+	header.version = CookedMesh::Version;
+	header.vertexStride = sizeof(graphics::MeshVertex);
+	header.meshCount = static_cast<u32>(meshes.size());
+	header.submeshCount = static_cast<u32>(submeshes.size());
+	header.materialCount = static_cast<u32>(materials.size());
+	header.meshletCount = static_cast<u32>(meshlets.size());
+	header.stringSize = strings.data.size();
+	header.vertexSize = vertices.size() * sizeof(graphics::MeshVertex);
+	header.indexSize = indices.size();
+	header.bounds = meshes.empty() ? CookedMesh::Bounds{} : modelBounds;
+
+	Buffer<byte> blob(sizeof(header));
+	append(blob, header.meshOffset, meshes.data(), meshes.size());
+	append(blob, header.submeshOffset, submeshes.data(), submeshes.size());
+	append(blob, header.materialOffset, materials.data(), materials.size());
+	append(blob, header.meshletOffset, meshlets.data(), meshlets.size());
+	append(blob, header.vertexOffset, vertices.data(), vertices.size());
+	append(blob, header.indexOffset, indices.data(), indices.size());
+	append(blob, header.stringOffset, strings.data.data(), strings.data.size());
+
+	std::memcpy(blob.data(), &header, sizeof(header));
+	return blob;
+}
+
+void redox::MeshCooker::cook(const Path& gltf, const Path& output) {
+	cook(gltf, output, Settings{});
+}
+
+void redox::MeshCooker::cook(const Path& gltf, const Path& output, const Settings& settings) {
+	GLTFImporter importer(gltf);
+	auto blob = cook(importer, settings);
+
+	std::ofstream file(output, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+	if (!file.flush())
+		throw Exception("failed to write cooked mesh");
+}
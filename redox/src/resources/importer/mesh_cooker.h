@@ -0,0 +1,181 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include "core\core.h"
+#include "core\non_copyable.h"
+#include "graphics\vulkan\resources\mesh.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
+#include "meshlet_builder.h"
+
+namespace redox {
+	class GLTFImporter;
+
+	//view over a cooked model (.rmesh). vertices are stored in the final MeshVertex
+	//layout and indices in the narrowest format that fits each mesh, so each mesh can
+	//be copied into its staging buffer as is. the blob must outlive the view.
+	class CookedMesh {
+	public:
+		struct StringRef {
+			u32 offset;
+			u32 length;
+		};
+
+		struct Bounds {
+			f32 min[3];
+			f32 max[3];
+		};
+
+		struct Header {
+			u32 magic;
+			u32 version;
+			u32 vertexStride;	//sizeof(MeshVertex) at cook time
+			u32 meshCount;
+			u32 submeshCount;
+			u32 materialCount;
+			u32 meshletCount;
+			u32 reserved;
+			u64 meshOffset;		//MeshRecord[meshCount]
+			u64 submeshOffset;	//SubmeshRecord[submeshCount]
+			u64 materialOffset;	//MaterialRecord[materialCount]
+			u64 meshletOffset;	//MeshletRecord[meshletCount]
+			u64 stringOffset;
+			u64 stringSize;
+			u64 vertexOffset;
+			u64 vertexSize;
+			u64 indexOffset;
+			u64 indexSize;
+			Bounds bounds;
+		};
+
+		struct MeshRecord {
+			StringRef name;
+			u32 vertexCount;
+			u32 indexCount;
+			u64 firstVertex;	//elements into the vertex section
+			u64 indexOffset;	//bytes into the index section
+			u32 firstSubmesh;
+			u32 submeshCount;
+			graphics::IndexType indexType;
+			u32 reserved;
+			u32 firstMeshlet;
+			u32 meshletCount;
+			Bounds bounds;
+		};
+
+		struct LodRecord {
+			u32 indexOffset;	//elements, relative to the mesh like the submesh range
+			u32 indexCount;
+			f32 error;
+			u32 reserved;
+		};
+
+		struct SubmeshRecord {
+			u32 indexOffset;
+			u32 indexCount;
+			u32 materialIndex;
+			u32 lodCount;
+			LodRecord lods[graphics::SubMesh::MaxLods];
+			u32 firstMeshlet;	//relative to the mesh
+			u32 meshletCount;
+		};
+
+		struct MeshletRecord {
+			u32 indexOffset;	//elements, relative to the mesh
+			u32 indexCount;
+			f32 center[3];
+			f32 radius;
+			f32 coneApex[3];
+			f32 coneAxis[3];
+			f32 coneCutoff;
+			u32 reserved;
+		};
+
+		struct MaterialRecord {
+			StringRef name;
+			StringRef albedoMap;
+			StringRef normalMap;
+			StringRef aoMap;
+		};
+
+		static constexpr u32 Magic = 0x48534d52; //"RMSH"
+		static constexpr u32 Version = 4;
+		static constexpr u64 SectionAlignment = 16;
+
+		//validates every offset against the blob
+		explicit CookedMesh(Span<const byte> blob);
+		static bool is_cooked(Span<const byte> blob);
+
+		const Header& header() const;
+		Span<const MeshRecord> meshes() const;
+		Span<const MaterialRecord> materials() const;
+
+		Span<const SubmeshRecord> submeshes(const MeshRecord& mesh) const;
+		Span<const MeshletRecord> meshlets(const MeshRecord& mesh) const;
+		Span<const graphics::MeshVertex> vertices(const MeshRecord& mesh) const;
+		Span<const byte> index_data(const MeshRecord& mesh) const;
+		StringView string(const StringRef& ref) const;
+
+		template<class T>
+		Span<const T> indices(const MeshRecord& mesh) const {
+			if (sizeof(T) != static_cast<u32>(mesh.indexType))
+				throw Exception("cooked mesh index type mismatch");
+			return { reinterpret_cast<const T*>(index_data(mesh).data()), mesh.indexCount };
+		}
+
+	private:
+		template<class T>
+		Span<const T> _section(u64 offset, u64 count) const;
+
+		Span<const byte> _blob;
+		const Header* _header;
+	};
+
+	//bakes glTF documents into cooked models, done once offline instead of
+	//parsing JSON and walking accessors at every load
+	class MeshCooker : public NonCopyable {
+	public:
+		struct Settings {
+			concurrency::WorkerPool* workers = nullptr;	//cooks meshes in parallel when set
+
+			bool optimize = true;
+			MeshOptimizer::Settings optimizer;
+
+			u32 lodCount = 3;			//levels below the full mesh, at most SubMesh::MaxLods
+			f32 lodReduction = 0.5f;	//triangle ratio between successive levels
+			f32 lodError = 0.05f;		//relative to the mesh radius
+
+			bool meshlets = true;		//clusters for per meshlet culling of the full level
+			u32 meshletVertices = MeshletBuilder::MaxVertices;
+			u32 meshletTriangles = MeshletBuilder::MaxTriangles;
+		};
+
+		static Buffer<byte> cook(GLTFImporter& importer, const Settings& settings);
+		static Buffer<byte> cook(GLTFImporter& importer);
+		static void cook(const Path& gltf, const Path& output, const Settings& settings);
+		static void cook(const Path& gltf, const Path& output);
+	};
+}
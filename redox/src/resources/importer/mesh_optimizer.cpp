@@ -0,0 +1,386 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "mesh_optimizer.h"
+#include "core\hash.h"
+#include "core\concurrency\worker_pool.h"
+
+#include <cstring> //std::memcpy, std::memcmp
+#include <algorithm> //std::stable_sort
+
+namespace {
+	using redox::u32;
+	using redox::f32;
+	using redox::graphics::MeshVertex;
+
+	constexpr u32 invalid_index = ~0u;
+
+	//only the meaningful lanes, the simd padding of the vectors is not compared
+	struct vertex_key {
+		f32 values[8];
+
+		explicit vertex_key(const MeshVertex& v) :
+			values{ v.pos.x, v.pos.y, v.pos.z, v.normal.x, v.normal.y, v.normal.z, v.uv.x, v.uv.y } {
+		}
+
+		bool operator==(const vertex_key& rhs) const {
+			return std::memcmp(values, rhs.values, sizeof(values)) == 0;
+		}
+	};
+
+	//timestamp based fifo cache: a vertex is resident while fewer than size
+	//misses happened since it was loaded
+	struct cache_simulation {
+		cache_simulation(std::size_t vertexCount, u32 size) :
+			loaded(vertexCount, 0), timestamp(size + 1), size(size) {
+		}
+
+		u32 access(u32 vertex) {
+			if (timestamp - loaded[vertex] > size) {
+				loaded[vertex] = timestamp++;
+				return 1;
+			}
+			return 0;
+		}
+
+		void flush() {
+			timestamp += size + 1;
+		}
+
+		redox::Buffer<u32> loaded;
+		u32 timestamp;
+		u32 size;
+	};
+
+	redox::math::Vec3f triangle_normal(const MeshVertex& a, const MeshVertex& b, const MeshVertex& c) {
+		//length is twice the triangle area, keeps the sums area weighted
+		return (b.pos - a.pos).cross(c.pos - a.pos);
+	}
+}
+
+redox::MeshOptimizer::Report redox::MeshOptimizer::optimize(Buffer<graphics::MeshVertex>& vertices,
+	Buffer<u32>& indices, Span<const IndexRange> submeshes) {
+	return optimize(vertices, indices, submeshes, Settings{});
+}
+
+redox::MeshOptimizer::Report redox::MeshOptimizer::optimize(Buffer<graphics::MeshVertex>& vertices,
+	Buffer<u32>& indices, Span<const IndexRange> submeshes, const Settings& settings) {
+
+	for (const auto& range : submeshes) {
+		if (range.offset + range.count > indices.size() || range.count % 3 != 0)
+			throw Exception("invalid submesh index range");
+	}
+
+	for (auto index : indices) {
+		if (index >= vertices.size())
+			throw Exception("index out of vertex range");
+	}
+
+	Report report{};
+	report.before = analyze(indices, vertices.size(), settings.cacheSize);
+	report.weldedVertices = vertices.size() - weld(vertices, indices);
+
+	auto process = [&vertices, &indices, &settings](const IndexRange& range) {
+		Span<u32> submesh(indices.data() + range.offset, range.count);
+		Buffer<u32> clusters;
+		optimize_vertex_cache(submesh, vertices.size(), settings.cacheSize, &clusters);
+		optimize_overdraw(submesh, vertices, clusters, settings.cacheSize, settings.overdrawThreshold);
+	};
+
+	if (settings.workers == nullptr || submeshes.size() < 2) {
+		for (const auto& range : submeshes)
+			process(range);
+	}
+	else {
+		settings.workers->parallel_for(submeshes.size(), [&](std::size_t i) {
+			process(submeshes[i]);
+		});
+	}
+
+	optimize_vertex_fetch(vertices, indices);
+	report.after = analyze(indices, vertices.size(), settings.cacheSize);
+	return report;
+}
+
+redox::MeshOptimizer::Statistics redox::MeshOptimizer::analyze(Span<const u32> indices,
+	std::size_t vertexCount, u32 cacheSize) {
+
+	cache_simulation cache(vertexCount, cacheSize);
+	std::size_t misses = 0;
+	for (auto index : indices)
+		misses += cache.access(index);
+
+	const auto triangles = indices.size() / 3;
+	return {
+		triangles == 0 ? 0.0f : static_cast<f32>(misses) / triangles,
+		vertexCount == 0 ? 0.0f : static_cast<f32>(misses) / vertexCount
+	};
+}
+
+std::size_t redox::MeshOptimizer::weld(Buffer<graphics::MeshVertex>& vertices, Span<u32> indices) {
+	std::size_t tableSize = 16;
+	while (tableSize < vertices.size() * 2)
+		tableSize *= 2;
+
+	//open addressing over the compacted prefix of vertices
+	Buffer<u32> table(tableSize, invalid_index);
+	Buffer<u32> remap(vertices.size());
+	std::size_t unique = 0;
+
+	for (std::size_t v = 0; v < vertices.size(); v++) {
+		const vertex_key key(vertices[v]);
+		auto slot = hash::xxh64(key.values, sizeof(key.values)) & (tableSize - 1);
+
+		while (table[slot] != invalid_index && !(vertex_key(vertices[table[slot]]) == key))
+			slot = (slot + 1) & (tableSize - 1);
+
+		if (table[slot] == invalid_index) {
+			table[slot] = static_cast<u32>(unique);
+			vertices[unique++] = vertices[v];
+		}
+		remap[v] = table[slot];
+	}
+
+	for (auto& index : indices)
+		index = remap[index];
+
+	vertices.resize(unique);
+	return unique;
+}
+
+void redox::MeshOptimizer::optimize_vertex_cache(Span<u32> indices, std::size_t vertexCount,
+	u32 cacheSize, Buffer<u32>* clusters) {
+
+	const auto triangleCount = indices.size() / 3;
+	if (clusters)
+		clusters->clear();
+	if (triangleCount == 0)
+		return;
+
+	//vertex to triangle adjacency, live counts the triangles not emitted yet
+	Buffer<u32> live(vertexCount, 0);
+	for (auto index : indices)
+		live[index]++;
+
+	Buffer<u32> adjacencyOffset(vertexCount + 1, 0);
+	for (std::size_t v = 0; v < vertexCount; v++)
+		adjacencyOffset[v + 1] = adjacencyOffset[v] + live[v];
+
+	Buffer<u32> adjacency(indices.size());
+	Buffer<u32> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+	for (std::size_t i = 0; i < indices.size(); i++)
+		adjacency[fill[indices[i]]++] = static_cast<u32>(i / 3);
+
+	Buffer<u32> cacheTime(vertexCount, 0);
+	Buffer<u8> emitted(triangleCount, 0);
+	Buffer<u32> deadEnd;
+	Buffer<u32> candidates;
+	Buffer<u32> output;
+	output.reserve(indices.size());
+
+	u32 timestamp = cacheSize + 1;
+	std::size_t cursor = 0;
+	u32 fanning = invalid_index;
+	bool cold = true;
+
+	auto next_live = [&]() {
+		while (!deadEnd.empty()) {
+			auto vertex = deadEnd.back();
+			deadEnd.pop_back();
+			if (live[vertex] > 0)
+				return vertex;
+		}
+
+		for (; cursor < vertexCount; cursor++) {
+			if (live[cursor] > 0)
+				return static_cast<u32>(cursor);
+		}
+		return invalid_index;
+	};
+
+	fanning = next_live();
+	while (fanning != invalid_index) {
+		if (cold && clusters)
+			clusters->push_back(static_cast<u32>(output.size() / 3));
+		cold = false;
+
+		candidates.clear();
+		for (auto a = adjacencyOffset[fanning]; a < adjacencyOffset[fanning + 1]; a++) {
+			const auto triangle = adjacency[a];
+			if (emitted[triangle])
+				continue;
+			emitted[triangle] = 1;
+
+			for (std::size_t k = 0; k < 3; k++) {
+				const auto vertex = indices[triangle * 3 + k];
+				output.push_back(vertex);
+				deadEnd.push_back(vertex);
+				candidates.push_back(vertex);
+				live[vertex]--;
+
+				if (timestamp - cacheTime[vertex] > cacheSize)
+					cacheTime[vertex] = timestamp++;
+			}
+		}
+
+		//oldest candidate whose whole fan still fits into the cache
+		u32 best = invalid_index;
+		i64 bestPriority = -1;
+		for (auto vertex : candidates) {
+			if (live[vertex] == 0)
+				continue;
+
+			i64 priority = 0;
+			if (timestamp - cacheTime[vertex] + 2 * live[vertex] <= cacheSize)
+				priority = timestamp - cacheTime[vertex];
+
+			if (priority > bestPriority) {
+				bestPriority = priority;
+				best = vertex;
+			}
+		}
+
+		if (best == invalid_index) {
+			best = next_live();
+			cold = true;
+		}
+		fanning = best;
+	}
+
+	std::memcpy(indices.data(), output.data(), output.size() * sizeof(u32));
+}
+
+void redox::MeshOptimizer::optimize_overdraw(Span<u32> indices, Span<const graphics::MeshVertex> vertices,
+	Span<const u32> clusters, u32 cacheSize, f32 threshold) {
+
+	const auto triangleCount = static_cast<u32>(indices.size() / 3);
+	if (triangleCount == 0 || clusters.empty())
+		return;
+
+	//split the hard clusters wherever the running ACMR is within the threshold
+	//of the whole cluster, the cache state lost at the seam is what we pay
+	cache_simulation cache(vertices.size(), cacheSize);
+	Buffer<u32> boundaries;
+
+	for (std::size_t c = 0; c < clusters.size(); c++) {
+		const auto start = clusters[c];
+		const auto end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+
+		cache.flush();
+		u32 misses = 0;
+		for (auto t = start; t < end; t++) {
+			for (std::size_t k = 0; k < 3; k++)
+				misses += cache.access(indices[t * 3 + k]);
+		}
+		const auto limit = threshold * misses / (end - start);
+
+		cache.flush();
+		boundaries.push_back(start);
+		auto subStart = start;
+		misses = 0;
+		for (auto t = start; t < end; t++) {
+			for (std::size_t k = 0; k < 3; k++)
+				misses += cache.access(indices[t * 3 + k]);
+
+			if (t + 1 < end && misses <= limit * (t + 1 - subStart)) {
+				boundaries.push_back(t + 1);
+				cache.flush();
+				subStart = t + 1;
+				misses = 0;
+			}
+		}
+	}
+	boundaries.push_back(triangleCount);
+
+	math::Vec3f meshCentroid;
+	for (auto index : indices)
+		meshCentroid = meshCentroid + vertices[index].pos;
+	meshCentroid = meshCentroid / static_cast<f32>(indices.size());
+
+	struct cluster {
+		u32 start;
+		u32 end;
+		f32 sortKey;
+	};
+
+	Buffer<cluster> sorted;
+	sorted.reserve(boundaries.size() - 1);
+
+	for (std::size_t b = 0; b + 1 < boundaries.size(); b++) {
+		math::Vec3f centroid;
+		math::Vec3f normal;
+		f32 area = 0.0f;
+
+		for (auto t = boundaries[b]; t < boundaries[b + 1]; t++) {
+			const auto& v0 = vertices[indices[t * 3 + 0]];
+			const auto& v1 = vertices[indices[t * 3 + 1]];
+			const auto& v2 = vertices[indices[t * 3 + 2]];
+
+			const auto n = triangle_normal(v0, v1, v2);
+			const auto weight = n.length();
+			centroid = centroid + (v0.pos + v1.pos + v2.pos) * (weight / 3.0f);
+			normal = normal + n;
+			area += weight;
+		}
+
+		f32 key = 0.0f;
+		const auto length = normal.length();
+		if (area > 0.0f && length > 0.0f)
+			key = (centroid / area - meshCentroid).dot(normal / length);
+
+		sorted.push_back({ boundaries[b], boundaries[b + 1], key });
+	}
+
+	std::stable_sort(sorted.begin(), sorted.end(), [](const cluster& lhs, const cluster& rhs) {
+		return lhs.sortKey > rhs.sortKey;
+	});
+
+	Buffer<u32> output;
+	output.reserve(indices.size());
+	for (const auto& c : sorted)
+		output.insert(output.end(), indices.begin() + c.start * 3, indices.begin() + c.end * 3);
+
+	std::memcpy(indices.data(), output.data(), output.size() * sizeof(u32));
+}
+
+std::size_t redox::MeshOptimizer::optimize_vertex_fetch(Buffer<graphics::MeshVertex>& vertices, Span<u32> indices) {
+	Buffer<u32> remap(vertices.size(), invalid_index);
+	u32 next = 0;
+
+	for (auto& index : indices) {
+		if (remap[index] == invalid_index)
+			remap[index] = next++;
+		index = remap[index];
+	}
+
+	Buffer<graphics::MeshVertex> ordered(next);
+	for (std::size_t v = 0; v < vertices.size(); v++) {
+		if (remap[v] != invalid_index)
+			ordered[remap[v]] = vertices[v];
+	}
+
+	vertices = std::move(ordered);
+	return next;
+}
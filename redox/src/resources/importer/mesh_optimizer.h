@@ -0,0 +1,88 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include "core\core.h"
+#include "core\non_copyable.h"
+#include "graphics\vulkan\resources\mesh.h"
+
+namespace redox::concurrency {
+	class WorkerPool;
+}
+
+namespace redox {
+	//import-time reordering of indexed triangle lists. submeshes are optimized
+	//independently, index ranges keep their offset and size.
+	class MeshOptimizer : public NonCopyable {
+	public:
+		struct Settings {
+			u32 cacheSize = 16;				//simulated post-transform cache entries
+			f32 overdrawThreshold = 1.05f;	//accepted ACMR growth when splitting clusters for overdraw
+			concurrency::WorkerPool* workers = nullptr; //optimizes submeshes in parallel when set
+		};
+
+		struct IndexRange {
+			std::size_t offset;
+			std::size_t count;
+		};
+
+		//average cache miss ratio (misses per triangle, 0.5 - 3) and
+		//average transformed vertex ratio (misses per vertex, 1 is ideal)
+		struct Statistics {
+			f32 acmr;
+			f32 atvr;
+		};
+
+		struct Report {
+			Statistics before;
+			Statistics after;
+			std::size_t weldedVertices;
+		};
+
+		//runs every stage: weld, per submesh vertex cache and overdraw ordering, fetch remap
+		static Report optimize(Buffer<graphics::MeshVertex>& vertices, Buffer<u32>& indices,
+			Span<const IndexRange> submeshes, const Settings& settings);
+		static Report optimize(Buffer<graphics::MeshVertex>& vertices, Buffer<u32>& indices,
+			Span<const IndexRange> submeshes);
+
+		static Statistics analyze(Span<const u32> indices, std::size_t vertexCount, u32 cacheSize = 16);
+
+		//merges bitwise identical vertices, returns the new vertex count
+		static std::size_t weld(Buffer<graphics::MeshVertex>& vertices, Span<u32> indices);
+
+		//tipsify (Sander et al. 2007). clusters receives the first triangle of every
+		//run that starts from a cold cache.
+		static void optimize_vertex_cache(Span<u32> indices, std::size_t vertexCount,
+			u32 cacheSize, Buffer<u32>* clusters = nullptr);
+
+		//splits clusters where the cache allows it and sorts them so outward facing
+		//clusters come first, occluding what is drawn after them
+		static void optimize_overdraw(Span<u32> indices, Span<const graphics::MeshVertex> vertices,
+			Span<const u32> clusters, u32 cacheSize, f32 threshold);
+
+		//orders vertices by first use and drops unreferenced ones, returns the new vertex count
+		static std::size_t optimize_vertex_fetch(Buffer<graphics::MeshVertex>& vertices, Span<u32> indices);
+	};
+}
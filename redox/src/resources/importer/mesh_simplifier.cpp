@@ -0,0 +1,271 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "mesh_simplifier.h"
+
+#include <cmath> //std::sqrt
+#include <algorithm> //std::sort, std::unique, std::max
+
+namespace {
+	using redox::u32;
+	using redox::u64;
+	using redox::f32;
+	using redox::f64;
+
+	struct vec3 {
+		f64 x, y, z;
+
+		vec3 operator-(const vec3& rhs) const {
+			return { x - rhs.x, y - rhs.y, z - rhs.z };
+		}
+
+		f64 dot(const vec3& rhs) const {
+			return x * rhs.x + y * rhs.y + z * rhs.z;
+		}
+
+		vec3 cross(const vec3& rhs) const {
+			return { y * rhs.z - z * rhs.y, z * rhs.x - x * rhs.z, x * rhs.y - y * rhs.x };
+		}
+	};
+
+	//symmetric 4x4 plane quadric, weight is the accumulated triangle area
+	struct quadric {
+		f64 a2 = 0, b2 = 0, c2 = 0, d2 = 0;
+		f64 ab = 0, ac = 0, ad = 0, bc = 0, bd = 0, cd = 0;
+		f64 weight = 0;
+
+		void add_plane(const vec3& n, f64 d, f64 w) {
+			a2 += w * n.x * n.x; b2 += w * n.y * n.y; c2 += w * n.z * n.z; d2 += w * d * d;
+			ab += w * n.x * n.y; ac += w * n.x * n.z; ad += w * n.x * d;
+			bc += w * n.y * n.z; bd += w * n.y * d; cd += w * n.z * d;
+			weight += w;
+		}
+
+		void add(const quadric& q) {
+			a2 += q.a2; b2 += q.b2; c2 += q.c2; d2 += q.d2;
+			ab += q.ab; ac += q.ac; ad += q.ad; bc += q.bc; bd += q.bd; cd += q.cd;
+			weight += q.weight;
+		}
+
+		//squared distance to the planes, averaged over their area
+		f64 error(const vec3& p) const {
+			const auto e =
+				a2 * p.x * p.x + b2 * p.y * p.y + c2 * p.z * p.z + d2 +
+				2 * (ab * p.x * p.y + ac * p.x * p.z + ad * p.x + bc * p.y * p.z + bd * p.y + cd * p.z);
+			return weight > 0 ? std::max(e, 0.0) / weight : 0.0;
+		}
+	};
+
+	struct collapse {
+		u32 from;
+		u32 to;
+		f64 cost;
+	};
+
+	//normal and uv deviation, squared, relative to the geometric term
+	constexpr f64 attribute_weight = 0.25;
+
+	f64 attribute_error(const redox::graphics::MeshVertex& a, const redox::graphics::MeshVertex& b) {
+		const auto dn = a.normal - b.normal;
+		const auto duv = a.uv - b.uv;
+		return attribute_weight * attribute_weight * (dn.dot(dn) + duv.x * duv.x + duv.y * duv.y);
+	}
+
+	u64 edge_key(u32 a, u32 b) {
+		return a < b ? (u64(a) << 32) | b : (u64(b) << 32) | a;
+	}
+}
+
+redox::Buffer<redox::u32> redox::MeshSimplifier::simplify(Span<const graphics::MeshVertex> vertices,
+	Span<const u32> indices, std::size_t targetIndexCount, f32 targetError, f32* resultError) {
+
+	Buffer<u32> result(indices.begin(), indices.end());
+	if (resultError)
+		*resultError = 0.0f;
+
+	const auto vertexCount = vertices.size();
+	if (result.size() <= targetIndexCount || vertexCount == 0)
+		return result;
+
+	//work in a unit sphere around the bounds so errors are scale independent
+	vec3 lower{ vertices[0].pos.x, vertices[0].pos.y, vertices[0].pos.z };
+	vec3 upper = lower;
+	for (const auto& v : vertices) {
+		lower = { std::min<f64>(lower.x, v.pos.x), std::min<f64>(lower.y, v.pos.y), std::min<f64>(lower.z, v.pos.z) };
+		upper = { std::max<f64>(upper.x, v.pos.x), std::max<f64>(upper.y, v.pos.y), std::max<f64>(upper.z, v.pos.z) };
+	}
+
+	const auto extent = upper - lower;
+	const auto radius = std::max(std::sqrt(extent.dot(extent)) * 0.5, 1e-12);
+	const vec3 center{ (lower.x + upper.x) * 0.5, (lower.y + upper.y) * 0.5, (lower.z + upper.z) * 0.5 };
+
+	Buffer<vec3> positions(vertexCount);
+	for (std::size_t v = 0; v < vertexCount; v++) {
+		const auto& p = vertices[v].pos;
+		positions[v] = { (p.x - center.x) / radius, (p.y - center.y) / radius, (p.z - center.z) / radius };
+	}
+
+	//edges used by anything but exactly two triangles lock their vertices
+	Hashmap<u64, u32> edgeUse;
+	edgeUse.reserve(result.size());
+	for (std::size_t t = 0; t < result.size(); t += 3) {
+		for (std::size_t k = 0; k < 3; k++)
+			edgeUse[edge_key(result[t + k], result[t + (k + 1) % 3])]++;
+	}
+
+	Buffer<u8> locked(vertexCount, 0);
+	for (const auto& [key, count] : edgeUse) {
+		if (count != 2) {
+			locked[static_cast<u32>(key >> 32)] = 1;
+			locked[static_cast<u32>(key)] = 1;
+		}
+	}
+
+	Buffer<quadric> quadrics(vertexCount);
+	for (std::size_t t = 0; t < result.size(); t += 3) {
+		const auto& p0 = positions[result[t]];
+		auto normal = (positions[result[t + 1]] - p0).cross(positions[result[t + 2]] - p0);
+		const auto length = std::sqrt(normal.dot(normal));
+		if (length == 0.0)
+			continue;
+
+		normal = { normal.x / length, normal.y / length, normal.z / length };
+		for (std::size_t k = 0; k < 3; k++)
+			quadrics[result[t + k]].add_plane(normal, -normal.dot(p0), length * 0.5);
+	}
+
+	const f64 errorLimit = f64(targetError) * f64(targetError);
+	f64 reachedError = 0.0;
+
+	Buffer<u32> adjacencyOffset;
+	Buffer<u32> adjacency;
+	Buffer<collapse> candidates;
+	Buffer<u8> touched;
+	Buffer<u32> remap;
+
+	while (result.size() > targetIndexCount) {
+		//vertex to triangle adjacency of the current level
+		adjacencyOffset.assign(vertexCount + 1, 0);
+		for (auto index : result)
+			adjacencyOffset[index + 1]++;
+		for (std::size_t v = 0; v < vertexCount; v++)
+			adjacencyOffset[v + 1] += adjacencyOffset[v];
+
+		adjacency.resize(result.size());
+		Buffer<u32> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+		for (std::size_t i = 0; i < result.size(); i++)
+			adjacency[fill[result[i]]++] = static_cast<u32>(i / 3);
+
+		candidates.clear();
+		for (std::size_t t = 0; t < result.size(); t += 3) {
+			for (std::size_t k = 0; k < 3; k++) {
+				const auto a = result[t + k];
+				const auto b = result[t + (k + 1) % 3];
+				for (auto [from, to] : { std::pair(a, b), std::pair(b, a) }) {
+					if (locked[from])
+						continue;
+
+					quadric q = quadrics[from];
+					q.add(quadrics[to]);
+					candidates.push_back({ from, to, q.error(positions[to]) + attribute_error(vertices[from], vertices[to]) });
+				}
+			}
+		}
+
+		std::sort(candidates.begin(), candidates.end(), [](const collapse& lhs, const collapse& rhs) {
+			return lhs.cost < rhs.cost || (lhs.cost == rhs.cost &&
+				(lhs.from < rhs.from || (lhs.from == rhs.from && lhs.to < rhs.to)));
+		});
+
+		touched.assign(vertexCount, 0);
+		remap.resize(vertexCount);
+		for (std::size_t v = 0; v < vertexCount; v++)
+			remap[v] = static_cast<u32>(v);
+
+		std::size_t remaining = result.size();
+		std::size_t collapses = 0;
+
+		for (const auto& c : candidates) {
+			if (c.cost > errorLimit || remaining <= targetIndexCount)
+				break;
+			if (touched[c.from] || touched[c.to])
+				continue;
+
+			//reject collapses that flip or degenerate a surviving triangle
+			bool flips = false;
+			std::size_t removed = 0;
+			for (auto a = adjacencyOffset[c.from]; a < adjacencyOffset[c.from + 1] && !flips; a++) {
+				const auto* tri = &result[adjacency[a] * 3];
+				if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) {
+					removed += 3;
+					continue;
+				}
+
+				vec3 p[3], moved[3];
+				for (std::size_t k = 0; k < 3; k++) {
+					p[k] = positions[tri[k]];
+					moved[k] = tri[k] == c.from ? positions[c.to] : p[k];
+				}
+
+				const auto before = (p[1] - p[0]).cross(p[2] - p[0]);
+				const auto after = (moved[1] - moved[0]).cross(moved[2] - moved[0]);
+				flips = after.dot(after) == 0.0 || before.dot(after) <= 0.0;
+			}
+
+			if (flips)
+				continue;
+
+			//the ring around the collapsed vertex changes shape, freeze it for this pass
+			for (auto a = adjacencyOffset[c.from]; a < adjacencyOffset[c.from + 1]; a++) {
+				const auto* tri = &result[adjacency[a] * 3];
+				touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+			}
+
+			remap[c.from] = c.to;
+			quadrics[c.to].add(quadrics[c.from]);
+			reachedError = std::max(reachedError, c.cost);
+			remaining -= removed;
+			collapses++;
+		}
+
+		if (collapses == 0)
+			break;
+
+		std::size_t write = 0;
+		for (std::size_t t = 0; t < result.size(); t += 3) {
+			const auto a = remap[result[t]], b = remap[result[t + 1]], c = remap[result[t + 2]];
+			if (a == b || b == c || a == c)
+				continue;
+			result[write++] = a;
+			result[write++] = b;
+			result[write++] = c;
+		}
+		result.resize(write);
+	}
+
+	if (resultError)
+		*resultError = static_cast<f32>(std::sqrt(reachedError));
+	return result;
+}
@@ -0,0 +1,43 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include "core\core.h"
+#include "core\non_copyable.h"
+#include "graphics\vulkan\resources\mesh.h"
+
+namespace redox {
+	//quadric error metric edge collapse (Garland & Heckbert 1997). vertices only
+	//collapse onto their neighbours, so every level indexes the original vertex data.
+	//vertices on open borders, attribute seams and non-manifold edges never move.
+	class MeshSimplifier : public NonCopyable {
+	public:
+		//stops at targetIndexCount or once the next collapse would exceed targetError,
+		//both relative to the radius of the vertex bounds. resultError receives the
+		//deviation actually reached.
+		static Buffer<u32> simplify(Span<const graphics::MeshVertex> vertices, Span<const u32> indices,
+			std::size_t targetIndexCount, f32 targetError, f32* resultError = nullptr);
+	};
+}
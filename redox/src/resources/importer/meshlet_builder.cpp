@@ -0,0 +1,213 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "meshlet_builder.h"
+
+#include <cstring> //std::memcpy
+#include <cmath> //std::sqrt
+#include <algorithm> //std::min, std::max
+#include <limits> //std::numeric_limits
+
+namespace {
+	using redox::u32;
+	using redox::f32;
+	using redox::math::Vec3f;
+
+	constexpr u32 invalid_index = ~0u;
+
+	Vec3f triangle_centroid(redox::Span<const redox::graphics::MeshVertex> vertices, const u32* triangle) {
+		return (vertices[triangle[0]].pos + vertices[triangle[1]].pos + vertices[triangle[2]].pos) / 3.0f;
+	}
+}
+
+redox::Buffer<redox::graphics::Meshlet> redox::MeshletBuilder::build(Span<const graphics::MeshVertex> vertices,
+	Span<u32> indices, u32 maxVertices, u32 maxTriangles) {
+
+	if (maxVertices < 3 || maxTriangles == 0)
+		throw Exception("invalid meshlet limits");
+
+	const auto triangleCount = indices.size() / 3;
+	const auto vertexCount = vertices.size();
+
+	Buffer<u32> adjacencyOffset(vertexCount + 1, 0);
+	for (auto index : indices)
+		adjacencyOffset[index + 1]++;
+	for (std::size_t v = 0; v < vertexCount; v++)
+		adjacencyOffset[v + 1] += adjacencyOffset[v];
+
+	Buffer<u32> adjacency(indices.size());
+	Buffer<u32> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+	for (std::size_t i = 0; i < indices.size(); i++)
+		adjacency[fill[indices[i]]++] = static_cast<u32>(i / 3);
+
+	Buffer<u8> emitted(triangleCount, 0);
+	Buffer<u8> member(vertexCount, 0);
+	Buffer<u32> meshletVertices;
+	Buffer<u32> output;
+	output.reserve(indices.size());
+
+	Buffer<graphics::Meshlet> meshlets;
+	std::size_t seed = 0;
+
+	while (true) {
+		while (seed < triangleCount && emitted[seed])
+			seed++;
+		if (seed == triangleCount)
+			break;
+
+		graphics::Meshlet meshlet{};
+		meshlet.indexOffset = static_cast<u32>(output.size());
+
+		Vec3f centroidSum;
+		u32 triangles = 0;
+		auto next = static_cast<u32>(seed);
+
+		while (next != invalid_index) {
+			const auto* triangle = &indices[next * 3];
+			emitted[next] = 1;
+			output.insert(output.end(), triangle, triangle + 3);
+			for (std::size_t k = 0; k < 3; k++) {
+				if (!member[triangle[k]]) {
+					member[triangle[k]] = 1;
+					meshletVertices.push_back(triangle[k]);
+				}
+			}
+
+			centroidSum = centroidSum + triangle_centroid(vertices, triangle);
+			if (++triangles == maxTriangles)
+				break;
+
+			const auto centroid = centroidSum / static_cast<f32>(triangles);
+			next = invalid_index;
+			u32 bestNew = 4;
+			f32 bestDistance = std::numeric_limits<f32>::max();
+
+			for (auto vertex : meshletVertices) {
+				for (auto a = adjacencyOffset[vertex]; a < adjacencyOffset[vertex + 1]; a++) {
+					const auto candidate = adjacency[a];
+					if (emitted[candidate])
+						continue;
+
+					const auto* t = &indices[candidate * 3];
+					const u32 added = !member[t[0]] + !member[t[1]] + !member[t[2]];
+					if (meshletVertices.size() + added > maxVertices || added > bestNew)
+						continue;
+
+					const auto offset = triangle_centroid(vertices, t) - centroid;
+					const auto distance = offset.dot(offset);
+					if (added < bestNew || distance < bestDistance) {
+						bestNew = added;
+						bestDistance = distance;
+						next = candidate;
+					}
+				}
+			}
+		}
+
+		for (auto vertex : meshletVertices)
+			member[vertex] = 0;
+		meshletVertices.clear();
+
+		meshlet.indexCount = static_cast<u32>(output.size()) - meshlet.indexOffset;
+		compute_bounds(vertices, Span<const u32>(output).subspan(meshlet.indexOffset, meshlet.indexCount), meshlet);
+		meshlets.push_back(meshlet);
+	}
+
+	std::memcpy(indices.data(), output.data(), output.size() * sizeof(u32));
+	return meshlets;
+}
+
+void redox::MeshletBuilder::compute_bounds(Span<const graphics::MeshVertex> vertices, Span<const u32> indices,
+	graphics::Meshlet& meshlet) {
+
+	meshlet.center = {};
+	meshlet.radius = 0.0f;
+	meshlet.coneApex = {};
+	meshlet.coneAxis = {};
+	meshlet.coneCutoff = 2.0f;
+	if (indices.empty())
+		return;
+
+	//sphere around the center of the box, good enough for clusters this small
+	Vec3f lower = vertices[indices[0]].pos;
+	Vec3f upper = lower;
+	for (auto index : indices) {
+		const auto& p = vertices[index].pos;
+		lower = { std::min(lower.x, p.x), std::min(lower.y, p.y), std::min(lower.z, p.z) };
+		upper = { std::max(upper.x, p.x), std::max(upper.y, p.y), std::max(upper.z, p.z) };
+	}
+
+	meshlet.center = (lower + upper) * 0.5f;
+	for (auto index : indices) {
+		const auto offset = vertices[index].pos - meshlet.center;
+		meshlet.radius = std::max(meshlet.radius, offset.length());
+	}
+
+	//cone around the average face normal, opened up to the widest face
+	Buffer<Vec3f> normals;
+	normals.reserve(indices.size() / 3);
+	Vec3f axis;
+	for (std::size_t t = 0; t < indices.size(); t += 3) {
+		const auto& p0 = vertices[indices[t]].pos;
+		auto normal = (vertices[indices[t + 1]].pos - p0).cross(vertices[indices[t + 2]].pos - p0);
+		const auto length = normal.length();
+		if (length == 0.0f)
+			continue;
+		normal = normal / length;
+		normals.push_back(normal);
+		axis = axis + normal;
+	}
+
+	const auto axisLength = axis.length();
+	if (normals.empty() || axisLength == 0.0f)
+		return;
+	axis = axis / axisLength;
+
+	f32 minDot = 1.0f;
+	for (const auto& normal : normals)
+		minDot = std::min(minDot, axis.dot(normal));
+
+	//faces wider than a hemisphere apart, some are always visible
+	if (minDot <= 0.1f)
+		return;
+
+	//move the apex back along the axis until it sits behind every face plane
+	f32 maxT = 0.0f;
+	std::size_t n = 0;
+	for (std::size_t t = 0; t < indices.size(); t += 3) {
+		const auto& p0 = vertices[indices[t]].pos;
+		auto normal = (vertices[indices[t + 1]].pos - p0).cross(vertices[indices[t + 2]].pos - p0);
+		if (normal.length() == 0.0f)
+			continue;
+
+		const auto& faceNormal = normals[n++];
+		const auto t0 = (meshlet.center - p0).dot(faceNormal) / axis.dot(faceNormal);
+		maxT = std::max(maxT, t0);
+	}
+
+	meshlet.coneApex = meshlet.center - axis * maxT;
+	meshlet.coneAxis = axis;
+	meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+}
@@ -0,0 +1,48 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include "core\core.h"
+#include "core\non_copyable.h"
+#include "graphics\vulkan\resources\mesh.h"
+
+namespace redox {
+	//groups triangles into meshlets by growing each one across shared vertices,
+	//preferring triangles that add the fewest new vertices, then the closest ones
+	class MeshletBuilder : public NonCopyable {
+	public:
+		static constexpr u32 MaxVertices = 64;
+		static constexpr u32 MaxTriangles = 124;
+
+		//reorders indices so every meshlet is a contiguous range. meshlet offsets
+		//are relative to the start of indices.
+		static Buffer<graphics::Meshlet> build(Span<const graphics::MeshVertex> vertices, Span<u32> indices,
+			u32 maxVertices = MaxVertices, u32 maxTriangles = MaxTriangles);
+
+		//bounding sphere and backface cone of the triangles in indices
+		static void compute_bounds(Span<const graphics::MeshVertex> vertices, Span<const u32> indices,
+			graphics::Meshlet& meshlet);
+	};
+}
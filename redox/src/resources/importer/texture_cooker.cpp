@@ -0,0 +1,379 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "texture_cooker.h"
+#include "core\utility.h"
+#include "core\string_format.h"
+
+#include <fstream> //std::ofstream
+#include <cstring> //std::memcpy, std::memcmp
+#include <cmath> //std::pow
+#include <algorithm> //std::max, std::find_if
+
+#pragma warning(push, 0)
+#include <thirdparty/stbimage/stb_image.h>
+#pragma warning(pop)
+
+namespace {
+	using redox::u8;
+	using redox::u32;
+	using redox::f32;
+	using redox::bc::Encoding;
+
+	static_assert(sizeof(redox::CookedTexture::Header) == 124, "dds header layout");
+
+	constexpr u32 DdsCaps = 0x1, DdsHeight = 0x2, DdsWidth = 0x4, DdsPixelFormat = 0x1000,
+		DdsMipMapCount = 0x20000, DdsLinearSize = 0x80000;
+	constexpr u32 DdsFourCC = 0x4;
+	constexpr u32 DdsCapsComplex = 0x8, DdsCapsTexture = 0x1000, DdsCapsMipMap = 0x400000;
+	constexpr u32 DdsDimensionTexture2D = 3;
+
+	//legacy headers written by older tools
+	constexpr u32 FourCCDXT1 = 0x31545844, FourCCDXT5 = 0x35545844,
+		FourCCATI2 = 0x32495441, FourCCBC5U = 0x55354342;
+
+	struct dxgi_entry {
+		u32 format;
+		Encoding encoding;
+		bool srgb;
+	};
+
+	constexpr dxgi_entry dxgi_formats[] = {
+		{ 28, Encoding::RGBA8, false }, { 29, Encoding::RGBA8, true },
+		{ 71, Encoding::BC1, false }, { 72, Encoding::BC1, true },
+		{ 77, Encoding::BC3, false }, { 78, Encoding::BC3, true },
+		{ 83, Encoding::BC5, false },
+		{ 98, Encoding::BC7, false }, { 99, Encoding::BC7, true },
+	};
+
+	//vulkan format numbers as stored by ktx2, BC1 is read with or without alpha
+	struct vk_entry {
+		u32 format;
+		Encoding encoding;
+		bool srgb;
+	};
+
+	constexpr vk_entry vk_formats[] = {
+		{ 37, Encoding::RGBA8, false }, { 43, Encoding::RGBA8, true },
+		{ 131, Encoding::BC1, false }, { 132, Encoding::BC1, true },
+		{ 133, Encoding::BC1, false }, { 134, Encoding::BC1, true },
+		{ 137, Encoding::BC3, false }, { 138, Encoding::BC3, true },
+		{ 141, Encoding::BC5, false },
+		{ 145, Encoding::BC7, false }, { 146, Encoding::BC7, true },
+	};
+
+	u32 full_chain(u32 width, u32 height) {
+		u32 levels = 1;
+		while ((width | height) > 1) {
+			width = std::max(1u, width / 2);
+			height = std::max(1u, height / 2);
+			levels++;
+		}
+		return levels;
+	}
+
+	struct srgb_table {
+		f32 toLinear[256];
+
+		srgb_table() {
+			for (u32 i = 0; i < 256; i++) {
+				const f32 c = i / 255.0f;
+				toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+			}
+		}
+
+		static u8 to_srgb(f32 linear) {
+			const f32 c = linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+			return static_cast<u8>(std::min(255.0f, std::max(0.0f, c * 255.0f + 0.5f)));
+		}
+	};
+}
+
+// CookedTexture
+
+redox::CookedTexture::CookedTexture(Span<const byte> blob) : _blob(blob) {
+	if (!is_cooked(blob))
+		throw Exception("not a dds or ktx2 texture");
+
+	if (std::memcmp(blob.data(), &Magic, sizeof(Magic)) == 0)
+		_parse_dds();
+	else
+		_parse_ktx2();
+}
+
+void redox::CookedTexture::_parse_dds() {
+	const auto* header = reinterpret_cast<const Header*>(_blob.data() + sizeof(u32));
+	std::size_t offset = sizeof(u32) + sizeof(Header);
+	if (header->size != sizeof(Header) || header->width == 0 || header->height == 0)
+		throw Exception("invalid dds header");
+
+	const auto fourCC = (header->format.flags & DdsFourCC) ? header->format.fourCC : 0;
+	if (fourCC == FourCCDX10) {
+		if (_blob.size() < offset + sizeof(HeaderDX10))
+			throw Exception("invalid dds header");
+
+		const auto* dx10 = reinterpret_cast<const HeaderDX10*>(_blob.data() + offset);
+		offset += sizeof(HeaderDX10);
+		if (dx10->resourceDimension != DdsDimensionTexture2D || dx10->arraySize > 1)
+			throw Exception("only single 2d dds textures are supported");
+
+		auto it = std::find_if(std::begin(dxgi_formats), std::end(dxgi_formats),
+			[dx10](const dxgi_entry& entry) { return entry.format == dx10->dxgiFormat; });
+		if (it == std::end(dxgi_formats))
+			throw Exception("unsupported dds format");
+		_encoding = it->encoding;
+		_srgb = it->srgb;
+	}
+	else if (fourCC == FourCCDXT1 || fourCC == FourCCDXT5 || fourCC == FourCCATI2 || fourCC == FourCCBC5U) {
+		_encoding = fourCC == FourCCDXT1 ? Encoding::BC1 : fourCC == FourCCDXT5 ? Encoding::BC3 : Encoding::BC5;
+		_srgb = false;
+	}
+	else {
+		throw Exception("unsupported dds format");
+	}
+
+	_width = header->width;
+	_height = header->height;
+	const auto levelCount = std::max(1u, header->mipMapCount);
+	if (levelCount > full_chain(_width, _height))
+		throw Exception("invalid dds mip count");
+
+	//levels follow the headers back to back
+	for (u32 i = 0; i < levelCount; i++) {
+		const auto width = std::max(1u, _width >> i);
+		const auto height = std::max(1u, _height >> i);
+		const auto size = bc::level_size(_encoding, width, height);
+		if (offset + size > _blob.size())
+			throw Exception("dds levels out of bounds");
+
+		_levels.push_back({ width, height, _blob.subspan(offset, size) });
+		offset += size;
+	}
+}
+
+void redox::CookedTexture::_parse_ktx2() {
+	if (_blob.size() < sizeof(KtxHeader))
+		throw Exception("invalid ktx2 header");
+
+	const auto* header = reinterpret_cast<const KtxHeader*>(_blob.data());
+	if (header->pixelWidth == 0 || header->pixelHeight == 0 || header->pixelDepth > 1 ||
+		header->layerCount > 1 || header->faceCount != 1)
+		throw Exception("only single 2d ktx2 textures are supported");
+
+	if (header->supercompressionScheme != 0)
+		throw Exception("supercompressed ktx2 textures are not supported");
+
+	auto it = std::find_if(std::begin(vk_formats), std::end(vk_formats),
+		[header](const vk_entry& entry) { return entry.format == header->vkFormat; });
+	if (it == std::end(vk_formats))
+		throw Exception("unsupported ktx2 format");
+	_encoding = it->encoding;
+	_srgb = it->srgb;
+
+	_width = header->pixelWidth;
+	_height = header->pixelHeight;
+
+	//zero asks the loader to generate the chain, only the base level is stored. it is
+	//not generated here, such textures are sampled without mips
+	const auto levelCount = std::max(1u, header->levelCount);
+	if (levelCount > full_chain(_width, _height) ||
+		sizeof(KtxHeader) + levelCount * sizeof(KtxLevel) > _blob.size())
+		throw Exception("invalid ktx2 level index");
+
+	//the level index is ordered base level first, the data itself smallest first
+	const auto* index = reinterpret_cast<const KtxLevel*>(_blob.data() + sizeof(KtxHeader));
+	for (u32 i = 0; i < levelCount; i++) {
+		const auto width = std::max(1u, _width >> i);
+		const auto height = std::max(1u, _height >> i);
+		if (index[i].byteLength != bc::level_size(_encoding, width, height) ||
+			index[i].byteOffset + index[i].byteLength > _blob.size())
+			throw Exception("ktx2 levels out of bounds");
+
+		_levels.push_back({ width, height,
+			_blob.subspan(static_cast<std::size_t>(index[i].byteOffset), static_cast<std::size_t>(index[i].byteLength)) });
+	}
+}
+
+bool redox::CookedTexture::is_cooked(Span<const byte> blob) {
+	if (blob.size() >= sizeof(Magic) + sizeof(Header) && std::memcmp(blob.data(), &Magic, sizeof(Magic)) == 0)
+		return true;
+	return blob.size() >= sizeof(KtxHeader) && std::memcmp(blob.data(), KtxIdentifier, sizeof(KtxIdentifier)) == 0;
+}
+
+redox::bc::Encoding redox::CookedTexture::encoding() const {
+	return _encoding;
+}
+
+bool redox::CookedTexture::srgb() const {
+	return _srgb;
+}
+
+redox::u32 redox::CookedTexture::width() const {
+	return _width;
+}
+
+redox::u32 redox::CookedTexture::height() const {
+	return _height;
+}
+
+redox::u32 redox::CookedTexture::level_count() const {
+	return static_cast<u32>(_levels.size());
+}
+
+redox::CookedTexture::Level redox::CookedTexture::level(u32 index) const {
+	if (index >= _levels.size())
+		throw Exception("texture level out of range");
+	return _levels[index];
+}
+
+redox::Span<const redox::byte> redox::CookedTexture::blob() const {
+	return _blob;
+}
+
+redox::u32 redox::CookedTexture::dxgi_format(bc::Encoding encoding, bool srgb) {
+	//BC5 has no srgb variant, it only stores linear data
+	if (encoding == bc::Encoding::BC5)
+		srgb = false;
+
+	for (const auto& entry : dxgi_formats) {
+		if (entry.encoding == encoding && entry.srgb == srgb)
+			return entry.format;
+	}
+	throw Exception("unknown texture encoding");
+}
+
+// TextureCooker
+
+redox::Buffer<redox::u8> redox::TextureCooker::downsample(Span<const u8> rgba, u32 width, u32 height, bool srgb) {
+	static const srgb_table table;
+
+	const auto targetWidth = std::max(1u, width / 2);
+	const auto targetHeight = std::max(1u, height / 2);
+	Buffer<u8> output(std::size_t(targetWidth) * targetHeight * 4);
+
+	for (u32 y = 0; y < targetHeight; y++) {
+		const u32 rows[] = { std::min(y * 2, height - 1), std::min(y * 2 + 1, height - 1) };
+		for (u32 x = 0; x < targetWidth; x++) {
+			const u32 columns[] = { std::min(x * 2, width - 1), std::min(x * 2 + 1, width - 1) };
+
+			f32 sum[4]{};
+			for (auto row : rows) {
+				for (auto column : columns) {
+					const auto* pixel = &rgba[(std::size_t(row) * width + column) * 4];
+					for (u32 c = 0; c < 4; c++)
+						sum[c] += srgb && c < 3 ? table.toLinear[pixel[c]] : pixel[c];
+				}
+			}
+
+			auto* target = &output[(std::size_t(y) * targetWidth + x) * 4];
+			for (u32 c = 0; c < 4; c++) {
+				target[c] = srgb && c < 3 ? srgb_table::to_srgb(sum[c] / 4.0f) :
+					static_cast<u8>(sum[c] / 4.0f + 0.5f);
+			}
+		}
+	}
+	return output;
+}
+
+redox::Buffer<redox::byte> redox::TextureCooker::cook(Span<const u8> rgba, u32 width, u32 height) {
+	return cook(rgba, width, height, Settings{});
+}
+
+redox::Buffer<redox::byte> redox::TextureCooker::cook(Span<const u8> rgba, u32 width, u32 height,
+	const Settings& settings) {
+
+	if (width == 0 || height == 0 || rgba.size() != std::size_t(width) * height * 4)
+		throw Exception("invalid texture dimensions");
+
+	const auto levelCount = settings.mipmaps ? full_chain(width, height) : 1u;
+
+	CookedTexture::Header header{};
+	header.size = sizeof(header);
+	header.flags = DdsCaps | DdsHeight | DdsWidth | DdsPixelFormat | DdsMipMapCount | DdsLinearSize;
+	header.width = width;
+	header.height = height;
+	header.pitchOrLinearSize = static_cast<u32>(bc::level_size(settings.encoding, width, height));
+	header.mipMapCount = levelCount;
+	header.format.size = sizeof(header.format);
+	header.format.flags = DdsFourCC;
+	header.format.fourCC = CookedTexture::FourCCDX10;
+	header.caps[0] = DdsCapsTexture | (levelCount > 1 ? DdsCapsComplex | DdsCapsMipMap : 0);
+
+	CookedTexture::HeaderDX10 dx10{};
+	dx10.dxgiFormat = CookedTexture::dxgi_format(settings.encoding, settings.srgb);
+	dx10.resourceDimension = DdsDimensionTexture2D;
+	dx10.arraySize = 1;
+
+	std::size_t size = sizeof(CookedTexture::Magic) + sizeof(header) + sizeof(dx10);
+	for (u32 i = 0; i < levelCount; i++)
+		size += bc::level_size(settings.encoding, std::max(1u, width >> i), std::max(1u, height >> i));
+
+	Buffer<byte> blob(size);
+	auto* output = blob.data();
+	std::memcpy(output, &CookedTexture::Magic, sizeof(CookedTexture::Magic));
+	std::memcpy(output + sizeof(CookedTexture::Magic), &header, sizeof(header));
+	std::memcpy(output + sizeof(CookedTexture::Magic) + sizeof(header), &dx10, sizeof(dx10));
+	output += sizeof(CookedTexture::Magic) + sizeof(header) + sizeof(dx10);
+
+	Buffer<u8> level;
+	Span<const u8> pixels = rgba;
+	for (u32 i = 0; i < levelCount; i++) {
+		if (i > 0) {
+			//each level is filtered from the previous one, not from the source
+			level = downsample(pixels, width, height, settings.srgb);
+			width = std::max(1u, width / 2);
+			height = std::max(1u, height / 2);
+			pixels = level;
+		}
+
+		bc::encode(settings.encoding, pixels.data(), width, height, output, settings.workers);
+		output += bc::level_size(settings.encoding, width, height);
+	}
+	return blob;
+}
+
+void redox::TextureCooker::cook(const Path& image, const Path& output) {
+	cook(image, output, Settings{});
+}
+
+void redox::TextureCooker::cook(const Path& image, const Path& output, const Settings& settings) {
+	int width, height, channels;
+	auto path = image.string();
+	auto* pixels = stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+	if (pixels == nullptr)
+		throw Exception(redox::format("failed to load image: {0}", stbi_failure_reason()));
+
+	RDX_SCOPE_GUARD([pixels]() {
+		stbi_image_free(pixels);
+	});
+
+	auto blob = cook({ pixels, std::size_t(width) * height * 4 },
+		static_cast<u32>(width), static_cast<u32>(height), settings);
+
+	std::ofstream file(output, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()));
+	if (!file.flush())
+		throw Exception("failed to write cooked texture");
+}
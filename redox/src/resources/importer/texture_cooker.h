@@ -0,0 +1,157 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#pragma once
+#include "core\core.h"
+#include "core\non_copyable.h"
+#include "platform\filesystem.h"
+#include "block_compression.h"
+
+namespace redox {
+	//view over a cooked texture, a DDS or KTX2 file with one 2d image and its mip chain.
+	//levels are stored as the GPU consumes them so each can be copied as is. the cooker
+	//writes DDS with the DX10 header. the blob must outlive the view.
+	class CookedTexture {
+	public:
+		struct PixelFormat {
+			u32 size;
+			u32 flags;
+			u32 fourCC;
+			u32 rgbBitCount;
+			u32 masks[4];
+		};
+
+		struct Header {
+			u32 size;
+			u32 flags;
+			u32 height;
+			u32 width;
+			u32 pitchOrLinearSize;
+			u32 depth;
+			u32 mipMapCount;
+			u32 reserved1[11];
+			PixelFormat format;
+			u32 caps[4];
+			u32 reserved2;
+		};
+
+		struct HeaderDX10 {
+			u32 dxgiFormat;
+			u32 resourceDimension;
+			u32 miscFlag;
+			u32 arraySize;
+			u32 miscFlags2;
+		};
+
+		struct KtxHeader {
+			byte identifier[12];
+			u32 vkFormat;
+			u32 typeSize;
+			u32 pixelWidth;
+			u32 pixelHeight;
+			u32 pixelDepth;
+			u32 layerCount;
+			u32 faceCount;
+			u32 levelCount;
+			u32 supercompressionScheme;
+			u32 dfdByteOffset;
+			u32 dfdByteLength;
+			u32 kvdByteOffset;
+			u32 kvdByteLength;
+			u64 sgdByteOffset;
+			u64 sgdByteLength;
+		};
+
+		struct KtxLevel {
+			u64 byteOffset;
+			u64 byteLength;
+			u64 uncompressedByteLength;
+		};
+
+		struct Level {
+			u32 width;
+			u32 height;
+			Span<const byte> data;
+		};
+
+		static constexpr u32 Magic = 0x20534444; //"DDS "
+		static constexpr u32 FourCCDX10 = 0x30315844; //"DX10"
+
+		static constexpr byte KtxIdentifier[12] = {
+			0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A //"«KTX 20»\r\n\x1A\n"
+		};
+
+		//validates the header and that every level lies within the blob
+		explicit CookedTexture(Span<const byte> blob);
+		static bool is_cooked(Span<const byte> blob);
+
+		bc::Encoding encoding() const;
+		bool srgb() const;
+		u32 width() const;
+		u32 height() const;
+		u32 level_count() const;
+		Level level(u32 index) const;
+		Span<const byte> blob() const;
+
+		static u32 dxgi_format(bc::Encoding encoding, bool srgb);
+
+	private:
+		void _parse_dds();
+		void _parse_ktx2();
+
+		Span<const byte> _blob;
+		bc::Encoding _encoding;
+		bool _srgb;
+		u32 _width;
+		u32 _height;
+		Buffer<Level> _levels;
+	};
+
+	//bakes images into cooked textures, decoding, mip filtering and block
+	//compression are done once offline instead of at every load
+	class TextureCooker : public NonCopyable {
+	public:
+		//bumped whenever the filters or encoders change their output
+		static constexpr u32 Version = 1;
+
+		struct Settings {
+			concurrency::WorkerPool* workers = nullptr;	//encodes block rows in parallel when set
+
+			bc::Encoding encoding = bc::Encoding::BC7;
+			bool srgb = true;		//color data, mips are filtered in linear space
+			bool mipmaps = true;
+		};
+
+		//rgba holds width * height RGBA8 pixels
+		static Buffer<byte> cook(Span<const u8> rgba, u32 width, u32 height, const Settings& settings);
+		static Buffer<byte> cook(Span<const u8> rgba, u32 width, u32 height);
+		//reads every format stb_image supports
+		static void cook(const Path& image, const Path& output, const Settings& settings);
+		static void cook(const Path& image, const Path& output);
+
+		//next level of a mip chain with a 2x2 box filter
+		static Buffer<u8> downsample(Span<const u8> rgba, u32 width, u32 height, bool srgb);
+	};
+}
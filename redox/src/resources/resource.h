@@ -38,11 +38,25 @@ namespace redox {
 		SCRIPT,
 		ENGINE
 	};
+
+	constexpr std::size_t ResourceGroupCount = 5;
+
+	//bytes kept alive by a resource, host memory (including staging copies) and device memory
+	struct ResourceSize {
+		u64 cpu;
+		u64 gpu;
+	};
 	
 	struct IResource {
 		virtual ~IResource() = default;
 		virtual void upload() = 0;
 		virtual ResourceGroup res_group() const = 0;
+
+		//measured when the resource enters the cache, changes after that are
+		//reported with ResourceManager::resized
+		virtual ResourceSize size() const {
+			return { 0, 0 };
+		}
 	};
 
 	template<class T>
@@ -51,10 +65,44 @@ namespace redox {
 	template<class T>
 	using WeakResourceHandle = WeakPtr<T>;
 
+	//cpu-side intermediate produced by IResourceFactory::decode
+	struct IResourcePayload {
+		virtual ~IResourcePayload() = default;
+
+		//payloads that started loads of their dependencies are finalized once they completed
+		virtual bool ready() const {
+			return true;
+		}
+	};
+
 	struct IResourceFactory {
 		virtual ~IResourceFactory() = default;
 		virtual ResourceHandle<IResource> load(const Path& path) = 0;
 		virtual bool supports_ext(const Path& ext) = 0;
+
+		//asynchronous loads are split in two: decode runs on a worker thread and must not
+		//touch the device, finalize runs on the main thread. decode may start the loads of
+		//dependencies with load_async, see IResourcePayload::ready.
+		//by default everything happens in finalize.
+		virtual UniquePtr<IResourcePayload> decode(const Path& /*path*/) {
+			return nullptr;
+		}
+
+		virtual ResourceHandle<IResource> finalize(const Path& path, UniquePtr<IResourcePayload> /*payload*/) {
+			return load(path);
+		}
+
+		//packed resources arrive as bytes that are only valid during the call,
+		//path is the virtual resource path used to resolve siblings.
+		virtual UniquePtr<IResourcePayload> decode(const Path& /*path*/, Span<const byte> /*data*/) {
+			throw Exception("factory cannot load packed resources");
+		}
+
+		//loose files with this extension need nothing but their bytes. asynchronous loads
+		//then read them through the batched reader and pass them to decode(path, data).
+		virtual bool decodes_from_memory(const Path& /*ext*/) {
+			return false;
+		}
 	};
 }
 
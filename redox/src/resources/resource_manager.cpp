@@ -25,37 +25,187 @@ SOFTWARE.
 */
 #include "resource_manager.h"
 #include "core/application.h"
+#include "platform/timer.h"
+
+#include <algorithm> //std::max, std::find, std::sort, std::remove_if
+#include <limits> //std::numeric_limits
+
+namespace {
+	//a packed resource root sits next to its directory, e.g. resources.rpak
+	redox::Path packed_root(redox::Path root) {
+		if (!root.has_filename())
+			root = root.parent_path();
+		return root += ".rpak";
+	}
+
+	//derived data lives next to the resources so the hot-reload monitor never sees it
+	redox::Path derived_root(redox::Path root) {
+		if (!root.has_filename())
+			root = root.parent_path();
+		return root += ".ddc";
+	}
+
+	constexpr redox::u64 DerivedDataCapacity = 1ull << 30;
+
+	//resources being created on this thread, innermost last
+	thread_local redox::Buffer<redox::StringId> creating;
+}
 
 redox::ResourceManager* redox::ResourceManager::instance() {
 	return Application::instance->resource_manager();
 }
 
-redox::ResourceManager::ResourceManager(const Path& builtinResources, const Path& appResources) :
+redox::ResourceManager::ResourceManager(const Path& builtinResources, const Path& appResources, bool hotReloading) :
 	_builtinResources(io::absolute(builtinResources)),
-	_appResources(io::absolute(appResources)) {
+	_appResources(io::absolute(appResources)),
+	_mainThread(std::this_thread::get_id()) {
 
 	RDX_LOG("Initializing Resource Manager...", ConsoleColor::GREEN);
-	auto config = Application::instance->config();
 
-	if (config->get("Resources", "HotReloading")) {
+	if (auto builtin = packed_root(_builtinResources); io::is_regular_file(builtin))
+		mount(builtin, "builtin:");
+	if (auto app = packed_root(_appResources); io::is_regular_file(app))
+		mount(app);
+
+	if (hotReloading) {
 		_monitor.emplace();
-		_monitor->subscribe([this](auto file, auto event) {
-			_event_resource_modified(file, event);
+		_monitor->subscribe_batch([this](const auto& changes) {
+			_event_resources_modified(changes);
 		});
-		_monitor->start(_appResources, io::ChangeEvents::FILE_MODIFIED);
+		//editors that save atomically replace the file instead of modifying it
+		_monitor->start(_appResources, io::ChangeEvents::FILE_MODIFIED | io::ChangeEvents::FILE_ADDED);
 		RDX_LOG("Hot-Reload enabled. Monitoring App resources...");
 	}
+
+	auto threads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+	_workers = make_unique<concurrency::WorkerPool>(threads);
+	_reader = make_unique<io::AsyncReader>(_workers.get());
+	_derivedData = make_unique<DerivedDataCache>(derived_root(_appResources), DerivedDataCapacity);
+}
+
+redox::ResourceManager::~ResourceManager() {
+	//drains queued reads and decodes, jobs that never got finalized break their promise
+	_reader.reset();
+	_workers.reset();
+	while (auto job = _finalizeQueue.pop())
+		delete job;
 }
 
 void redox::ResourceManager::clear_cache(ResourceGroup groups) {
 	RDX_LOG("Clearing resource cache...");
+	RDX_UNUSED(std::lock_guard(_resourcesMutex));
+
 	for (auto it = _cache.begin(); it != _cache.end();) {
-		if (util::check_flag(groups, it->second->res_group())) {
+		if (util::check_flag(groups, it->second.resource->res_group())) {
+			_cache_account(it->second.resource, it->second.size, false);
+			_cacheIds.erase(it->second.resource.get());
 			it = _cache.erase(it);
 		} else ++it;
 	}
 }
 
+void redox::ResourceManager::set_budget(ResourceGroup group, const Budget& budget) {
+	RDX_UNUSED(std::lock_guard(_resourcesMutex));
+	_groups[static_cast<std::size_t>(group)].budget = budget;
+}
+
+redox::ResourceManager::Stats redox::ResourceManager::stats(ResourceGroup group) const {
+	RDX_UNUSED(std::lock_guard(_resourcesMutex));
+	return _groups[static_cast<std::size_t>(group)].stats;
+}
+
+void redox::ResourceManager::resized(const IResource* resource) {
+	RDX_UNUSED(std::lock_guard(_resourcesMutex));
+	auto id = _cacheIds.find(resource);
+	if (id == _cacheIds.end())
+		return;
+
+	auto& entry = _cache.at(id->second);
+	_cache_account(entry.resource, entry.size, false);
+	entry.size = resource->size();
+	_cache_account(entry.resource, entry.size, true);
+}
+
+void redox::ResourceManager::next_frame() {
+	_frame++;
+	_enforce_budgets();
+}
+
+redox::ResourceHandle<redox::IResource> redox::ResourceManager::_cache_touch(cache_entry& entry) {
+	entry.lastUse = ++_useClock;
+	_groups[static_cast<std::size_t>(entry.resource->res_group())].stats.hits++;
+	return entry.resource;
+}
+
+redox::ResourceHandle<redox::IResource> redox::ResourceManager::_cache_insert(StringId id, ResourceHandle<IResource> resource) {
+	auto [it, inserted] = _cache.try_emplace(id);
+	if (!inserted)
+		return _cache_touch(it->second);
+
+	it->second = { std::move(resource), {}, ++_useClock };
+	it->second.size = it->second.resource->size();
+	_cacheIds[it->second.resource.get()] = id;
+	_cache_account(it->second.resource, it->second.size, true);
+	_groups[static_cast<std::size_t>(it->second.resource->res_group())].stats.misses++;
+	return it->second.resource;
+}
+
+void redox::ResourceManager::_cache_account(const ResourceHandle<IResource>& resource, const ResourceSize& size, bool add) {
+	auto& stats = _groups[static_cast<std::size_t>(resource->res_group())].stats;
+	if (add) {
+		stats.resources++;
+		stats.cpuBytes += size.cpu;
+		stats.gpuBytes += size.gpu;
+	}
+	else {
+		stats.resources--;
+		stats.cpuBytes -= size.cpu;
+		stats.gpuBytes -= size.gpu;
+	}
+}
+
+void redox::ResourceManager::_enforce_budgets() {
+	RDX_UNUSED(std::lock_guard(_resourcesMutex));
+
+	//the group totals are kept up to date, the cache is only walked for groups over their limit
+	for (std::size_t group = 0; group < ResourceGroupCount; group++) {
+		auto& state = _groups[group];
+		if (state.stats.cpuBytes <= state.budget.cpu && state.stats.gpuBytes <= state.budget.gpu)
+			continue;
+
+		//only the cache holds these, anything still referenced has to stay
+		Buffer<Hashmap<StringId, cache_entry>::iterator> candidates;
+		for (auto it = _cache.begin(); it != _cache.end(); ++it) {
+			if (static_cast<std::size_t>(it->second.resource->res_group()) == group && it->second.resource.use_count() == 1)
+				candidates.push_back(it);
+		}
+
+		std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+			return a->second.lastUse < b->second.lastUse;
+		});
+
+		for (auto it : candidates) {
+			if (state.stats.cpuBytes <= state.budget.cpu && state.stats.gpuBytes <= state.budget.gpu)
+				break;
+
+			RDX_LOG("Evicting {0}", ConsoleColor::GRAY, it->first.str());
+			_cache_account(it->second.resource, it->second.size, false);
+			state.stats.evictions++;
+			_cacheIds.erase(it->second.resource.get());
+			_evicted.emplace_back(_frame, std::move(it->second.resource));
+			_cache.erase(it);
+		}
+	}
+
+	_evicted.erase(std::remove_if(_evicted.begin(), _evicted.end(), [this](const auto& evicted) {
+		return evicted.first + EvictionDelay <= _frame;
+	}), _evicted.end());
+}
+
+redox::StringId redox::ResourceManager::make_id(const Path& path) {
+	return StringId(path.generic_string());
+}
+
 redox::Path redox::ResourceManager::resolve_path(const Path& path) const {
 	if (auto id = path.string(); id.find("builtin:") == 0) {
 		return _builtinResources / id.substr(8);
@@ -63,29 +213,251 @@ redox::Path redox::ResourceManager::resolve_path(const Path& path) const {
 	return _appResources / path;
 }
 
+void redox::ResourceManager::mount(const Path& archive, StringView prefix) {
+	auto mounted = make_unique<ResourceArchive>(archive);
+	RDX_LOG("Mounted {0} ({1} entries)", archive, mounted->entries().size());
+
+	RDX_UNUSED(std::lock_guard(_archiveMutex));
+	_archives.insert(_archives.begin(), { String(prefix), std::move(mounted) });
+}
+
+std::optional<redox::ResourceArchive::Data> redox::ResourceManager::read_packed(StringId id) {
+	const ResourceArchive* archive = nullptr;
+	auto entry = _find_packed(id, &archive);
+	if (entry == nullptr)
+		return std::nullopt;
+	return archive->read(*entry);
+}
+
+const redox::ResourceArchive::Entry* redox::ResourceManager::_find_packed(StringId id, const ResourceArchive** archive) {
+	//archives are never unmounted, entries stay valid once found
+	RDX_UNUSED(std::lock_guard(_archiveMutex));
+	auto name = id.str();
+	for (const auto& mounted : _archives) {
+		if (name.compare(0, mounted.prefix.size(), mounted.prefix) != 0)
+			continue;
+
+		if (auto entry = mounted.archive->find(name.substr(mounted.prefix.size()))) {
+			*archive = mounted.archive.get();
+			return entry;
+		}
+	}
+	return nullptr;
+}
+
 void redox::ResourceManager::register_factory(IResourceFactory* factory) {
+	RDX_UNUSED(std::lock_guard(_factoryMutex));
 	_factories.push_back(factory);
+	_factoryLookup.clear();
 }
 
 redox::IResourceFactory* redox::ResourceManager::_find_factory(const Path& ext) {
+	RDX_UNUSED(std::lock_guard(_factoryMutex));
+	StringId extId(ext.generic_string());
+	if (auto it = _factoryLookup.find(extId); it != _factoryLookup.end()) {
+		return it->second;
+	}
+
 	for (const auto& fac : _factories) {
 		if (fac->supports_ext(ext)) {
+			_factoryLookup[extId] = fac;
 			return fac;
 		}
 	}
 	return nullptr;
 }
 
-void redox::ResourceManager::_event_resource_modified(const Path& file, io::ChangeEvents event) {
-	std::lock_guard guard(_resourcesMutex);
-	if (auto cit = _cache.find(file); cit != _cache.end()) {
-		RDX_LOG("Resource {0} modified. Attempting to reload...", file);
-		auto nr = load(file);
-		onReloadResource(cit->second, nr);
+void redox::ResourceManager::_event_resources_modified(const Buffer<io::DirectoryWatcher::Change>& changes) {
+	//runs on the watcher thread, a save usually arrives as several events
+	const auto deadline = std::chrono::steady_clock::now() + ReloadDelay;
+
+	RDX_UNUSED(std::lock_guard(_reloadMutex));
+	for (const auto& change : changes) {
+		if (util::check_flag(change.events, io::ChangeEvents::FILE_MODIFIED) ||
+			util::check_flag(change.events, io::ChangeEvents::FILE_ADDED))
+			_pendingReloads[make_id(change.file)] = deadline;
+
+		//events were dropped, every loaded file is compared against the disk instead
+		if (util::check_flag(change.events, io::ChangeEvents::RESCAN)) {
+			RDX_LOG("Resource monitor overflowed, checking every loaded file...", ConsoleColor::GRAY);
+			for (auto& [id, writeTime] : _writeTimes) {
+				std::error_code ec;
+				auto current = io::last_write_time(resolve_path(Path(id.str())), ec);
+				if (!ec && current != writeTime) {
+					writeTime = current;
+					_pendingReloads[id] = deadline;
+				}
+			}
+		}
 	}
 }
 
-redox::ResourceHandle<redox::IResource> redox::ResourceManager::load(const Path& path) {
+void redox::ResourceManager::_record_write_time(StringId id, const Path& file) {
+	if (!_monitor)
+		return;
+
+	//taken before the file is read, a save during the load still counts as newer
+	std::error_code ec;
+	auto writeTime = io::last_write_time(file, ec);
+	if (!ec) {
+		RDX_UNUSED(std::lock_guard(_reloadMutex));
+		_writeTimes[id] = writeTime;
+	}
+}
+
+void redox::ResourceManager::_record_dependency(StringId id) {
+	if (creating.empty() || creating.back() == id)
+		return;
+
+	auto& dependents = _dependents[id];
+	if (std::find(dependents.begin(), dependents.end(), creating.back()) == dependents.end())
+		dependents.push_back(creating.back());
+}
+
+void redox::ResourceManager::add_dependency(const Path& file) {
+	//ids of loose files are relative to the app resources, files outside are not watched
+	auto root = _appResources;
+	if (!root.has_filename())
+		root = root.parent_path();
+	auto relative = io::absolute(file).lexically_normal().lexically_relative(root);
+	if (relative.empty() || *relative.begin() == "..")
+		return;
+
+	_record_write_time(make_id(relative), file);
+	RDX_UNUSED(std::lock_guard(_resourcesMutex));
+	_record_dependency(make_id(relative));
+}
+
+void redox::ResourceManager::_schedule_reloads() {
+	Buffer<StringId> due;
+	{
+		RDX_UNUSED(std::lock_guard(_reloadMutex));
+		const auto now = std::chrono::steady_clock::now();
+		for (auto it = _pendingReloads.begin(); it != _pendingReloads.end();) {
+			//a second reload of the same file waits for the first one to be swapped in
+			if (it->second <= now && _reloading.count(it->first) == 0) {
+				due.push_back(it->first);
+				it = _pendingReloads.erase(it);
+			} else ++it;
+		}
+	}
+
+	for (auto id : due) {
+		//files that are no resource themselves rebuild what depends on them
+		Buffer<StringId> dependents;
+		{
+			RDX_UNUSED(std::lock_guard(_resourcesMutex));
+			if (_cache.count(id) != 0)
+				dependents.push_back(id);
+			else if (auto dit = _dependents.find(id); dit != _dependents.end())
+				dependents = dit->second;
+		}
+
+		for (auto dependent : dependents) {
+			RDX_LOG("Resource {0} modified. Reloading {1}...", id.str(), dependent.str());
+			_reload(dependent);
+		}
+	}
+}
+
+void redox::ResourceManager::_reload(StringId id) {
+	{
+		RDX_UNUSED(std::lock_guard(_reloadMutex));
+		if (_reloading.count(id) != 0) {
+			_pendingReloads[id] = std::chrono::steady_clock::now();
+			return;
+		}
+		_reloading[id] = true;
+	}
+
+	//bypasses _inflight, loads of the id keep getting the cached version until the swap
+	auto job = new async_job();
+	job->id = id;
+	job->path = resolve_path(Path(id.str()));
+	job->reload = true;
+	_submit(job, LoadPriority::HIGH);
+}
+
+void redox::ResourceManager::_swap_reloaded(async_job* job, ResourceHandle<IResource> resource) {
+	{
+		RDX_UNUSED(std::lock_guard(_reloadMutex));
+		_reloading.erase(job->id);
+	}
+
+	if (job->error || !resource) {
+		//the loaded version stays in place until the next save
+		String reason = "resource could not be created";
+		try {
+			if (job->error)
+				std::rethrow_exception(job->error);
+		}
+		catch (const std::exception& e) {
+			reason = e.what();
+		}
+		RDX_LOG("Failed to reload {0}: {1}", ConsoleColor::RED, job->id.str(), reason);
+		return;
+	}
+
+	resource->upload();
+
+	ResourceHandle<IResource> old;
+	Buffer<StringId> dependents;
+	{
+		RDX_UNUSED(std::lock_guard(_resourcesMutex));
+		auto cit = _cache.find(job->id);
+		if (cit == _cache.end())
+			return;
+
+		_cache_account(cit->second.resource, cit->second.size, false);
+		old = std::exchange(cit->second.resource, resource);
+		cit->second.size = resource->size();
+		_cache_account(resource, cit->second.size, true);
+		_cacheIds.erase(old.get());
+		_cacheIds[resource.get()] = job->id;
+		if (auto dit = _dependents.find(job->id); dit != _dependents.end())
+			dependents = dit->second;
+	}
+
+	RDX_LOG("Reloaded {0}", ConsoleColor::GREEN, job->id.str());
+	onReloadResource(old, resource);
+
+	for (auto dependent : dependents)
+		_reload(dependent);
+}
+
+redox::ResourceHandle<redox::IResource> redox::ResourceManager::load(StringId id) {
+	std::unique_lock guard(_resourcesMutex);
+	_record_dependency(id);
+
+	if (auto cit = _cache.find(id); cit != _cache.end()) {
+		return _cache_touch(cit->second);
+	}
+
+	if (auto it = _inflight.find(id); it != _inflight.end()) {
+		auto future = it->second;
+		guard.unlock();
+		wait(future);
+		return future.get();
+	}
+
+	Path path(id.str());
+	if (auto packed = read_packed(id)) {
+		auto factory = _find_factory(path.extension());
+		if (factory == nullptr) {
+			throw Exception(redox::format("no suitable factory found for {0}",
+				path.extension()));
+		}
+
+		RDX_LOG("Loading {0} (packed)...", ConsoleColor::WHITE, path);
+		creating.push_back(id);
+		RDX_SCOPE_GUARD([]() { creating.pop_back(); });
+		auto resource = factory->finalize(path, factory->decode(path, packed->data()));
+		if (resource) {
+			resource = _cache_insert(id, std::move(resource));
+		}
+		return resource;
+	}
+
 	auto resolvedPath = resolve_path(path);
 	if (!io::is_regular_file(resolvedPath)) {
 		RDX_LOG("Resource does not exist: {0}", ConsoleColor::RED, path);
@@ -93,11 +465,6 @@ redox::ResourceHandle<redox::IResource> redox::ResourceManager::load(const Path&
 	}
 
 	RDX_LOG("Loading {0}...", ConsoleColor::WHITE, path);
-	RDX_UNUSED(std::lock_guard(_resourcesMutex));
-
-	if (auto cit = _cache.find(resolvedPath); cit != _cache.end()) {
-		return cit->second;
-	}
 
 	auto factory = _find_factory(resolvedPath.extension());
 	if (factory == nullptr) {
@@ -105,16 +472,19 @@ redox::ResourceHandle<redox::IResource> redox::ResourceManager::load(const Path&
 			resolvedPath.extension()));
 	}
 
+	_record_write_time(id, resolvedPath);
+	creating.push_back(id);
+	RDX_SCOPE_GUARD([]() { creating.pop_back(); });
 	auto resource = factory->load(resolvedPath);
 	if (resource) {
-		_cache[resolvedPath] = resource;
+		resource = _cache_insert(id, std::move(resource));
 	}
 	return resource;
 }
 
-redox::ResourceHandle<redox::IResource> redox::ResourceManager::load(const Path& path, const Path& fallback) {
-	
-	auto resource = load(path);
+redox::ResourceHandle<redox::IResource> redox::ResourceManager::load(StringId id, StringId fallback) {
+
+	auto resource = load(id);
 	if (resource) {
 		return resource;
 	}
@@ -126,3 +496,180 @@ redox::ResourceHandle<redox::IResource> redox::ResourceManager::load(const Path&
 
 	throw Exception("failed to load resources.");
 }
+
+redox::ResourceHandle<redox::IResource> redox::ResourceManager::load(const Path& path) {
+	return load(make_id(path));
+}
+
+redox::ResourceHandle<redox::IResource> redox::ResourceManager::load(const Path& path, const Path& fallback) {
+	return load(make_id(path), make_id(fallback));
+}
+
+redox::ResourceManager::future_type redox::ResourceManager::_load_async(StringId id, LoadPriority priority) {
+	RDX_UNUSED(std::lock_guard(_resourcesMutex));
+
+	if (auto cit = _cache.find(id); cit != _cache.end()) {
+		std::promise<ResourceHandle<IResource>> ready;
+		ready.set_value(_cache_touch(cit->second));
+		return ready.get_future().share();
+	}
+
+	if (auto it = _inflight.find(id); it != _inflight.end()) {
+		return it->second;
+	}
+
+	//owned by the pipeline until _finalize
+	auto job = new async_job();
+	job->id = id;
+	job->path = resolve_path(Path(id.str()));
+
+	auto future = job->promise.get_future().share();
+	_inflight[id] = future;
+	_submit(job, priority);
+	return future;
+}
+
+void redox::ResourceManager::_submit(async_job* job, LoadPriority priority) {
+	//a reload was triggered by the loose file, it shadows the packed entry it was cooked into
+	const ResourceArchive* archive = nullptr;
+	const bool loose = io::is_regular_file(job->path) && (job->reload || _find_packed(job->id, &archive) == nullptr);
+	if (loose)
+		_record_write_time(job->id, job->path);
+
+	//factories that only need the bytes get them from the reader, decode runs on the
+	//worker the read completes on. its completions do not know priorities.
+	auto factory = loose ? _find_factory(job->path.extension()) : nullptr;
+	if (factory != nullptr && factory->decodes_from_memory(job->path.extension())) {
+		io::ReadRequest request;
+		request.file = job->path;
+		request.callback = [this, job, factory](io::ReadResult& result) {
+			try {
+				if (!result.success)
+					throw Exception(redox::format("failed to read {0}", job->path));
+
+				RDX_LOG("Loading {0} (async)...", ConsoleColor::WHITE, job->id.str());
+				job->factory = factory;
+				job->payload = factory->decode(job->path, result.data);
+			}
+			catch (...) {
+				job->error = std::current_exception();
+			}
+			_finalizeQueue.push(job);
+		};
+		_reader->submit_reads({ &request, 1 });
+		return;
+	}
+
+	_workers->submit([this, job]() {
+		_decode(job);
+		_finalizeQueue.push(job);
+	}, priority);
+}
+
+void redox::ResourceManager::_decode(async_job* job) {
+	try {
+		//a reload was triggered by the loose file, it shadows the packed entry it was cooked into
+		std::optional<ResourceArchive::Data> packed;
+		if (!job->reload || !io::is_regular_file(job->path))
+			packed = read_packed(job->id);
+
+		if (packed) {
+			job->path = Path(job->id.str());
+			job->factory = _find_factory(job->path.extension());
+			if (job->factory == nullptr) {
+				throw Exception(redox::format("no suitable factory found for {0}",
+					job->path.extension()));
+			}
+
+			RDX_LOG("Loading {0} (packed, async)...", ConsoleColor::WHITE, job->id.str());
+			job->payload = job->factory->decode(job->path, packed->data());
+			return;
+		}
+
+		if (!io::is_regular_file(job->path)) {
+			RDX_LOG("Resource does not exist: {0}", ConsoleColor::RED, job->id.str());
+			return;
+		}
+
+		job->factory = _find_factory(job->path.extension());
+		if (job->factory == nullptr) {
+			throw Exception(redox::format("no suitable factory found for {0}",
+				job->path.extension()));
+		}
+
+		RDX_LOG("Loading {0} (async)...", ConsoleColor::WHITE, job->id.str());
+		job->payload = job->factory->decode(job->path);
+	}
+	catch (...) {
+		job->error = std::current_exception();
+	}
+}
+
+void redox::ResourceManager::_finalize(async_job* job) {
+	ResourceHandle<IResource> resource;
+	if (!job->error && job->factory != nullptr) {
+		creating.push_back(job->id);
+		RDX_SCOPE_GUARD([]() { creating.pop_back(); });
+		try {
+			resource = job->factory->finalize(job->path, std::move(job->payload));
+		}
+		catch (...) {
+			job->error = std::current_exception();
+		}
+	}
+
+	if (job->reload) {
+		_swap_reloaded(job, std::move(resource));
+		delete job;
+		return;
+	}
+
+	{
+		RDX_UNUSED(std::lock_guard(_resourcesMutex));
+		_inflight.erase(job->id);
+
+		//a synchronous load of the same id may have finished first
+		if (resource) {
+			resource = _cache_insert(job->id, std::move(resource));
+		}
+	}
+
+	if (job->error)
+		job->promise.set_exception(job->error);
+	else
+		job->promise.set_value(std::move(resource));
+
+	delete job;
+}
+
+void redox::ResourceManager::update(f64 budgetMs) {
+	_schedule_reloads();
+
+	//jobs still waiting for their dependencies go back in line
+	Buffer<async_job*> waiting;
+	platform::Timer timer;
+	while (timer.elapsed() < budgetMs) {
+		auto job = _finalizeQueue.pop();
+		if (job == nullptr)
+			break;
+
+		if (job->payload && !job->payload->ready())
+			waiting.push_back(job);
+		else
+			_finalize(job);
+	}
+
+	for (auto job : waiting)
+		_finalizeQueue.push(job);
+}
+
+void redox::ResourceManager::wait(const future_type& future) {
+	if (std::this_thread::get_id() != _mainThread) {
+		future.wait();
+		return;
+	}
+
+	while (future.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready) {
+		update(std::numeric_limits<f64>::max());
+	}
+}
@@ -30,44 +30,233 @@ SOFTWARE.
 #include <platform/filesystem.h>
 #include <core/logging/log.h>
 #include <core/event.h>
+#include <core/string_id.h>
+#include <core/concurrency/worker_pool.h>
+#include <core/concurrency/mpsc_queue.h>
+#include <platform/async_reader.h>
+#include <resources/archive.h>
+#include <resources/derived_data_cache.h>
 
 #include <platform/filesystem.h>
 #include <mutex> //std::mutex, std::lock_guard
 #include <optional> //std::optional
+#include <limits> //std::numeric_limits
+#include <future> //std::promise, std::shared_future
+#include <chrono> //std::chrono::steady_clock
 
 namespace redox {
+	using LoadPriority = concurrency::WorkerPool::Priority;
+
+	template<class R>
+	class ResourceFuture;
+
 	class ResourceManager : public NonCopyable {
 	public:
 		static ResourceManager* instance();
 			
-		ResourceManager(const Path& builtinResources, const Path& appResources);
-		~ResourceManager() = default;
+		//hotReloading watches appResources and swaps modified files in during update()
+		ResourceManager(const Path& builtinResources, const Path& appResources, bool hotReloading = false);
+		~ResourceManager();
+
+		struct Budget {
+			u64 cpu;
+			u64 gpu;
+		};
+
+		struct Stats {
+			u64 hits;
+			u64 misses;
+			u64 evictions;
+			u64 resources;
+			u64 cpuBytes;
+			u64 gpuBytes;
+		};
+
+		//groups are unlimited by default. once a group is over either limit, next_frame() evicts
+		//its least recently used resources that nothing outside the cache references.
+		void set_budget(ResourceGroup group, const Budget& budget);
+		Stats stats(ResourceGroup group) const;
+
+		//sizes are taken when a resource enters the cache or is reloaded, resources
+		//that grow or shrink while cached (streamed textures) report it here
+		void resized(const IResource* resource);
+
+		//evicted resources may still be used by frames in flight, they are
+		//released EvictionDelay frames later
+		static constexpr u64 EvictionDelay = 3;
+
+		//once per rendered frame, main thread only. enforces the budgets and releases
+		//evicted resources that are old enough.
+		void next_frame();
 
 		void clear_cache(ResourceGroup groups);
 		void register_factory(IResourceFactory* factory);
 
+		ResourceHandle<IResource> load(StringId id);
+		ResourceHandle<IResource> load(StringId id, StringId fallback);
 		ResourceHandle<IResource> load(const Path& path);
 		ResourceHandle<IResource> load(const Path& path, const Path& fallback);
 		Path resolve_path(const Path& path) const;
 
+		static StringId make_id(const Path& path);
+
+		//packed entries shadow loose files with the same id, later mounts shadow earlier ones.
+		//prefix is prepended to the entry names, e.g. "builtin:".
+		void mount(const Path& archive, StringView prefix = "");
+		std::optional<ResourceArchive::Data> read_packed(StringId id);
+
 		template<class R, class...Args>
 		ResourceHandle<R> load(Args&&...args) {
 			static_assert(std::is_base_of_v<IResource, R>, "<R> must be of type IResource");
 			return std::static_pointer_cast<R>(load(std::forward<Args>(args)...));
 		}
 
+		//returns immediately, the resource is decoded on a worker thread and created
+		//on the main thread during update(). concurrent requests for one id share a load.
+		//may be called from any thread, decode uses it to start loading dependencies.
+		template<class R>
+		ResourceFuture<R> load_async(StringId id, LoadPriority priority = LoadPriority::NORMAL) {
+			static_assert(std::is_base_of_v<IResource, R>, "<R> must be of type IResource");
+			return ResourceFuture<R>(_load_async(id, priority), this);
+		}
+
+		template<class R>
+		ResourceFuture<R> load_async(const Path& path, LoadPriority priority = LoadPriority::NORMAL) {
+			return load_async<R>(make_id(path), priority);
+		}
+
+		//finalizes decoded resources until the budget is spent, main thread only
+		void update(f64 budgetMs = 2.0);
+
+		using future_type = std::shared_future<ResourceHandle<IResource>>;
+		void wait(const future_type& future);
+
+		//decode workers, factories may fan out on them with WorkerPool::parallel_for
+		concurrency::WorkerPool& workers() const { return *_workers; }
+
+		//compiled shaders, cooked meshes and textures of loose files, survives restarts
+		DerivedDataCache& derived_data() const { return *_derivedData; }
+
+		//hot reloading: events for a file are debounced until it was quiet for ReloadDelay,
+		//the file is then decoded on the workers and swapped in by update() on the main thread.
+		//resources loaded while another one was created are its dependencies, reloading
+		//them rebuilds their dependents too (texture -> model).
+		static constexpr std::chrono::milliseconds ReloadDelay{ 150 };
+
+		//the resource being created was built from file as well, e.g. a shader include that
+		//is no resource itself. saving the file reloads the resource.
+		void add_dependency(const Path& file);
+
+		//fired on the main thread with the old and the new resource, listeners that keep
+		//the old one in flight on the GPU have to wait for it before letting go
 		Event<ResourceHandle<IResource>, ResourceHandle<IResource>> onReloadResource;
 
 	private:
+		struct async_job : concurrency::MpscNode {
+			StringId id;
+			Path path;
+			IResourceFactory* factory = nullptr;
+			UniquePtr<IResourcePayload> payload;
+			std::exception_ptr error;
+			std::promise<ResourceHandle<IResource>> promise;
+			bool reload = false;
+		};
+
 		IResourceFactory* _find_factory(const Path& ext);
-		void _event_resource_modified(const Path& file, io::ChangeEvents event);
+		void _event_resources_modified(const Buffer<io::DirectoryWatcher::Change>& changes);
+		void _record_dependency(StringId id);
+		void _record_write_time(StringId id, const Path& file);
+		void _schedule_reloads();
+		void _reload(StringId id);
+		void _swap_reloaded(async_job* job, ResourceHandle<IResource> resource);
+
+		future_type _load_async(StringId id, LoadPriority priority);
+		const ResourceArchive::Entry* _find_packed(StringId id, const ResourceArchive** archive);
+		void _submit(async_job* job, LoadPriority priority);
+		void _decode(async_job* job);
+		void _finalize(async_job* job);
+
+		struct cache_entry {
+			ResourceHandle<IResource> resource;
+			ResourceSize size;
+			u64 lastUse;
+		};
+
+		struct group_state {
+			Budget budget{ std::numeric_limits<u64>::max(), std::numeric_limits<u64>::max() };
+			Stats stats{};
+		};
+
+		//lookups and inserts keep the accounting, callers hold _resourcesMutex
+		ResourceHandle<IResource> _cache_touch(cache_entry& entry);
+		ResourceHandle<IResource> _cache_insert(StringId id, ResourceHandle<IResource> resource);
+		void _cache_account(const ResourceHandle<IResource>& resource, const ResourceSize& size, bool add);
+		void _enforce_budgets();
+
+		struct mounted_archive {
+			String prefix;
+			UniquePtr<ResourceArchive> archive;
+		};
 
 		Path _appResources;
 		Path _builtinResources;
 
-		std::recursive_mutex _resourcesMutex;
-		Hashmap<Path, ResourceHandle<IResource>> _cache;
+		std::mutex _archiveMutex;
+		Buffer<mounted_archive> _archives;
+
+		mutable std::recursive_mutex _resourcesMutex;
+		Hashmap<StringId, cache_entry> _cache;
+		Hashmap<const IResource*, StringId> _cacheIds;
+		Array<group_state, ResourceGroupCount> _groups;
+		u64 _useClock = 0;
+
+		u64 _frame = 0;
+		Buffer<std::pair<u64, ResourceHandle<IResource>>> _evicted;
+		Hashmap<StringId, Buffer<StringId>> _dependents;
+
+		std::mutex _reloadMutex;
+		Hashmap<StringId, std::chrono::steady_clock::time_point> _pendingReloads;
+		Hashmap<StringId, bool> _reloading;
+		//loose files that were loaded, compared against the disk when the monitor dropped events
+		Hashmap<StringId, io::file_time_type> _writeTimes;
+
+		std::mutex _factoryMutex;
+		Hashmap<StringId, IResourceFactory*> _factoryLookup;
 		Buffer<IResourceFactory*> _factories;
 		std::optional<io::DirectoryWatcher> _monitor;
+
+		std::thread::id _mainThread;
+		Hashmap<StringId, future_type> _inflight;
+		concurrency::MpscQueue<async_job> _finalizeQueue;
+		UniquePtr<concurrency::WorkerPool> _workers;
+		UniquePtr<io::AsyncReader> _reader;
+		UniquePtr<DerivedDataCache> _derivedData;
+	};
+
+	template<class R>
+	class ResourceFuture {
+	public:
+		ResourceFuture() = default;
+		ResourceFuture(ResourceManager::future_type future, ResourceManager* owner) :
+			_future(std::move(future)), _owner(owner) {}
+
+		bool valid() const {
+			return _future.valid();
+		}
+
+		bool ready() const {
+			return _future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+		}
+
+		//blocks until the load completes, pumps update() when called on the main thread.
+		//rethrows the exception of a failed load.
+		ResourceHandle<R> get() const {
+			_owner->wait(_future);
+			return std::static_pointer_cast<R>(_future.get());
+		}
+
+	private:
+		ResourceManager::future_type _future;
+		ResourceManager* _owner = nullptr;
 	};
 }
\ No newline at end of file
@@ -111,14 +111,27 @@ typedef struct cgltf_buffer_view
 	cgltf_buffer_view_type type;
 } cgltf_buffer_view;
 
+typedef struct cgltf_accessor_sparse
+{
+	cgltf_size count;
+	cgltf_buffer_view* indices_buffer_view;
+	cgltf_size indices_byte_offset;
+	cgltf_component_type indices_component_type;
+	cgltf_buffer_view* values_buffer_view;
+	cgltf_size values_byte_offset;
+} cgltf_accessor_sparse;
+
 typedef struct cgltf_accessor
 {
 	cgltf_component_type component_type;
+	cgltf_bool normalized;
 	cgltf_type type;
 	cgltf_size offset;
 	cgltf_size count;
 	cgltf_size stride;
 	cgltf_buffer_view* buffer_view;
+	cgltf_bool is_sparse;
+	cgltf_accessor_sparse sparse;
 } cgltf_accessor;
 
 typedef struct cgltf_attribute
@@ -745,6 +758,99 @@ static int cgltf_parse_json_meshes(cgltf_options* options, jsmntok_t const* toke
 	return i;
 }
 
+static cgltf_component_type cgltf_json_to_component_type(jsmntok_t const* tok, const uint8_t* json_chunk)
+{
+	switch (cgltf_json_to_int(tok, json_chunk))
+	{
+	case 5120:
+		return cgltf_component_type_r_8;
+	case 5121:
+		return cgltf_component_type_r_8u;
+	case 5122:
+		return cgltf_component_type_r_16;
+	case 5123:
+		return cgltf_component_type_r_16u;
+	case 5125:
+		return cgltf_component_type_r_32u;
+	case 5126:
+		return cgltf_component_type_r_32f;
+	default:
+		return cgltf_component_type_invalid;
+	}
+}
+
+static int cgltf_parse_json_accessor_sparse(jsmntok_t const* tokens, int i,
+				     const uint8_t* json_chunk, cgltf_accessor_sparse* out_sparse)
+{
+	CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+	out_sparse->indices_buffer_view = (void*)-1;
+	out_sparse->values_buffer_view = (void*)-1;
+
+	int size = tokens[i].size;
+	++i;
+
+	for (int j = 0; j < size; ++j)
+	{
+		if (cgltf_json_strcmp(tokens+i, json_chunk, "count") == 0)
+		{
+			++i;
+			out_sparse->count = cgltf_json_to_int(tokens+i, json_chunk);
+			++i;
+		}
+		else if (cgltf_json_strcmp(tokens+i, json_chunk, "indices") == 0
+			|| cgltf_json_strcmp(tokens+i, json_chunk, "values") == 0)
+		{
+			int indices = cgltf_json_strcmp(tokens+i, json_chunk, "indices") == 0;
+			++i;
+			CGLTF_CHECK_TOKTYPE(tokens[i], JSMN_OBJECT);
+
+			int fields = tokens[i].size;
+			++i;
+
+			for (int k = 0; k < fields; ++k)
+			{
+				if (cgltf_json_strcmp(tokens+i, json_chunk, "bufferView") == 0)
+				{
+					++i;
+					void* view = (void*)(size_t)cgltf_json_to_int(tokens+i, json_chunk);
+					if (indices)
+						out_sparse->indices_buffer_view = view;
+					else
+						out_sparse->values_buffer_view = view;
+					++i;
+				}
+				else if (cgltf_json_strcmp(tokens+i, json_chunk, "byteOffset") == 0)
+				{
+					++i;
+					cgltf_size offset = cgltf_json_to_int(tokens+i, json_chunk);
+					if (indices)
+						out_sparse->indices_byte_offset = offset;
+					else
+						out_sparse->values_byte_offset = offset;
+					++i;
+				}
+				else if (indices && cgltf_json_strcmp(tokens+i, json_chunk, "componentType") == 0)
+				{
+					++i;
+					out_sparse->indices_component_type = cgltf_json_to_component_type(tokens+i, json_chunk);
+					++i;
+				}
+				else
+				{
+					i = cgltf_skip_json(tokens, i+1);
+				}
+			}
+		}
+		else
+		{
+			i = cgltf_skip_json(tokens, i+1);
+		}
+	}
+
+	return i;
+}
+
 static int cgltf_parse_json_accessor(jsmntok_t const* tokens, int i,
 				     const uint8_t* json_chunk, cgltf_size accessor_index,
 				     cgltf_data* out_data)
@@ -776,34 +882,22 @@ static int cgltf_parse_json_accessor(jsmntok_t const* tokens, int i,
 		else if (cgltf_json_strcmp(tokens+i, json_chunk, "componentType") == 0)
 		{
 			++i;
-			int type = cgltf_json_to_int(tokens+i, json_chunk);
-			switch (type)
-			{
-			case 5120:
-				type = cgltf_component_type_r_8;
-				break;
-			case 5121:
-				type = cgltf_component_type_r_8u;
-				break;
-			case 5122:
-				type = cgltf_component_type_r_16;
-				break;
-			case 5123:
-				type = cgltf_component_type_r_16u;
-				break;
-			case 5125:
-				type = cgltf_component_type_r_32u;
-				break;
-			case 5126:
-				type = cgltf_component_type_r_32f;
-				break;
-			default:
-				type = cgltf_component_type_invalid;
-				break;
-			}
-			out_data->accessors[accessor_index].component_type = type;
+			out_data->accessors[accessor_index].component_type =
+					cgltf_json_to_component_type(tokens+i, json_chunk);
 			++i;
 		}
+		else if (cgltf_json_strcmp(tokens+i, json_chunk, "normalized") == 0)
+		{
+			++i;
+			out_data->accessors[accessor_index].normalized = cgltf_json_to_bool(tokens+i, json_chunk);
+			++i;
+		}
+		else if (cgltf_json_strcmp(tokens+i, json_chunk, "sparse") == 0)
+		{
+			out_data->accessors[accessor_index].is_sparse = 1;
+			i = cgltf_parse_json_accessor_sparse(tokens, i+1, json_chunk,
+					&out_data->accessors[accessor_index].sparse);
+		}
 		else if (cgltf_json_strcmp(tokens+i, json_chunk, "count") == 0)
 		{
 			++i;
@@ -1585,6 +1679,15 @@ cgltf_result cgltf_parse_json(cgltf_options* options, const uint8_t* json_chunk,
 		{
 			out_data->accessors[i].stride = cgltf_calc_size(out_data->accessors[i].type, out_data->accessors[i].component_type);
 		}
+
+		if (out_data->accessors[i].is_sparse)
+		{
+			cgltf_accessor_sparse* sparse = &out_data->accessors[i].sparse;
+			sparse->indices_buffer_view = sparse->indices_buffer_view == (void*)-1 ? NULL
+					: &out_data->buffer_views[(cgltf_size)sparse->indices_buffer_view];
+			sparse->values_buffer_view = sparse->values_buffer_view == (void*)-1 ? NULL
+					: &out_data->buffer_views[(cgltf_size)sparse->values_buffer_view];
+		}
 	}
 
 	for (cgltf_size i = 0; i < out_data->textures_count; ++i) 
@@ -275,3 +275,29 @@ int ini_sget(
   }
   return 1;
 }
+
+
+void ini_foreach(ini_t *ini, ini_callback_t callback, void *udata) {
+  const char *current_section = "";
+  char *val;
+  char *p = ini->data;
+
+  if (*p == '\0') {
+    p = next(ini, p);
+  }
+
+  while (p < ini->end) {
+    if (*p == '[') {
+      /* Handle section */
+      current_section = p + 1;
+
+    } else {
+      /* Handle key */
+      val = next(ini, p);
+      callback(current_section, p, val, udata);
+      p = val;
+    }
+
+    p = next(ini, p);
+  }
+}
@@ -35,4 +35,7 @@ void        ini_free(ini_t *ini);
 const char* ini_get(ini_t *ini, const char *section, const char *key);
 int         ini_sget(ini_t *ini, const char *section, const char *key, const char *scanfmt, void *dst);
 
+typedef void (*ini_callback_t)(const char *section, const char *key, const char *value, void *udata);
+void        ini_foreach(ini_t *ini, ini_callback_t callback, void *udata);
+
 #endif
@@ -6,8 +6,32 @@
 #pragma once
 
 #include <gtest/gtest.h>
+#include <fstream>
 #include "redox.h"
 
 #include "math/math.h"
 
-#include "core/meta/reflection.h"
\ No newline at end of file
+#include "core/meta/reflection.h"
+#include "core/profiling/histogram.h"
+
+#include "core/concurrency/spsc_queue.h"
+#include "core/concurrency/mpmc_queue.h"
+#include "core/concurrency/mpsc_queue.h"
+#include "core/concurrency/worker_pool.h"
+#include <thread>
+#include <condition_variable>
+#include <future>
+#include <random>
+#include <set>
+#include "platform/async_reader.h"
+#include "resources/archive.h"
+#include "resources/derived_data_cache.h"
+#include "core/compression/lz4.h"
+#include "resources/importer/mesh_cooker.h"
+#include "resources/importer/gltf_importer.h"
+#include "resources/importer/accessor_decoder.h"
+#include "graphics/vulkan/cluster_culling.h"
+#include "graphics/vulkan/resources/streaming_texture.h"
+#include "graphics/vulkan/resources/shader_compiler.h"
+#include "resources/resource_manager.h"
+#include "resources/importer/texture_cooker.h"
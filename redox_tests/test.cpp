@@ -67,6 +67,14 @@ TEST(Mat, Ops) {
 	ASSERT_FLOAT_EQ(sum[2].z, 4);
 	ASSERT_FLOAT_EQ(sum[3].w, 2);
 
+	auto product = redox::math::Mat44f::translate({ 1,2,3 }) * scm;
+	ASSERT_FLOAT_EQ(product[0].x, 3);
+	ASSERT_FLOAT_EQ(product[1].w, 2);
+	auto moved = product * redox::math::Vec4f(1, 1, 1, 1);
+	ASSERT_FLOAT_EQ(moved.x, 4);
+	ASSERT_FLOAT_EQ(moved.z, 6);
+	ASSERT_FLOAT_EQ(moved.w, 1);
+
 	redox::math::Mat44f ima({
 		1,0,0,1,
 		0,1,0,0,
@@ -76,4 +84,1415 @@ TEST(Mat, Ops) {
 	
 	//auto ivma = ima.inverse();
 
-}
\ No newline at end of file
+}
+
+namespace {
+	enum class TestMode { A, B };
+
+	struct TestInner {
+		int a;
+		float b;
+	};
+
+	struct TestSettings {
+		redox::math::Vec3f position;
+		TestMode mode;
+		TestInner inner;
+		bool flag;
+	};
+}
+
+TEST(Reflection, TypeHash) {
+	using namespace redox::reflection;
+
+	static_assert(type_hash_v<int> != type_hash_v<unsigned int>);
+	static_assert(type_hash_v<TestInner> == type_hash_v<TestInner>);
+	static_assert(std::is_same_v<hash_to_type<type_hash_v<float>>::type, float>);
+	static_assert(std::is_same_v<hash_to_type<type_hash_v<redox::math::Vec3f>>::type, redox::math::Vec3f>);
+
+	ASSERT_EQ(type_hash_v<TestMode>, redox::hash::fnv1a(type_name<TestMode>()));
+	ASSERT_NE(type_name<TestInner>().find("TestInner"), redox::StringView::npos);
+}
+
+TEST(Reflection, Fields) {
+	using namespace redox::reflection;
+
+	constexpr Reflect<TestSettings> reflect;
+	static_assert(reflect.field_count() == 4);
+	static_assert(reflect.layout_hash() != reflect.hash());
+
+	reflect.visit([](auto index, auto field) {
+		using type = typename decltype(field)::type;
+		switch (index) {
+		case 0: ASSERT_TRUE((std::is_same_v<type, redox::math::Vec3f>)); break;
+		case 1: ASSERT_TRUE((std::is_same_v<type, TestMode>)); break;
+		case 2: ASSERT_TRUE((std::is_same_v<type, TestInner>)); break;
+		case 3: ASSERT_TRUE((std::is_same_v<type, bool>)); break;
+		}
+	});
+
+	static_assert(Reflect<TestInner>{}.field_count() == 2);
+}
+
+namespace {
+	struct TestEngineSettings {
+		bool vsync;
+		redox::u32 maxFps;
+		redox::String name;
+		redox::f32 scale;
+	};
+}
+
+RDX_CONFIG_SCHEMA(TestEngineSettings, "Engine", "VSync", "MaxFPS", "Name", "Scale");
+
+TEST(Configuration, Lookup) {
+	auto file = std::filesystem::temp_directory_path() / "redox_test.ini";
+	{
+		std::ofstream ini(file);
+		ini << "[Engine]\nVSync = true\nMaxFPS = 144\nName = \"redox\"\nScale = 1.5\nFullscreen = yes\n";
+	}
+
+	redox::Configuration config(file);
+	ASSERT_EQ(config.get("Engine", "MaxFPS").as<redox::u32>(), 144u);
+	ASSERT_EQ(config.get("engine", "maxfps").as<redox::u32>(), 144u);
+	ASSERT_EQ(config.get(redox::Configuration::make_key("Engine", "VSync")).as<bool>(), true);
+	ASSERT_THROW(config.get("Engine", "Missing"), redox::Exception);
+	ASSERT_THROW(config.get("Engine", "Fullscreen").as<bool>(), redox::Exception);
+	ASSERT_EQ(config.get("Engine", "Fullscreen").as<redox::String>(), "yes");
+
+	auto settings = config.get<TestEngineSettings>();
+	ASSERT_TRUE(settings.vsync);
+	ASSERT_EQ(settings.maxFps, 144u);
+	ASSERT_EQ(settings.name, "redox");
+	ASSERT_FLOAT_EQ(settings.scale, 1.5f);
+}
+
+TEST(StringId, Intern) {
+	redox::StringId a("textures/albedo.png");
+	redox::StringId b(redox::String("textures/albedo.png"));
+	redox::StringId c("textures/normal.png");
+
+	ASSERT_EQ(a, b);
+	ASSERT_NE(a, c);
+	ASSERT_EQ(a.hash(), redox::hash::fnv1a("textures/albedo.png"));
+	ASSERT_EQ(a.str(), "textures/albedo.png");
+	ASSERT_FALSE(redox::StringId().valid());
+}
+
+TEST(Timer, Histogram) {
+	redox::platform::Timer timer;
+	auto t0 = timer.ticks();
+	ASSERT_GE(timer.ticks(), t0);
+	ASSERT_GT(timer.freq(), 0.0);
+
+	redox::Histogram histogram;
+	for (redox::u64 ns = 1; ns <= 1000; ++ns)
+		histogram.record(ns);
+
+	ASSERT_EQ(histogram.count(), 1000u);
+	ASSERT_EQ(histogram.min(), 1u);
+	ASSERT_EQ(histogram.max(), 1000u);
+	ASSERT_DOUBLE_EQ(histogram.mean(), 500.5);
+	ASSERT_NEAR(static_cast<double>(histogram.percentile(0.5)), 500.0, 500.0 / redox::Histogram::SubBuckets);
+	ASSERT_EQ(histogram.percentile(1.0), 1000u);
+
+	for (redox::u64 v : { 0ull, 3ull, 4ull, 7ull, 1023ull, 1024ull, ~0ull }) {
+		auto index = redox::Histogram::index_of(v);
+		ASSERT_LE(redox::Histogram::lower_bound(index), v);
+		if (index + 1 < redox::Histogram::BucketCount) {
+			ASSERT_LT(v, redox::Histogram::lower_bound(index + 1));
+		}
+	}
+
+	{
+		redox::ScopedTimer scoped(histogram);
+	}
+	ASSERT_EQ(histogram.count(), 1001u);
+}
+
+TEST(Concurrency, SpscQueue) {
+	constexpr redox::u64 count = 1000000;
+	redox::concurrency::SpscQueue<redox::u64> queue(1000);
+	ASSERT_EQ(queue.capacity(), 1024u);
+
+	std::thread producer([&] {
+		for (redox::u64 i = 0; i < count; ++i)
+			while (!queue.try_push(i))
+				std::this_thread::yield();
+	});
+
+	redox::u64 expected = 0, value;
+	while (expected < count) {
+		if (queue.try_pop(value)) {
+			ASSERT_EQ(value, expected++);
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+
+	producer.join();
+	ASSERT_FALSE(queue.try_pop(value));
+}
+
+TEST(Concurrency, MpmcQueue) {
+	constexpr redox::u64 perThread = 250000;
+	constexpr redox::u32 threads = 4;
+	redox::concurrency::MpmcQueue<redox::u64> queue(256);
+
+	std::atomic<redox::u64> sum{ 0 }, popped{ 0 };
+	redox::Buffer<std::thread> workers;
+
+	for (redox::u32 t = 0; t < threads; ++t) {
+		workers.emplace_back([&] {
+			for (redox::u64 i = 1; i <= perThread; ++i)
+				while (!queue.try_push(i))
+					std::this_thread::yield();
+		});
+		workers.emplace_back([&] {
+			redox::u64 value;
+			while (popped.load() < threads * perThread) {
+				if (queue.try_pop(value)) {
+					sum += value;
+					++popped;
+				}
+				else {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	for (auto& w : workers)
+		w.join();
+
+	ASSERT_EQ(sum.load(), threads * perThread * (perThread + 1) / 2);
+}
+
+TEST(Concurrency, MpscQueue) {
+	struct Item : redox::concurrency::MpscNode {
+		redox::u32 producer;
+		redox::u32 sequence;
+	};
+
+	constexpr redox::u32 perThread = 100000;
+	constexpr redox::u32 threads = 4;
+	redox::Buffer<Item> items(perThread * threads);
+	redox::concurrency::MpscQueue<Item> queue;
+
+	redox::Buffer<std::thread> producers;
+	for (redox::u32 t = 0; t < threads; ++t) {
+		producers.emplace_back([&, t] {
+			for (redox::u32 i = 0; i < perThread; ++i) {
+				auto& item = items[t * perThread + i];
+				item.producer = t;
+				item.sequence = i;
+				queue.push(&item);
+			}
+		});
+	}
+
+	redox::Array<redox::u32, threads> next{};
+	for (redox::u32 received = 0; received < perThread * threads;) {
+		if (auto* item = queue.pop()) {
+			ASSERT_EQ(item->sequence, next[item->producer]++);
+			++received;
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+
+	for (auto& p : producers)
+		p.join();
+	ASSERT_TRUE(queue.empty());
+}
+
+TEST(Concurrency, DISABLED_QueueThroughput) {
+	constexpr redox::u64 count = 10000000;
+
+	auto run = [](const char* name, auto& queue) {
+		redox::platform::Timer timer;
+		std::thread producer([&] {
+			for (redox::u64 i = 0; i < count; ++i)
+				while (!queue.try_push(i))
+					std::this_thread::yield();
+		});
+
+		redox::u64 value;
+		for (redox::u64 i = 0; i < count;) {
+			if (queue.try_pop(value))
+				++i;
+			else
+				std::this_thread::yield();
+		}
+
+		producer.join();
+		std::printf("%s: %.1f Mops/s\n", name, count / timer.elapsed() / 1000.0);
+	};
+
+	redox::concurrency::SpscQueue<redox::u64> spsc(4096);
+	redox::concurrency::MpmcQueue<redox::u64> mpmc(4096);
+	run("spsc", spsc);
+	run("mpmc", mpmc);
+}
+
+TEST(Concurrency, WorkerPool) {
+	std::atomic<redox::u32> done{ 0 };
+	{
+		redox::concurrency::WorkerPool pool(3, 64);
+		ASSERT_EQ(pool.size(), 3u);
+
+		for (redox::u32 i = 0; i < 1000; ++i) {
+			auto priority = static_cast<redox::concurrency::WorkerPool::Priority>(i % 3);
+			pool.submit([&done]() { ++done; }, priority);
+		}
+	}
+	ASSERT_EQ(done.load(), 1000u);
+
+	//nested fan-out from the only worker still completes, the caller does the work itself
+	redox::concurrency::WorkerPool pool(1);
+	std::atomic<redox::u32> sum{ 0 };
+	std::promise<void> nested;
+	pool.submit([&]() {
+		pool.parallel_for(100, [&sum](std::size_t i) { sum += static_cast<redox::u32>(i); });
+		nested.set_value();
+	});
+	nested.get_future().wait();
+	ASSERT_EQ(sum.load(), 4950u);
+
+	//a worker flooding its own full queue runs the overflow itself
+	std::atomic<redox::u32> spilled{ 0 };
+	{
+		redox::concurrency::WorkerPool small(1, 2);
+		std::promise<void> flooded;
+		small.submit([&]() {
+			for (redox::u32 i = 0; i < 64; ++i)
+				small.submit([&spilled]() { ++spilled; });
+			flooded.set_value();
+		});
+		ASSERT_EQ(flooded.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+	}
+	ASSERT_EQ(spilled.load(), 64u);
+
+	ASSERT_THROW(pool.parallel_for(10, [](std::size_t i) {
+		if (i == 5) throw redox::Exception("failed");
+	}), redox::Exception);
+}
+
+TEST(Filesystem, MappedFile) {
+	auto file = std::filesystem::temp_directory_path() / "redox_mapped.bin";
+	{
+		std::ofstream out(file, std::ios::binary);
+		for (int i = 0; i < 10000; ++i)
+			out.put(static_cast<char>(i & 0xff));
+	}
+
+	redox::io::MappedFile mapped(file, redox::io::MappedFile::Advice::SEQUENTIAL);
+	auto data = mapped.data();
+	ASSERT_EQ(data.size(), 10000u);
+	ASSERT_EQ(data[4097], 4097 & 0xff);
+
+	mapped.advise(redox::io::MappedFile::Advice::WILLNEED, 4097, 100);
+	auto tail = data.subspan(9990);
+	ASSERT_EQ(tail.size(), 10u);
+	ASSERT_EQ(tail[0], 9990 & 0xff);
+
+	auto empty = std::filesystem::temp_directory_path() / "redox_empty.bin";
+	std::ofstream{ empty };
+	ASSERT_TRUE(redox::io::MappedFile(empty).data().empty());
+	ASSERT_THROW(redox::io::MappedFile(file.string() + ".missing"), redox::Exception);
+}
+
+TEST(Filesystem, AsyncReader) {
+	using redox::io::AsyncReader;
+	auto file = std::filesystem::temp_directory_path() / "redox_async.bin";
+	constexpr std::size_t size = 5 * 1024 * 1024 + 123;
+	{
+		std::ofstream out(file, std::ios::binary);
+		for (std::size_t i = 0; i < size; ++i)
+			out.put(static_cast<char>(i % 251));
+	}
+
+	redox::concurrency::WorkerPool completions(2);
+	for (auto backend : { AsyncReader::Backend::AUTO, AsyncReader::Backend::FALLBACK }) {
+		AsyncReader::Settings settings;
+		settings.backend = backend;
+		settings.queueDepth = 2;
+		AsyncReader reader(&completions, settings);
+
+		redox::Buffer<redox::byte> target(1000);
+		std::atomic<redox::u32> verified{ 0 }, failed{ 0 };
+		auto check = [&](redox::u64 offset, redox::u64 expected) {
+			return [&, offset, expected](redox::io::ReadResult& result) {
+				bool ok = result.success && result.data.size() == expected;
+				for (std::size_t i = 0; ok && i < result.data.size(); ++i)
+					ok = result.data[i] == (offset + i) % 251;
+				(ok ? verified : failed)++;
+			};
+		};
+
+		redox::Buffer<redox::io::ReadRequest> requests(5);
+		requests[0] = { file, 0, 0, {}, check(0, size) };
+		requests[1] = { file, 4096, 8192, {}, check(4096, 8192) };
+		requests[2] = { file, size - 10, 100, {}, check(size - 10, 10) };
+		requests[3] = { file, 777, 1000, { target.data(), target.size() }, check(777, 1000) };
+		requests[4].file = file.string() + ".missing";
+		requests[4].callback = [&](redox::io::ReadResult& result) {
+			(result.success ? failed : verified)++;
+		};
+
+		redox::Buffer<redox::Span<redox::byte>> pinned = { { target.data(), target.size() } };
+		reader.register_buffers(pinned);
+		reader.submit_reads(requests);
+		reader.wait_idle();
+		ASSERT_EQ(verified.load(), 5u);
+		ASSERT_EQ(failed.load(), 0u);
+	}
+}
+
+TEST(Resources, Archive) {
+	using redox::ResourceArchive;
+	redox::Buffer<redox::byte> text, noise(3000);
+	for (int i = 0; i < 2000; ++i)
+		text.push_back(static_cast<redox::byte>("redox archive "[i % 14]));
+	redox::u32 seed = 2463534242u;
+	for (auto& b : noise) {
+		seed ^= seed << 13, seed ^= seed >> 17, seed ^= seed << 5;
+		b = static_cast<redox::byte>(seed);
+	}
+
+	redox::Buffer<redox::byte> packed, unpacked(text.size());
+	redox::compression::lz4::compress(text, packed);
+	ASSERT_LT(packed.size(), text.size());
+	ASSERT_TRUE(redox::compression::lz4::decompress(packed, unpacked));
+	ASSERT_EQ(unpacked, text);
+	ASSERT_FALSE(redox::compression::lz4::decompress(redox::Span<const redox::byte>(packed).subspan(0, packed.size() / 2), unpacked));
+
+	auto file = std::filesystem::temp_directory_path() / "redox_test.rpak";
+	redox::ArchiveBuilder builder;
+	builder.add("models/text.gltf", text);
+	builder.add("builtin/noise.bin", noise);
+	builder.add("empty.txt", {}, ResourceArchive::Codec::NONE);
+	builder.write(file);
+
+	ResourceArchive archive(file);
+	ASSERT_EQ(archive.entries().size(), 3u);
+	ASSERT_EQ(archive.find("missing.bin"), nullptr);
+
+	auto entry = archive.find("models/text.gltf");
+	ASSERT_NE(entry, nullptr);
+	ASSERT_EQ(entry->codec, ResourceArchive::Codec::LZ4);
+	ASSERT_EQ(entry->offset % ResourceArchive::Alignment, 0u);
+	ASSERT_TRUE(archive.verify(*entry));
+	auto data = archive.read(*entry);
+	ASSERT_TRUE(std::equal(text.begin(), text.end(), data.data().begin(), data.data().end()));
+
+	entry = archive.find("builtin/noise.bin");
+	ASSERT_NE(entry, nullptr);
+	ASSERT_EQ(entry->codec, ResourceArchive::Codec::NONE);
+	ASSERT_EQ(archive.name(*entry), "builtin/noise.bin");
+	ASSERT_TRUE(archive.verify(*entry));
+	ASSERT_TRUE(archive.read(*archive.find("empty.txt")).data().empty());
+
+	//slots pointing past the entries and tables without a free slot are rejected
+	auto corrupt = [&file](auto patch) {
+		auto copy = std::filesystem::temp_directory_path() / "redox_corrupt.rpak";
+		std::filesystem::copy_file(file, copy, std::filesystem::copy_options::overwrite_existing);
+		ResourceArchive::Header header;
+		std::fstream stream(copy, std::ios::binary | std::ios::in | std::ios::out);
+		stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+		patch(stream, header);
+		stream.close();
+		return copy;
+	};
+
+	ASSERT_THROW(ResourceArchive(corrupt([](std::fstream& stream, ResourceArchive::Header& header) {
+		const redox::u32 index = header.entryCount + 1;
+		stream.seekp(static_cast<std::streamoff>(header.tocOffset + header.entryCount * sizeof(ResourceArchive::Entry)));
+		stream.write(reinterpret_cast<const char*>(&index), sizeof(index));
+	})), redox::Exception);
+
+	ASSERT_THROW(ResourceArchive(corrupt([](std::fstream& stream, ResourceArchive::Header& header) {
+		header.entryCount = header.slotCount;
+		stream.seekp(0);
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	})), redox::Exception);
+}
+
+TEST(Resources, DerivedDataCache) {
+	using redox::DerivedDataCache;
+	auto dir = std::filesystem::temp_directory_path() / "redox_ddc";
+	std::filesystem::remove_all(dir);
+
+	const redox::Buffer<redox::byte> source(64, 7), artifact(40, 1);
+	const auto a = DerivedDataCache::make_key(source, "tool/1");
+	const auto b = DerivedDataCache::make_key(source, "tool/2");
+	const auto c = DerivedDataCache::make_key(source, "tool/1", "-O");
+	ASSERT_NE(a, b);
+	ASSERT_NE(a, c);
+	{
+		DerivedDataCache cache(dir, 100);
+		ASSERT_FALSE(cache.find(a));
+		auto stored = cache.store(a, artifact);
+		ASSERT_EQ(cache.find(a), stored);
+		ASSERT_EQ(std::filesystem::file_size(stored), artifact.size());
+
+		//a is used again after b was stored, so b is the one evicted for c
+		cache.store(b, artifact);
+		ASSERT_TRUE(cache.find(a));
+		cache.store(c, [](const redox::Path& output) {
+			std::ofstream(output, std::ios::binary) << redox::String(40, 'c');
+		});
+		ASSERT_FALSE(cache.find(b));
+		ASSERT_EQ(cache.size(), 80u);
+
+		ASSERT_THROW(cache.store(b, [](const redox::Path&) { throw redox::Exception("tool failed"); }), redox::Exception);
+		ASSERT_FALSE(cache.find(b));
+
+		//a mapped artifact stays readable once evicted, one removed behind the cache's back is a miss
+		auto mapped = cache.map(a);
+		ASSERT_TRUE(mapped);
+		cache.store(b, artifact);
+		ASSERT_FALSE(cache.find(c));
+		ASSERT_EQ(mapped->size(), artifact.size());
+		ASSERT_EQ(mapped->data()[0], artifact[0]);
+
+		std::filesystem::remove(cache.find(b).value());
+		ASSERT_FALSE(cache.map(b));
+		ASSERT_FALSE(cache.find(b));
+		ASSERT_EQ(cache.size(), 40u);
+		cache.store(c, artifact);
+	}
+
+	//nothing but the two artifacts is left behind, and they survive a restart
+	ASSERT_EQ(std::distance(std::filesystem::directory_iterator(dir), std::filesystem::directory_iterator()), 2);
+
+	//a crashed writer's staging file is swept, one another process is still writing is not
+	const auto stale = dir / "0000000000000001.0000000000000001.tmp";
+	const auto live = dir / "0000000000000002.0000000000000002.tmp";
+	std::ofstream(stale) << "stale";
+	std::ofstream(live) << "live";
+	std::filesystem::last_write_time(stale, std::filesystem::file_time_type::clock::now() - std::chrono::hours(2));
+
+	DerivedDataCache reopened(dir, 100);
+	ASSERT_FALSE(std::filesystem::exists(stale));
+	ASSERT_TRUE(std::filesystem::exists(live));
+	ASSERT_EQ(reopened.size(), 80u);
+	ASSERT_TRUE(reopened.find(a));
+	ASSERT_TRUE(reopened.find(c));
+	std::filesystem::remove_all(dir);
+}
+
+namespace {
+	//glTF document with one triangle list mesh, accessor 0 holds vertexCount positions and
+	//accessor 1 the u16 (or u32) indices right behind them in buffer 0.
+	//buffer are the members of the buffer object besides byteLength.
+	redox::String make_test_gltf(redox::StringView buffer, redox::u32 vertexCount, redox::u32 indexCount, bool wideIndices = false,
+		redox::StringView primitives = R"({ "attributes": { "POSITION": 0 }, "indices": 1, "mode": 4 })") {
+
+		const auto positionBytes = vertexCount * 3 * sizeof(float);
+		const auto indexBytes = indexCount * (wideIndices ? 4 : 2);
+		return redox::String(R"({
+			"asset": { "version": "2.0" },
+			"buffers": [ { )") + redox::String(buffer) + R"("byteLength": )" + std::to_string(positionBytes + indexBytes) + R"( } ],
+			"bufferViews": [
+				{ "buffer": 0, "byteOffset": 0, "byteLength": )" + std::to_string(positionBytes) + R"( },
+				{ "buffer": 0, "byteOffset": )" + std::to_string(positionBytes) + R"(, "byteLength": )" + std::to_string(indexBytes) + R"( } ],
+			"accessors": [
+				{ "bufferView": 0, "componentType": 5126, "count": )" + std::to_string(vertexCount) + R"(, "type": "VEC3" },
+				{ "bufferView": 1, "componentType": )" + (wideIndices ? "5125" : "5123") + R"(, "count": )" + std::to_string(indexCount) + R"(, "type": "SCALAR" } ],
+			"meshes": [ { "name": "tri", "primitives": [ )" + redox::String(primitives) + R"( ] } ]
+		})";
+	}
+
+	struct TestGrid {
+		redox::Buffer<redox::graphics::MeshVertex> vertices;
+		redox::Buffer<redox::u32> indices;
+	};
+
+	//flat size x size grid facing +z, two triangles per cell in row order. ridge is the
+	//height of the middle row.
+	TestGrid make_test_grid(redox::u32 size, float ridge = 0.0f) {
+		TestGrid grid;
+		for (redox::u32 y = 0; y <= size; y++) {
+			for (redox::u32 x = 0; x <= size; x++)
+				grid.vertices.push_back({ { float(x), float(y), y == size / 2 ? ridge : 0.0f }, { 0, 0, 1 }, { 0, 0 } });
+		}
+
+		for (redox::u32 y = 0; y < size; y++) {
+			for (redox::u32 x = 0; x < size; x++) {
+				auto a = y * (size + 1) + x;
+				grid.indices.insert(grid.indices.end(), { a, a + 1, a + size + 1, a + 1, a + size + 2, a + size + 1 });
+			}
+		}
+		return grid;
+	}
+}
+
+TEST(Resources, MeshCooker) {
+	auto dir = std::filesystem::temp_directory_path() / "redox_cook";
+	std::filesystem::create_directories(dir);
+	{
+		const float positions[] = { 0, 0, 0, 1, 0, 0, 0, 2, -1 };
+		const uint16_t indices[] = { 0, 1, 2 };
+		std::ofstream bin(dir / "tri.bin", std::ios::binary);
+		bin.write(reinterpret_cast<const char*>(positions), sizeof(positions));
+		bin.write(reinterpret_cast<const char*>(indices), sizeof(indices));
+
+		std::ofstream(dir / "tri.gltf") << make_test_gltf(R"("uri": "tri.bin", )", 3, 3);
+	}
+
+	redox::MeshCooker::cook(dir / "tri.gltf", dir / "tri.rmesh");
+	redox::io::MappedFile file(dir / "tri.rmesh");
+	ASSERT_TRUE(redox::CookedMesh::is_cooked(file.data()));
+
+	redox::CookedMesh cooked(file.data());
+	ASSERT_EQ(cooked.meshes().size(), 1u);
+	const auto& mesh = cooked.meshes()[0];
+	ASSERT_EQ(cooked.string(mesh.name), "tri");
+	ASSERT_EQ(cooked.vertices(mesh).size(), 3u);
+	ASSERT_EQ(cooked.vertices(mesh)[2].pos.z, -1.0f);
+	ASSERT_EQ(mesh.indexType, redox::graphics::IndexType::U16);
+	ASSERT_EQ(cooked.indices<uint16_t>(mesh)[1], 1);
+	ASSERT_EQ(cooked.submeshes(mesh).size(), 1u);
+	ASSERT_EQ(cooked.submeshes(mesh)[0].indexCount, 3u);
+	ASSERT_EQ(mesh.bounds.max[1], 2.0f);
+	ASSERT_EQ(cooked.header().bounds.min[2], -1.0f);
+
+	auto truncated = file.data().subspan(0, sizeof(redox::CookedMesh::Header));
+	ASSERT_THROW(redox::CookedMesh{ truncated }, redox::Exception);
+
+	//meshes addressing more than 64k vertices switch to 32 bit indices
+	{
+		const redox::u32 vertexCount = 70000;
+		const redox::u32 indices[] = { 0, 1, vertexCount - 1 };
+		redox::Buffer<float> positions(vertexCount * 3, 0.0f);
+		std::ofstream bin(dir / "big.bin", std::ios::binary);
+		bin.write(reinterpret_cast<const char*>(positions.data()), positions.size() * sizeof(float));
+		bin.write(reinterpret_cast<const char*>(indices), sizeof(indices));
+
+		std::ofstream(dir / "big.gltf") << make_test_gltf(R"("uri": "big.bin", )", vertexCount, 3, true);
+	}
+
+	//optimization would weld the coincident vertices
+	redox::MeshCooker::Settings settings;
+	settings.optimize = false;
+	redox::GLTFImporter importer(dir / "big.gltf");
+	auto blob = redox::MeshCooker::cook(importer, settings);
+	redox::CookedMesh big(blob);
+	ASSERT_EQ(big.meshes()[0].indexType, redox::graphics::IndexType::U32);
+	ASSERT_EQ(big.indices<redox::u32>(big.meshes()[0])[2], 69999u);
+	ASSERT_THROW(big.indices<uint16_t>(big.meshes()[0]), redox::Exception);
+
+	//the optimizer orders triangles within the meshlets instead of across them
+	const auto grid = make_test_grid(32);
+	{
+		std::ofstream bin(dir / "grid.bin", std::ios::binary);
+		for (const auto& vertex : grid.vertices) {
+			const float position[] = { vertex.pos.x, vertex.pos.y, vertex.pos.z };
+			bin.write(reinterpret_cast<const char*>(position), sizeof(position));
+		}
+		bin.write(reinterpret_cast<const char*>(grid.indices.data()), grid.indices.size() * sizeof(redox::u32));
+
+		std::ofstream(dir / "grid.gltf") << make_test_gltf(R"("uri": "grid.bin", )",
+			static_cast<redox::u32>(grid.vertices.size()), static_cast<redox::u32>(grid.indices.size()), true);
+	}
+
+	settings = {};
+	settings.lodCount = 0;
+	redox::GLTFImporter gridImporter(dir / "grid.gltf");
+	blob = redox::MeshCooker::cook(gridImporter, settings);
+	redox::CookedMesh cookedGrid(blob);
+	const auto& gridMesh = cookedGrid.meshes()[0];
+	redox::Buffer<redox::u32> cookedIndices;
+	for (auto index : cookedGrid.indices<uint16_t>(gridMesh))
+		cookedIndices.push_back(index);
+	ASSERT_EQ(cookedIndices.size(), grid.indices.size());
+
+	redox::u32 covered = 0;
+	for (const auto& meshlet : cookedGrid.meshlets(gridMesh)) {
+		ASSERT_EQ(meshlet.indexOffset, covered);
+		covered += meshlet.indexCount;
+		std::set<redox::u32> unique(cookedIndices.begin() + meshlet.indexOffset,
+			cookedIndices.begin() + meshlet.indexOffset + meshlet.indexCount);
+		ASSERT_LE(unique.size(), settings.meshletVertices);
+		ASSERT_LE(meshlet.indexCount / 3, settings.meshletTriangles);
+	}
+	ASSERT_EQ(covered, cookedIndices.size());
+
+	//at least as cache friendly as the order the meshlet builder leaves behind
+	auto meshletOrder = grid.indices;
+	redox::MeshletBuilder::build(grid.vertices, meshletOrder);
+	const auto cacheSize = settings.optimizer.cacheSize;
+	ASSERT_LE(redox::MeshOptimizer::analyze(cookedIndices, grid.vertices.size(), cacheSize).acmr,
+		redox::MeshOptimizer::analyze(meshletOrder, grid.vertices.size(), cacheSize).acmr * settings.optimizer.overdrawThreshold);
+}
+
+TEST(Resources, GLTFContainers) {
+	const float positions[] = { 0, 0, 0, 1, 0, 0, 0, 2, -1 };
+	const uint16_t indices[] = { 0, 1, 2 };
+
+	auto check = [](redox::GLTFImporter& importer) {
+		ASSERT_TRUE(importer.buffer_uris().empty());
+		auto mesh = importer.import_mesh(0);
+		ASSERT_EQ(mesh.vertexCount, 3u);
+		ASSERT_EQ(mesh.positions[7], 2.0f);
+		ASSERT_EQ(mesh.positions[8], -1.0f);
+		ASSERT_EQ(mesh.indices[2], 2u);
+	};
+
+	//data uri
+	{
+		auto document = make_test_gltf(R"("uri": "data:application/octet-stream;base64,AAAAAAAAAAAAAAAAAACAPwAAAAAAAAAAAAAAAAAAAEAAAIC/AAABAAIA", )", 3, 3);
+		redox::GLTFImporter importer({ reinterpret_cast<const redox::byte*>(document.data()), document.size() }, nullptr);
+		check(importer);
+
+		//only the second primitive has normals, the first one is padded so they stay aligned
+		auto mixed = make_test_gltf(R"("uri": "data:application/octet-stream;base64,AAAAAAAAAAAAAAAAAACAPwAAAAAAAAAAAAAAAAAAAEAAAIC/AAABAAIA", )", 3, 3, false,
+			R"({ "attributes": { "POSITION": 0 }, "indices": 1, "mode": 4 },
+			   { "attributes": { "POSITION": 0, "NORMAL": 0 }, "indices": 1, "mode": 4 })");
+		auto mesh = redox::GLTFImporter({ reinterpret_cast<const redox::byte*>(mixed.data()), mixed.size() }, nullptr).import_mesh(0);
+		ASSERT_EQ(mesh.vertexCount, 6u);
+		ASSERT_EQ(mesh.normals.size(), 18u);
+		ASSERT_TRUE(std::all_of(mesh.normals.begin(), mesh.normals.begin() + 9, [](float n) { return n == 0.0f; }));
+		ASSERT_EQ(mesh.normals[16], 2.0f);
+		ASSERT_EQ(mesh.normals[17], -1.0f);
+	}
+
+	//glb: header, padded JSON chunk and a BIN chunk the buffer views point into
+	{
+		auto document = make_test_gltf("", 3, 3);
+		document.resize((document.size() + 3) & ~std::size_t(3), ' ');
+
+		redox::Buffer<redox::byte> glb;
+		auto put = [&glb](const void* data, std::size_t size) {
+			auto bytes = static_cast<const redox::byte*>(data);
+			glb.insert(glb.end(), bytes, bytes + size);
+		};
+		auto put_u32 = [&put](redox::u32 value) { put(&value, sizeof(value)); };
+
+		const redox::u32 binSize = 44;
+		put_u32(0x46546C67);
+		put_u32(2);
+		put_u32(static_cast<redox::u32>(12 + 8 + document.size() + 8 + binSize));
+		put_u32(static_cast<redox::u32>(document.size()));
+		put_u32(0x4E4F534A);
+		put(document.data(), document.size());
+		put_u32(binSize);
+		put_u32(0x004E4942);
+		put(positions, sizeof(positions));
+		put(indices, sizeof(indices));
+		put_u32(0);
+		glb.resize(glb.size() - 2);
+
+		redox::GLTFImporter importer(glb, nullptr);
+		check(importer);
+	}
+}
+
+TEST(Resources, MeshOptimizer) {
+	using redox::MeshOptimizer;
+	using redox::graphics::MeshVertex;
+
+	//the grid unwelded and split into two submeshes, every triangle owns its
+	//vertices and the order within each half is shuffled
+	const redox::u32 size = 32;
+	const auto grid = make_test_grid(size);
+	redox::Buffer<redox::u32> order;
+	for (redox::u32 t = 0; t < grid.indices.size() / 3; t++)
+		order.push_back(t);
+	std::shuffle(order.begin(), order.end(), std::mt19937(42));
+	std::stable_partition(order.begin(), order.end(), [&grid](redox::u32 t) {
+		return grid.vertices[grid.indices[t * 3]].pos.y < size / 2;
+	});
+
+	redox::Buffer<MeshVertex> vertices;
+	redox::Buffer<redox::u32> indices;
+	for (auto t : order) {
+		for (int k = 0; k < 3; k++) {
+			vertices.push_back(grid.vertices[grid.indices[t * 3 + k]]);
+			indices.push_back(static_cast<redox::u32>(indices.size()));
+		}
+	}
+
+	auto triangles = [](const redox::Buffer<MeshVertex>& v, const redox::Buffer<redox::u32>& i) {
+		std::multiset<std::array<float, 6>> result;
+		for (std::size_t t = 0; t < i.size(); t += 3) {
+			std::array<std::pair<float, float>, 3> corners;
+			for (int k = 0; k < 3; k++)
+				corners[k] = { v[i[t + k]].pos.x, v[i[t + k]].pos.y };
+			std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end()), corners.end());
+			result.insert({ corners[0].first, corners[0].second, corners[1].first,
+				corners[1].second, corners[2].first, corners[2].second });
+		}
+		return result;
+	};
+
+	const auto original = triangles(vertices, indices);
+	const MeshOptimizer::IndexRange halves[] = { { 0, 3 * size * size }, { 3 * size * size, 3 * size * size } };
+
+	redox::concurrency::WorkerPool workers(2);
+	MeshOptimizer::Settings settings;
+	settings.workers = &workers;
+	auto report = MeshOptimizer::optimize(vertices, indices, halves, settings);
+
+	ASSERT_EQ(vertices.size(), (size + 1) * (size + 1));
+	ASSERT_EQ(report.weldedVertices, 6 * size * size - vertices.size());
+	ASSERT_EQ(report.before.acmr, 3.0f);
+	ASSERT_LT(report.after.acmr, 1.0f);
+	ASSERT_LT(report.after.atvr, 1.5f);
+	ASSERT_TRUE(triangles(vertices, indices) == original);
+
+	//first use order after the fetch remap
+	redox::u32 next = 0;
+	for (auto index : indices) {
+		ASSERT_LE(index, next);
+		next = std::max(next, index + 1);
+	}
+}
+
+TEST(Resources, MeshSimplifier) {
+	using redox::graphics::MeshVertex;
+
+	//flat grid with a ridge along its middle row
+	const redox::u32 size = 32;
+	const auto grid = make_test_grid(size, 4.0f);
+	const auto& vertices = grid.vertices;
+	const auto& indices = grid.indices;
+
+	float error;
+	auto lod = redox::MeshSimplifier::simplify(vertices, indices, indices.size() / 10, 0.01f, &error);
+	ASSERT_LT(lod.size(), indices.size() / 4);
+	ASSERT_EQ(lod.size() % 3, 0u);
+	ASSERT_LE(error, 0.01f);
+
+	//open borders stay in place and the ridge keeps its height
+	std::set<redox::u32> used(lod.begin(), lod.end());
+	float ridge = 0.0f;
+	for (redox::u32 i = 0; i <= size; i++) {
+		ASSERT_TRUE(used.count(i) && used.count(size * (size + 1) + i));
+		ASSERT_TRUE(used.count(i * (size + 1)) && used.count(i * (size + 1) + size));
+	}
+	for (auto index : used)
+		ridge = std::max(ridge, vertices[index].pos.z);
+	ASSERT_EQ(ridge, 4.0f);
+
+	//a zero error bound still removes the lossless collapses of the flat parts
+	auto exact = redox::MeshSimplifier::simplify(vertices, indices, 0, 0.0f, &error);
+	ASSERT_LT(exact.size(), indices.size());
+	ASSERT_EQ(error, 0.0f);
+}
+
+TEST(Resources, MeshletBuilder) {
+	using namespace redox::graphics;
+
+	auto grid = make_test_grid(32);
+	const auto& vertices = grid.vertices;
+	auto& indices = grid.indices;
+
+	auto triangles = [](const redox::u32* t) {
+		std::array<redox::u32, 3> sorted{ t[0], t[1], t[2] };
+		std::sort(sorted.begin(), sorted.end());
+		return sorted;
+	};
+	std::set<std::array<redox::u32, 3>> before;
+	for (std::size_t t = 0; t < indices.size(); t += 3)
+		before.insert(triangles(&indices[t]));
+
+	auto meshlets = redox::MeshletBuilder::build(vertices, indices, 64, 124);
+	ASSERT_GE(meshlets.size(), indices.size() / 3 / 124);
+
+	//meshlets tile the reordered indices within their limits
+	redox::u32 offset = 0;
+	for (const auto& meshlet : meshlets) {
+		ASSERT_EQ(meshlet.indexOffset, offset);
+		ASSERT_LE(meshlet.indexCount, 124u * 3);
+		std::set<redox::u32> used(indices.begin() + meshlet.indexOffset,
+			indices.begin() + meshlet.indexOffset + meshlet.indexCount);
+		ASSERT_LE(used.size(), 64u);
+		ASSERT_LE(meshlet.coneCutoff, 1e-3f);
+		offset += meshlet.indexCount;
+	}
+	ASSERT_EQ(offset, indices.size());
+
+	std::set<std::array<redox::u32, 3>> after;
+	for (std::size_t t = 0; t < indices.size(); t += 3)
+		after.insert(triangles(&indices[t]));
+	ASSERT_EQ(before, after);
+
+	//seen from below every cluster faces away, from above they all pass
+	auto far = redox::math::Mat44f::scale({ 0.001f, 0.001f, 0.001f });
+	redox::Buffer<IndexRange> ranges;
+	ASSERT_EQ(ClusterCuller::cull(meshlets, CullView::from(far, { 16, 16, -10 }), ranges), 0u);
+	ASSERT_EQ(ClusterCuller::cull(meshlets, CullView::from(far, { 16, 16, 10 }), ranges), indices.size() / 3);
+	ASSERT_EQ(ranges.size(), 1u);
+
+	//the identity clip volume only touches the corner around the origin
+	ranges.clear();
+	auto visible = ClusterCuller::cull(meshlets, CullView::from(redox::math::Mat44f::identity(), { 0, 0, 10 }), ranges);
+	ASSERT_GT(visible, 0u);
+	ASSERT_LT(visible, indices.size() / 6);
+}
+
+TEST(Graphics, ClusterCulling) {
+	using namespace redox::graphics;
+
+	//off-center frustum looking down -z, l = 0, r = 2, b = 0, t = 1, n = 1, f = 10.
+	//at depth d it covers 0 <= x <= 2d and 0 <= y <= d, a transposed matrix or
+	//swapped planes would mirror or shift that region
+	const redox::math::Mat44f frustum(std::array<float, 16>{
+		1, 0, 1, 0,
+		0, 2, 1, 0,
+		0, 0, -11.0f / 9.0f, -20.0f / 9.0f,
+		0, 0, -1, 0 });
+	const auto view = CullView::from(frustum, { 0, 0, 0 });
+
+	auto at = [](float x, float y, float z) {
+		return Meshlet{ 0, 3, { x, y, z }, 0.01f, { x, y, z }, { 0, 0, 1 }, 2.0f };
+	};
+
+	ASSERT_TRUE(ClusterCuller::visible(at(1.0f, 0.5f, -1.0f), view));
+	ASSERT_TRUE(ClusterCuller::visible(at(3.0f, 0.5f, -2.0f), view));
+	ASSERT_TRUE(ClusterCuller::visible(at(7.0f, 4.0f, -4.0f), view));
+	ASSERT_FALSE(ClusterCuller::visible(at(-1.0f, 0.5f, -1.0f), view));
+	ASSERT_FALSE(ClusterCuller::visible(at(1.0f, -0.5f, -1.0f), view));
+	ASSERT_FALSE(ClusterCuller::visible(at(5.0f, 0.5f, -2.0f), view));
+	ASSERT_FALSE(ClusterCuller::visible(at(1.0f, 2.5f, -2.0f), view));
+	ASSERT_FALSE(ClusterCuller::visible(at(1.0f, 0.5f, -0.5f), view));
+	ASSERT_FALSE(ClusterCuller::visible(at(1.0f, 0.5f, -12.0f), view));
+}
+
+TEST(Graphics, TextureStreaming) {
+	using namespace redox::graphics;
+
+	//level 0 of a 256 texel square, each level a quarter of the one above
+	auto size = [](redox::u32 level) { return VkDeviceSize(65536) >> (2 * level); };
+
+	//drops are taken regardless of the budget, upgrades go as far as it allows
+	ASSERT_EQ(streaming::select_level(4, 2, 1000, 0, size), 4u);
+	ASSERT_EQ(streaming::select_level(0, 4, 0, 1u << 20, size), 0u);
+	ASSERT_EQ(streaming::select_level(0, 4, 10000, 30000, size), 1u);
+	ASSERT_EQ(streaming::select_level(0, 4, 28500, 30000, size), 3u);
+	ASSERT_EQ(streaming::select_level(0, 4, 30000, 30000, size), 4u);
+	ASSERT_EQ(streaming::select_level(2, 2, 0, 1u << 20, size), 2u);
+
+	//items stay for delay updates after they were retired
+	redox::Buffer<std::pair<redox::u64, int>> retired{ { 1, 10 }, { 2, 20 }, { 3, 30 } };
+	redox::Buffer<int> released;
+	auto release = [&released](int item) { released.push_back(item); };
+
+	streaming::retire(retired, 3, 3, release);
+	ASSERT_TRUE(released.empty());
+	streaming::retire(retired, 5, 3, release);
+	ASSERT_EQ(released, (redox::Buffer<int>{ 10, 20 }));
+	ASSERT_EQ(retired.size(), 1u);
+	ASSERT_EQ(retired[0].second, 30);
+}
+
+TEST(Resources, TextureCooker) {
+	using redox::bc::Encoding;
+
+	//smooth gradient with a shallow alpha ramp, sized so the edge blocks are partial
+	const redox::u32 width = 70, height = 45;
+	redox::Buffer<redox::u8> pixels(width * height * 4);
+	for (redox::u32 y = 0; y < height; y++) {
+		for (redox::u32 x = 0; x < width; x++) {
+			auto* p = &pixels[(y * width + x) * 4];
+			p[0] = redox::u8(x * 3);
+			p[1] = redox::u8(y * 5);
+			p[2] = redox::u8(255 - x * 2);
+			p[3] = redox::u8(128 + y);
+		}
+	}
+
+	auto rmse = [&](Encoding encoding, redox::u32 channels) {
+		redox::Buffer<redox::byte> blocks(redox::bc::level_size(encoding, width, height));
+		redox::bc::encode(encoding, pixels.data(), width, height, blocks.data());
+		redox::Buffer<redox::u8> decoded(pixels.size());
+		redox::bc::decode(encoding, blocks.data(), width, height, decoded.data());
+
+		double sum = 0;
+		for (std::size_t i = 0; i < pixels.size(); i++) {
+			if (i % 4 < channels)
+				sum += (pixels[i] - decoded[i]) * (pixels[i] - decoded[i]);
+		}
+		return std::sqrt(sum / (pixels.size() / 4 * channels));
+	};
+
+	ASSERT_LT(rmse(Encoding::BC1, 3), 4.0);
+	ASSERT_LT(rmse(Encoding::BC3, 4), 4.0);
+	ASSERT_LT(rmse(Encoding::BC5, 2), 2.0);
+	ASSERT_LT(rmse(Encoding::BC7, 4), 2.0);
+
+	//bc7 blocks from other encoders may use modes the decoder lacks, they are detected up front
+	redox::Buffer<redox::byte> bc7(redox::bc::level_size(Encoding::BC7, width, height));
+	redox::bc::encode(Encoding::BC7, pixels.data(), width, height, bc7.data());
+	ASSERT_TRUE(redox::bc::decodable(Encoding::BC7, bc7.data(), width, height));
+	bc7[bc7.size() - 16] = redox::byte(1u << 5);
+	ASSERT_FALSE(redox::bc::decodable(Encoding::BC7, bc7.data(), width, height));
+	ASSERT_TRUE(redox::bc::decodable(Encoding::BC1, bc7.data(), width, height));
+
+	redox::TextureCooker::Settings settings;
+	auto blob = redox::TextureCooker::cook(pixels, width, height, settings);
+	redox::CookedTexture cooked(blob);
+	ASSERT_EQ(cooked.encoding(), Encoding::BC7);
+	ASSERT_TRUE(cooked.srgb());
+	ASSERT_EQ(cooked.level_count(), 7u);
+	ASSERT_EQ(cooked.level(1).width, 35u);
+	ASSERT_EQ(cooked.level(1).data.size(), 9u * 6 * 16);
+	ASSERT_EQ(cooked.level(6).width, 1u);
+	ASSERT_EQ(cooked.level(6).height, 1u);
+	ASSERT_EQ(cooked.level(6).data.data() + cooked.level(6).data.size(), blob.data() + blob.size());
+
+	auto truncated = redox::Span<const redox::byte>(blob).subspan(0, blob.size() - 1);
+	ASSERT_THROW(redox::CookedTexture{ truncated }, redox::Exception);
+
+	//bc1 ktx2 with two levels, level data is stored smallest first
+	redox::CookedTexture::KtxHeader ktx{};
+	std::memcpy(ktx.identifier, redox::CookedTexture::KtxIdentifier, sizeof(ktx.identifier));
+	ktx.vkFormat = 131;
+	ktx.typeSize = 1;
+	ktx.pixelWidth = 8;
+	ktx.pixelHeight = 4;
+	ktx.faceCount = 1;
+	ktx.levelCount = 2;
+	const auto dataStart = sizeof(ktx) + 2 * sizeof(redox::CookedTexture::KtxLevel);
+	const redox::CookedTexture::KtxLevel index[] = { { dataStart + 8, 16, 16 }, { dataStart, 8, 8 } };
+	redox::Buffer<redox::byte> ktxBlob(dataStart + 24);
+	std::memcpy(ktxBlob.data(), &ktx, sizeof(ktx));
+	std::memcpy(ktxBlob.data() + sizeof(ktx), index, sizeof(index));
+	ASSERT_TRUE(redox::CookedTexture::is_cooked(ktxBlob));
+
+	redox::CookedTexture ktxTexture(ktxBlob);
+	ASSERT_EQ(ktxTexture.encoding(), Encoding::BC1);
+	ASSERT_EQ(ktxTexture.level_count(), 2u);
+	ASSERT_EQ(ktxTexture.level(0).data.data(), ktxBlob.data() + dataStart + 8);
+	ASSERT_EQ(ktxTexture.level(1).width, 4u);
+
+	ktx.supercompressionScheme = 2;
+	std::memcpy(ktxBlob.data(), &ktx, sizeof(ktx));
+	ASSERT_THROW(redox::CookedTexture{ ktxBlob }, redox::Exception);
+
+	//black and white average to mid grey in linear light, not in srgb
+	const redox::u8 checker[] = { 0, 0, 0, 255, 255, 255, 255, 255, 255, 255, 255, 255, 0, 0, 0, 255 };
+	ASSERT_EQ(redox::TextureCooker::downsample(checker, 2, 2, true)[0], 188);
+	ASSERT_EQ(redox::TextureCooker::downsample(checker, 2, 2, false)[0], 128);
+	ASSERT_EQ(redox::TextureCooker::downsample(checker, 2, 2, true)[3], 255);
+}
+
+TEST(Resources, AccessorDecoder) {
+	using namespace redox::gltf;
+
+	//interleaved vertices: vec3 f32 position followed by a normalized vec2 u16 texcoord
+	struct vertex { float pos[3]; uint16_t uv[2]; };
+	vertex vertices[5];
+	for (uint16_t i = 0; i < 5; i++)
+		vertices[i] = { { i * 1.0f, i * 2.0f, i * 3.0f }, { uint16_t(i * 16383), 65535 } };
+
+	AccessorView positions{ reinterpret_cast<const redox::byte*>(vertices), 5, sizeof(vertex), 3 };
+	AccessorView texcoords = positions;
+	texcoords.data += offsetof(vertex, uv);
+	texcoords.components = 2;
+	texcoords.type = ComponentType::U16;
+	texcoords.normalized = true;
+
+	float decoded[15];
+	decode(positions, decoded);
+	ASSERT_EQ(decoded[4], 2.0f);
+	ASSERT_EQ(decoded[14], 12.0f);
+
+	decode(texcoords, decoded);
+	ASSERT_FLOAT_EQ(decoded[2], 16383 / 65535.0f);
+	ASSERT_EQ(decoded[9], 1.0f);
+
+	//normalized signed bytes clamp to -1, sparse values replace elements 0 and 3
+	const int8_t normals[] = { -128, 127, 0, -127 };
+	const uint16_t sparseIndices[] = { 3, 0 };
+	const int8_t sparseValues[] = { 64, -64 };
+	AccessorView signedView{ reinterpret_cast<const redox::byte*>(normals), 4, 1, 1, ComponentType::I8, true };
+	SparseView sparse{ 2, reinterpret_cast<const redox::byte*>(sparseIndices), ComponentType::U16,
+		reinterpret_cast<const redox::byte*>(sparseValues) };
+	decode(signedView, decoded, &sparse);
+	ASSERT_FLOAT_EQ(decoded[0], -64 / 127.0f);
+	ASSERT_EQ(decoded[1], 1.0f);
+	ASSERT_FLOAT_EQ(decoded[3], 64 / 127.0f);
+
+	//sparse accessors without storage start out zeroed
+	AccessorView empty{ nullptr, 4, 1, 1, ComponentType::I8, true };
+	decode(empty, decoded, &sparse);
+	ASSERT_EQ(decoded[2], 0.0f);
+
+	//indices widen from bytes and narrow from u32 only when they fit
+	const uint32_t wide[] = { 1, 65535, 70000 };
+	uint16_t narrow[3];
+	AccessorView indexView{ reinterpret_cast<const redox::byte*>(wide), 2, 4, 1, ComponentType::U32 };
+	decode(indexView, narrow);
+	ASSERT_EQ(narrow[1], 65535);
+	indexView.count = 3;
+	ASSERT_THROW(decode(indexView, narrow), redox::Exception);
+}
+
+TEST(Filesystem, DirectoryWatcher) {
+	using redox::io::ChangeEvents;
+	using redox::operator|;
+	auto dir = std::filesystem::temp_directory_path() / "redox_watch";
+	std::filesystem::remove_all(dir);
+	std::filesystem::create_directories(dir / "nested");
+
+	std::mutex mutex;
+	std::condition_variable cv;
+	redox::Buffer<redox::io::DirectoryWatcher::Change> seen;
+
+	redox::io::DirectoryWatcher watcher;
+	watcher.subscribe_batch([&](const auto& changes) {
+		std::lock_guard guard(mutex);
+		seen.insert(seen.end(), changes.begin(), changes.end());
+		cv.notify_all();
+	});
+	watcher.start(dir, ChangeEvents::FILE_ADDED | ChangeEvents::FILE_MODIFIED);
+
+	std::ofstream(dir / "nested" / "asset.txt") << "redox";
+
+	auto expected = (redox::Path("nested") / "asset.txt").lexically_normal();
+	std::unique_lock lock(mutex);
+	ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(5), [&]() {
+		return std::any_of(seen.begin(), seen.end(), [&](const auto& change) {
+			return change.file == expected && redox::util::check_flag(change.events, ChangeEvents::FILE_ADDED);
+		});
+	}));
+
+	//a directory moved into the tree reports the files it brings along
+	auto outside = std::filesystem::temp_directory_path() / "redox_watch_outside";
+	std::filesystem::remove_all(outside);
+	std::filesystem::create_directories(outside);
+	std::ofstream(outside / "moved.txt") << "redox";
+	std::filesystem::rename(outside, dir / "moved");
+
+	auto moved = (redox::Path("moved") / "moved.txt").lexically_normal();
+	ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(5), [&]() {
+		return std::any_of(seen.begin(), seen.end(), [&](const auto& change) {
+			return change.file == moved && redox::util::check_flag(change.events, ChangeEvents::FILE_ADDED);
+		});
+	}));
+	lock.unlock();
+
+	watcher.stop();
+	std::filesystem::remove_all(dir);
+}
+
+namespace {
+	struct TestResource : redox::IResource {
+		redox::String text;
+		redox::ResourceHandle<redox::IResource> dependency;
+		bool uploaded = false;
+
+		void upload() override {
+			uploaded = true;
+		}
+
+		redox::ResourceGroup res_group() const override {
+			return redox::ResourceGroup::ENGINE;
+		}
+
+		redox::ResourceSize size() const override {
+			return { text.size(), 0 };
+		}
+	};
+
+	struct TestPayload : redox::IResourcePayload {
+		redox::String text;
+		redox::ResourceFuture<redox::IResource> dependency;
+
+		bool ready() const override {
+			return !dependency.valid() || dependency.ready();
+		}
+	};
+
+	//.txt files become their text, "use <file>" loads <file> while the resource is created,
+	//"include <file>" only records it as a dependency. decode starts loading the used file,
+	//loose files reach it through the resource manager's reader.
+	struct TestFactory : redox::IResourceFactory {
+		redox::ResourceManager* manager = nullptr;
+		std::atomic<int> decodes = 0;
+
+		redox::ResourceHandle<redox::IResource> load(const redox::Path& path) override {
+			std::ifstream stream(path, std::ios::binary);
+			return create(redox::String(std::istreambuf_iterator<char>(stream), {}));
+		}
+
+		bool supports_ext(const redox::Path& ext) override {
+			return ext == ".txt";
+		}
+
+		redox::UniquePtr<redox::IResourcePayload> decode(const redox::Path&, redox::Span<const redox::byte> data) override {
+			return decode_text(redox::String(reinterpret_cast<const char*>(data.data()), data.size()));
+		}
+
+		bool decodes_from_memory(const redox::Path& ext) override {
+			return ext == ".txt";
+		}
+
+		redox::UniquePtr<redox::IResourcePayload> decode_text(redox::String text) {
+			decodes++;
+			auto payload = redox::make_unique<TestPayload>();
+			if (text.compare(0, 4, "use ") == 0)
+				payload->dependency = manager->load_async<redox::IResource>(redox::Path(text.substr(4)));
+			payload->text = std::move(text);
+			return payload;
+		}
+
+		redox::ResourceHandle<redox::IResource> finalize(const redox::Path& path, redox::UniquePtr<redox::IResourcePayload> payload) override {
+			if (payload)
+				return create(static_cast<TestPayload&>(*payload).text);
+			return load(path);
+		}
+
+		redox::ResourceHandle<redox::IResource> create(redox::String text) {
+			auto resource = std::make_shared<TestResource>();
+			if (text.compare(0, 4, "use ") == 0)
+				resource->dependency = manager->load(redox::Path(text.substr(4)));
+			if (text.compare(0, 8, "include ") == 0)
+				manager->add_dependency(manager->resolve_path(redox::Path(text.substr(8))));
+			resource->text = std::move(text);
+			return resource;
+		}
+	};
+}
+
+TEST(Resources, AsyncLoad) {
+	auto dir = std::filesystem::temp_directory_path() / "redox_async";
+	std::filesystem::remove_all(dir);
+	std::filesystem::create_directories(dir / "app");
+	std::ofstream(dir / "app" / "texture.txt") << "texture";
+	std::ofstream(dir / "app" / "model.txt") << "use texture.txt";
+
+	TestFactory factory;
+	redox::ResourceManager manager(dir / "builtin", dir / "app");
+	factory.manager = &manager;
+	manager.register_factory(&factory);
+
+	//concurrent requests share one load, nothing is created before update() runs
+	auto first = manager.load_async<TestResource>(redox::Path("model.txt"));
+	auto second = manager.load_async<TestResource>(redox::Path("model.txt"));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	ASSERT_FALSE(first.ready());
+
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+	while (!first.ready() && std::chrono::steady_clock::now() < deadline) {
+		manager.update();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	ASSERT_TRUE(first.ready());
+	ASSERT_TRUE(second.ready());
+
+	//the model was finalized after the texture decode started from its own decode
+	auto model = first.get();
+	ASSERT_EQ(second.get(), model);
+	ASSERT_EQ(model->text, "use texture.txt");
+	ASSERT_EQ(model->dependency, manager.load(redox::Path("texture.txt")));
+	ASSERT_EQ(std::static_pointer_cast<TestResource>(model->dependency)->text, "texture");
+	ASSERT_EQ(factory.decodes, 2);
+	ASSERT_EQ(manager.stats(redox::ResourceGroup::ENGINE).misses, 2u);
+
+	//cached resources are ready right away, a blocking load shares an async one in flight
+	ASSERT_TRUE(manager.load_async<TestResource>(redox::Path("model.txt")).ready());
+	std::ofstream(dir / "app" / "other.txt") << "other";
+	auto pending = manager.load_async<TestResource>(redox::Path("other.txt"));
+	ASSERT_EQ(manager.load(redox::Path("other.txt")), pending.get());
+	ASSERT_EQ(factory.decodes, 3);
+}
+
+TEST(Resources, HotReload) {
+	using redox::ResourceHandle;
+	using redox::IResource;
+	auto dir = std::filesystem::temp_directory_path() / "redox_reload";
+	std::filesystem::remove_all(dir);
+	std::filesystem::create_directories(dir / "app");
+
+	//the texture starts out packed, the model is a loose file that uses it
+	redox::ArchiveBuilder builder;
+	const redox::String packed = "packed";
+	builder.add("texture.txt", redox::Buffer<redox::byte>(packed.begin(), packed.end()));
+	builder.write(dir / "app.rpak");
+	std::ofstream(dir / "app" / "model.txt") << "use texture.txt";
+
+	TestFactory factory;
+	redox::ResourceManager manager(dir / "builtin", dir / "app", true);
+	factory.manager = &manager;
+	manager.register_factory(&factory);
+
+	redox::Buffer<std::pair<ResourceHandle<IResource>, ResourceHandle<IResource>>> swaps;
+	manager.onReloadResource += [&swaps](ResourceHandle<IResource> old, ResourceHandle<IResource> resource) {
+		swaps.emplace_back(std::move(old), std::move(resource));
+	};
+
+	auto model = manager.load<TestResource>(redox::Path("model.txt"));
+	auto texture = manager.load<TestResource>(redox::Path("texture.txt"));
+	ASSERT_EQ(model->dependency, texture);
+	ASSERT_EQ(texture->text, "packed");
+
+	auto pump = [&manager](std::chrono::milliseconds duration, auto&& done) {
+		auto deadline = std::chrono::steady_clock::now() + duration;
+		while (!done() && std::chrono::steady_clock::now() < deadline) {
+			manager.update();
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		}
+		return done();
+	};
+
+	//a burst of saves is debounced into one reload, which reads the loose file over the packed one
+	for (int i = 1; i <= 3; i++) {
+		std::ofstream(dir / "app" / "texture.txt") << "loose " << i;
+		std::this_thread::sleep_for(redox::ResourceManager::ReloadDelay / 8);
+	}
+	ASSERT_TRUE(pump(std::chrono::seconds(5), [&swaps]() { return swaps.size() >= 2; }));
+	pump(redox::ResourceManager::ReloadDelay * 3, []() { return false; });
+	ASSERT_EQ(swaps.size(), 2u);
+
+	//the texture is swapped first, then its dependent model is rebuilt on the new texture
+	auto reloadedTexture = std::static_pointer_cast<TestResource>(swaps[0].second);
+	auto reloadedModel = std::static_pointer_cast<TestResource>(swaps[1].second);
+	ASSERT_EQ(swaps[0].first, texture);
+	ASSERT_EQ(reloadedTexture->text, "loose 3");
+	ASSERT_TRUE(reloadedTexture->uploaded);
+	ASSERT_EQ(swaps[1].first, model);
+	ASSERT_EQ(reloadedModel->dependency, reloadedTexture);
+	ASSERT_TRUE(reloadedModel->uploaded);
+
+	//loads see the new versions, handles to the old ones stay valid
+	ASSERT_EQ(manager.load(redox::Path("texture.txt")), reloadedTexture);
+	ASSERT_EQ(manager.load(redox::Path("model.txt")), reloadedModel);
+	ASSERT_EQ(texture->text, "packed");
+	ASSERT_EQ(model->dependency, texture);
+
+	//files nothing loaded are not reloaded
+	std::ofstream(dir / "app" / "unused.txt") << "unused";
+	std::ofstream(dir / "app" / "common.txt") << "common";
+	std::ofstream(dir / "app" / "shader.txt") << "include common.txt";
+	pump(redox::ResourceManager::ReloadDelay * 3, []() { return false; });
+	ASSERT_EQ(swaps.size(), 2u);
+
+	//a file that is no resource itself reloads what was built from it
+	auto shader = manager.load(redox::Path("shader.txt"));
+	std::ofstream(dir / "app" / "common.txt") << "changed";
+	ASSERT_TRUE(pump(std::chrono::seconds(5), [&swaps]() { return swaps.size() >= 3; }));
+	ASSERT_EQ(swaps[2].first, shader);
+}
+
+TEST(Resources, Budgets) {
+	using redox::IResource;
+	using redox::Path;
+	auto dir = std::filesystem::temp_directory_path() / "redox_budgets";
+	std::filesystem::remove_all(dir);
+	std::filesystem::create_directories(dir / "app");
+	for (auto name : { "a.txt", "b.txt", "c.txt" })
+		std::ofstream(dir / "app" / name) << "1234";
+
+	TestFactory factory;
+	redox::ResourceManager manager(dir / "builtin", dir / "app");
+	factory.manager = &manager;
+	manager.register_factory(&factory);
+
+	const auto group = redox::ResourceGroup::ENGINE;
+	auto pinned = manager.load(Path("a.txt"));
+	std::weak_ptr<IResource> b = manager.load(Path("b.txt"));
+	std::weak_ptr<IResource> c = manager.load(Path("c.txt"));
+	manager.load(Path("b.txt"));
+
+	auto stats = manager.stats(group);
+	ASSERT_EQ(stats.misses, 3u);
+	ASSERT_EQ(stats.hits, 1u);
+	ASSERT_EQ(stats.resources, 3u);
+	ASSERT_EQ(stats.cpuBytes, 12u);
+	ASSERT_EQ(stats.gpuBytes, 0u);
+	ASSERT_EQ(manager.stats(redox::ResourceGroup::GRAPHICS).resources, 0u);
+
+	//groups are unlimited until a budget is set
+	manager.next_frame();
+	ASSERT_EQ(manager.stats(group).evictions, 0u);
+
+	//budgets are enforced per frame, not by the updates wait() pumps
+	manager.set_budget(group, { 8, std::numeric_limits<redox::u64>::max() });
+	manager.update();
+	ASSERT_EQ(manager.stats(group).evictions, 0u);
+
+	//a is older but still referenced, c is the least recently used one only the cache holds
+	manager.next_frame();
+	stats = manager.stats(group);
+	ASSERT_EQ(stats.evictions, 1u);
+	ASSERT_EQ(stats.resources, 2u);
+	ASSERT_EQ(stats.cpuBytes, 8u);
+
+	//frames in flight may still use it, it is released EvictionDelay frames later
+	for (redox::u64 i = 0; i < redox::ResourceManager::EvictionDelay; i++) {
+		ASSERT_FALSE(c.expired());
+		manager.update();
+		manager.next_frame();
+	}
+	ASSERT_TRUE(c.expired());
+	ASSERT_FALSE(b.expired());
+
+	//a budget nothing can meet still keeps what is referenced
+	manager.set_budget(group, { 0, 0 });
+	manager.next_frame();
+	stats = manager.stats(group);
+	ASSERT_EQ(stats.evictions, 2u);
+	ASSERT_EQ(stats.resources, 1u);
+	ASSERT_EQ(stats.cpuBytes, 4u);
+	ASSERT_EQ(manager.load(Path("a.txt")), pinned);
+
+	//once released it goes as well and the next load decodes it again
+	pinned.reset();
+	manager.next_frame();
+	stats = manager.stats(group);
+	ASSERT_EQ(stats.evictions, 3u);
+	ASSERT_EQ(stats.resources, 0u);
+	ASSERT_EQ(stats.cpuBytes, 0u);
+	auto grown = manager.load<TestResource>(Path("c.txt"));
+	ASSERT_EQ(manager.stats(group).misses, 4u);
+
+	//sizes are taken once, changes are reported
+	grown->text = "12345678";
+	manager.next_frame();
+	ASSERT_EQ(manager.stats(group).cpuBytes, 4u);
+	manager.resized(grown.get());
+	stats = manager.stats(group);
+	ASSERT_EQ(stats.resources, 1u);
+	ASSERT_EQ(stats.cpuBytes, 8u);
+}
+
+#ifdef RDX_WITH_SHADERC
+TEST(Graphics, ShaderCompilerInclude) {
+	auto dir = std::filesystem::temp_directory_path() / "redox_shaderc";
+	std::filesystem::remove_all(dir);
+	std::filesystem::create_directories(dir / "common");
+
+	//quoted includes resolve against the including file, also from inside an include
+	std::ofstream(dir / "common" / "tint.glsl") << "const vec3 tint = vec3(1.0, 0.5, 0.25);\n";
+	std::ofstream(dir / "common" / "color.glsl") << "#include \"tint.glsl\"\nvec4 shade(vec3 c) { return vec4(c * tint, 1.0); }\n";
+	std::ofstream(dir / "include.frag") <<
+		"#version 450\n"
+		"#extension GL_GOOGLE_include_directive : require\n"
+		"#include \"common/color.glsl\"\n"
+		"layout(location = 0) in vec3 inColor;\n"
+		"layout(location = 0) out vec4 outColor;\n"
+		"void main() { outColor = shade(inColor); }\n";
+
+	auto spirv = redox::graphics::ShaderCompiler::compile(dir / "include.frag");
+	ASSERT_GE(spirv.size(), 20u);
+	ASSERT_EQ(spirv.size() % 4, 0u);
+	redox::u32 magic;
+	std::memcpy(&magic, spirv.data(), sizeof(magic));
+	ASSERT_EQ(magic, 0x07230203u);
+
+	//a missing include fails the compile instead of producing a binary
+	std::ofstream(dir / "broken.frag") <<
+		"#version 450\n"
+		"#extension GL_GOOGLE_include_directive : require\n"
+		"#include \"missing.glsl\"\n"
+		"void main() {}\n";
+	ASSERT_THROW(redox::graphics::ShaderCompiler::compile(dir / "broken.frag"), redox::Exception);
+	std::filesystem::remove_all(dir);
+}
+#endif
@@ -0,0 +1,195 @@
+/*
+redox
+-----------
+MIT License
+
+Copyright (c) 2018 Luis von der Eltz
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <core/core.h>
+#include <core/logging/log.h>
+#include <platform/filesystem.h>
+#include <platform/async_reader.h>
+#include <resources/archive.h>
+#include <resources/importer/gltf_importer.h>
+#include <resources/importer/mesh_cooker.h>
+#include <resources/importer/texture_cooker.h>
+#include <graphics/vulkan/resources/shader_compiler.h>
+#include <core/concurrency/worker_pool.h>
+
+#include <algorithm> //std::find, std::copy_if
+#include <iterator> //std::back_inserter
+#include <set> //std::set
+#include <thread> //std::thread::hardware_concurrency
+#include <atomic> //std::atomic_bool
+
+//packs a resource directory into a .rpak archive, or cooks a single model.
+//usage: assetc <resource directory> <output.rpak> [--store]
+//       assetc --cook <model.gltf|model.glb> <output.rmesh>
+//       assetc --cook-texture <image> <output.dds> [bc1|bc3|bc5|bc7|rgba8] [--linear]
+//
+//shaders are compiled to SPIR-V in parallel and glTF documents are cooked to .rmesh blobs,
+//both packed under their source name, meshes are optimized for the vertex cache with
+//their submeshes spread over all cores. buffers only referenced by cooked documents are
+//dropped. formats that are already compressed are stored raw so they can be read
+//straight from the mapping, everything else is LZ4 compressed unless --store is given.
+
+namespace {
+	bool any_of(const redox::Path& ext, std::initializer_list<redox::StringView> list) {
+		return std::find(list.begin(), list.end(), ext.generic_string()) != list.end();
+	}
+}
+
+int main(int argc, char** argv) {
+	using namespace redox;
+	using Codec = ResourceArchive::Codec;
+
+	if (argc < 3) {
+		RDX_LOG("usage: assetc <resource directory> <output.rpak> [--store]");
+		RDX_LOG("       assetc --cook <model.gltf|model.glb> <output.rmesh>");
+		RDX_LOG("       assetc --cook-texture <image> <output.dds> [bc1|bc3|bc5|bc7|rgba8] [--linear]");
+		return 1;
+	}
+
+	concurrency::WorkerPool workers(std::max(1u, std::thread::hardware_concurrency()));
+	MeshCooker::Settings cookSettings;
+	cookSettings.workers = &workers;
+	cookSettings.optimizer.workers = &workers;
+
+	if (StringView(argv[1]) == "--cook") {
+		try {
+			MeshCooker::cook(Path(argv[2]), argc > 3 ? Path(argv[3]) : Path(argv[2]).replace_extension(".rmesh"),
+				cookSettings);
+			return 0;
+		}
+		catch (const std::exception& e) {
+			RDX_LOG("assetc failed: {0}", ConsoleColor::RED, e.what());
+			return 1;
+		}
+	}
+
+	//images become a full mip chain, BC7 unless told otherwise. --linear skips the
+	//srgb conversion while filtering, normal maps want bc5 --linear.
+	if (StringView(argv[1]) == "--cook-texture") {
+		try {
+			TextureCooker::Settings settings;
+			settings.workers = &workers;
+			for (int i = 4; i < argc; i++) {
+				const StringView arg(argv[i]);
+				if (arg == "--linear") settings.srgb = false;
+				else if (arg == "bc1") settings.encoding = bc::Encoding::BC1;
+				else if (arg == "bc3") settings.encoding = bc::Encoding::BC3;
+				else if (arg == "bc5") settings.encoding = bc::Encoding::BC5;
+				else if (arg == "bc7") settings.encoding = bc::Encoding::BC7;
+				else if (arg == "rgba8") settings.encoding = bc::Encoding::RGBA8;
+				else throw Exception(redox::format("unknown texture option {0}", arg));
+			}
+
+			TextureCooker::cook(Path(argv[2]), argc > 3 ? Path(argv[3]) : Path(argv[2]).replace_extension(".dds"),
+				settings);
+			return 0;
+		}
+		catch (const std::exception& e) {
+			RDX_LOG("assetc failed: {0}", ConsoleColor::RED, e.what());
+			return 1;
+		}
+	}
+
+	const Path root(argv[1]);
+	const Path output(argv[2]);
+	const bool store = argc > 3 && StringView(argv[3]) == "--store";
+
+	try {
+		ArchiveBuilder builder;
+
+		Buffer<Path> files;
+		for (auto it = io::recursive_directory_iterator(root); it != io::recursive_directory_iterator(); ++it) {
+			if (!it->is_directory()) {
+				files.push_back(it->path());
+			}
+			//shader caches written by loose loads
+			else if (it->path().filename() == "compiled") {
+				it.disable_recursion_pending();
+			}
+		}
+
+		//shaders compile concurrently, each one is a separate compiler run
+		Buffer<Path> shaders;
+		std::copy_if(files.begin(), files.end(), std::back_inserter(shaders), [](const Path& file) {
+			return any_of(file.extension(), { ".vert", ".frag", ".geom" });
+		});
+		auto binaries = graphics::ShaderCompiler::compile_all(shaders, workers);
+		for (std::size_t i = 0; i < shaders.size(); i++)
+			builder.add(io::relative(shaders[i], root).generic_string(), std::move(binaries[i]), Codec::LZ4);
+
+		std::set<Path> cookedBuffers;
+		for (const auto& file : files) {
+			auto name = io::relative(file, root).generic_string();
+			auto ext = file.extension();
+
+			if (any_of(ext, { ".gltf", ".glb" })) {
+				GLTFImporter importer(file);
+				builder.add(name, MeshCooker::cook(importer, cookSettings), Codec::LZ4);
+				for (const auto& uri : importer.buffer_uris())
+					cookedBuffers.insert(io::weakly_canonical(file.parent_path() / uri));
+			}
+		}
+
+		Buffer<Path> raw;
+		std::copy_if(files.begin(), files.end(), std::back_inserter(raw), [&cookedBuffers](const Path& file) {
+			return !any_of(file.extension(), { ".vert", ".frag", ".geom", ".gltf", ".glb" }) &&
+				!cookedBuffers.count(io::weakly_canonical(file));
+		});
+
+		//the remaining files are read in one batch straight into their entries
+		Buffer<Buffer<byte>> contents(raw.size());
+		Buffer<io::ReadRequest> requests(raw.size());
+		std::atomic_bool failed{ false };
+		for (std::size_t i = 0; i < raw.size(); i++) {
+			contents[i].resize(static_cast<std::size_t>(io::file_size(raw[i])));
+			requests[i].file = raw[i];
+			requests[i].size = contents[i].size();
+			requests[i].target = contents[i];
+			requests[i].callback = [&failed](io::ReadResult& result) {
+				if (!result.success)
+					failed = true;
+			};
+		}
+
+		io::AsyncReader reader(&workers);
+		reader.submit_reads(requests);
+		reader.wait_idle();
+		if (failed)
+			throw Exception("failed to read resources");
+
+		for (std::size_t i = 0; i < raw.size(); i++) {
+			const bool compressed = any_of(raw[i].extension(), { ".png", ".jpg", ".jpeg", ".gif", ".dds", ".ktx2" });
+			builder.add(io::relative(raw[i], root).generic_string(), std::move(contents[i]),
+				store || compressed ? Codec::NONE : Codec::LZ4);
+		}
+
+		builder.write(output);
+	}
+	catch (const std::exception& e) {
+		RDX_LOG("assetc failed: {0}", ConsoleColor::RED, e.what());
+		return 1;
+	}
+	return 0;
+}